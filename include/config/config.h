@@ -90,6 +90,10 @@ namespace bongocat::config {
         config_animation_type_t animation_type{config_animation_type_t::None};
         int idle_animation{0};
         int input_fps{0};
+        int enable_subsurface{0};
+        int fps_active{0};
+        int fps_idle{0};
+        int fps_sleep{0};
 
 
         // Make Config movable and copyable
@@ -129,7 +133,11 @@ namespace bongocat::config {
               cat_align(other.cat_align),
               animation_type(other.animation_type),
               idle_animation(other.idle_animation),
-              input_fps(other.input_fps)
+              input_fps(other.input_fps),
+              enable_subsurface(other.enable_subsurface),
+              fps_active(other.fps_active),
+              fps_idle(other.fps_idle),
+              fps_sleep(other.fps_sleep)
         {
             output_name = other.output_name ? strdup(other.output_name) : nullptr;
             config_copy_keyboard_devices_from(*this, other);
@@ -166,6 +174,10 @@ namespace bongocat::config {
                 animation_type = other.animation_type;
                 idle_animation = other.idle_animation;
                 input_fps = other.input_fps;
+                enable_subsurface = other.enable_subsurface;
+                fps_active = other.fps_active;
+                fps_idle = other.fps_idle;
+                fps_sleep = other.fps_sleep;
 
                 output_name = other.output_name ? strdup(other.output_name) : nullptr;
                 config_copy_keyboard_devices_from(*this, other);
@@ -202,7 +214,11 @@ namespace bongocat::config {
               cat_align(other.cat_align),
               animation_type(other.animation_type),
               idle_animation(other.idle_animation),
-              input_fps(other.input_fps)
+              input_fps(other.input_fps),
+              enable_subsurface(other.enable_subsurface),
+              fps_active(other.fps_active),
+              fps_idle(other.fps_idle),
+              fps_sleep(other.fps_sleep)
         {
             for (int i = 0; i < num_keyboard_devices; ++i) {
                 keyboard_devices[i] = other.keyboard_devices[i];
@@ -245,6 +261,10 @@ namespace bongocat::config {
                 animation_type = other.animation_type;
                 idle_animation = other.idle_animation;
                 input_fps = other.input_fps;
+                enable_subsurface = other.enable_subsurface;
+                fps_active = other.fps_active;
+                fps_idle = other.fps_idle;
+                fps_sleep = other.fps_sleep;
 
                 for (int i = 0; i < num_keyboard_devices; ++i) {
                     keyboard_devices[i] = other.keyboard_devices[i];
@@ -11,7 +11,11 @@ namespace bongocat::animation {
     created_result_t<animation_session_t> create(const config::config_t& config);
     bongocat_error_t start(animation_session_t& ctx, platform::input::input_context_t& input);
     void trigger(animation_session_t& ctx);
+    void wake(animation_context_t& ctx);
+    void set_suspended(animation_context_t& ctx, bool suspended);
     void update_config(animation_context_t& ctx, const config::config_t& config);
+    /// frame pacing histograms of the animation thread (log info)
+    void print_frame_timing_stats(const animation_context_t& ctx);
 
     enum class drawing_copy_pixel_color_option_t : uint8_t {
         COPY_PIXEL_OPTION_NORMAL = (1u << 0),
@@ -27,7 +31,9 @@ namespace bongocat::animation {
                            int frame_w, int frame_h,
                            int offset_x, int offset_y, int target_w, int target_h,
                            drawing_color_order_t dest_order,
-                           drawing_color_order_t src_order);
+                           drawing_color_order_t src_order,
+                           const sprite_sheet_spans_t *src_spans = nullptr,
+                           const sprite_sheet_palette_t *src_palette = nullptr);
 }
 
 #endif // BONGOCAT_ANIMATION_H
\ No newline at end of file
@@ -2,9 +2,11 @@
 #define BONGOCAT_ANIMATION_CONTEXT_H
 
 #include "animation_shared_memory.h"
+#include "frame_cache.h"
 #include "config/config.h"
 #include "utils/system_memory.h"
 #include "utils/random.h"
+#include "utils/histogram.h"
 #include <stdatomic.h>
 
 namespace bongocat::animation {
@@ -13,6 +15,25 @@ namespace bongocat::animation {
     void stop(animation_context_t& ctx);
     void cleanup(animation_context_t& ctx);
 
+    /// animation thread frame pacing, recorded on every tick; dumped on SIGUSR1 and on exit (enable_debug)
+    struct frame_timing_stats_t {
+        histogram_t tick_duration_us;       // woken up -> back in poll (state update, render notify, timer re-arm)
+        histogram_t tick_lateness_us;       // tick timer wake up behind the scheduled deadline
+        histogram_t skipped_frames;         // whole frame intervals (governed fps) the tick was late by
+        histogram_t update_locked_us;       // anim_update_state holding anim_lock
+
+        frame_timing_stats_t() = default;
+        ~frame_timing_stats_t() = default;
+        frame_timing_stats_t(const frame_timing_stats_t& other) = default;
+        frame_timing_stats_t& operator=(const frame_timing_stats_t& other) = default;
+    };
+    inline void reset_frame_timing_stats(frame_timing_stats_t& stats) {
+        histogram_reset(stats.tick_duration_us);
+        histogram_reset(stats.tick_lateness_us);
+        histogram_reset(stats.skipped_frames);
+        histogram_reset(stats.update_locked_us);
+    }
+
     struct animation_context_t {
         /// @NOTE: variables can be shared between child process and parent (see mmap)
         platform::MMapMemory<animation_shared_memory_t> shm;
@@ -26,6 +47,24 @@ namespace bongocat::animation {
         platform::Mutex anim_lock;
         platform::random_xoshiro128 rng;
 
+        // one-shot timer (timerfd) armed at the next possible state change, the animation thread sleeps until then (or key press)
+        platform::FileDescriptor _tick_tfd;
+        atomic_bool _wake_requested{false};
+
+        // frame rate picked by the governor (fps_active/fps_idle/fps_sleep), caps animation ticks and frame_done redraws
+        atomic_int _governed_fps{0};
+
+        // pipeline suspended (fullscreen), the animation thread is parked and input only keeps KPM bookkeeping
+        atomic_bool _suspended{false};
+
+        // current frame for the render thread, written by the animation thread only
+        published_animation_frame_t _published_frame;
+
+        // written by the animation thread only, read by print_frame_timing_stats
+        frame_timing_stats_t _frame_timing;
+
+        // pre-scaled frames of the current animation, only used by the render thread
+        frame_cache_t _frame_cache;
 
         animation_context_t() = default;
         ~animation_context_t() {
@@ -41,9 +80,21 @@ namespace bongocat::animation {
               _animation_running(atomic_load(&other._animation_running)),
               _anim_thread(other._anim_thread),
               anim_lock(bongocat::move(other.anim_lock)),
-              rng(bongocat::move(other.rng)) {
+              rng(bongocat::move(other.rng)),
+              _tick_tfd(bongocat::move(other._tick_tfd)),
+              _wake_requested(atomic_load(&other._wake_requested)),
+              _governed_fps(atomic_load(&other._governed_fps)),
+              _suspended(atomic_load(&other._suspended)),
+              _frame_timing(other._frame_timing),
+              _frame_cache(bongocat::move(other._frame_cache)) {
+            publish_animation_frame(_published_frame, read_animation_frame(other._published_frame));
+            reset_frame_timing_stats(other._frame_timing);
             other._animation_running = false;
             other._anim_thread = 0;
+            other._wake_requested = false;
+            other._governed_fps = 0;
+            other._suspended = false;
+            publish_animation_frame(other._published_frame, {});
         }
         animation_context_t& operator=(animation_context_t&& other) noexcept {
             if (this != &other) {
@@ -55,9 +106,21 @@ namespace bongocat::animation {
                 _anim_thread = other._anim_thread;
                 anim_lock = bongocat::move(other.anim_lock);
                 rng = bongocat::move(other.rng);
+                _tick_tfd = bongocat::move(other._tick_tfd);
+                atomic_store(&_wake_requested, atomic_load(&other._wake_requested));
+                atomic_store(&_governed_fps, atomic_load(&other._governed_fps));
+                atomic_store(&_suspended, atomic_load(&other._suspended));
+                publish_animation_frame(_published_frame, read_animation_frame(other._published_frame));
+                _frame_timing = other._frame_timing;
+                _frame_cache = bongocat::move(other._frame_cache);
 
                 other._animation_running = false;
                 other._anim_thread = 0;
+                other._wake_requested = false;
+                other._governed_fps = 0;
+                other._suspended = false;
+                publish_animation_frame(other._published_frame, {});
+                reset_frame_timing_stats(other._frame_timing);
                 other.rng = platform::random_xoshiro128(0);
             }
             return *this;
@@ -70,8 +133,15 @@ namespace bongocat::animation {
         }
         atomic_store(&ctx._animation_running, false);
         ctx._anim_thread = 0;
+        platform::close_fd(ctx._tick_tfd);
+        atomic_store(&ctx._wake_requested, false);
+        atomic_store(&ctx._governed_fps, 0);
+        atomic_store(&ctx._suspended, false);
+        publish_animation_frame(ctx._published_frame, {});
+        reset_frame_timing_stats(ctx._frame_timing);
         platform::release_allocated_mmap_memory(ctx.shm);
         platform::release_allocated_mmap_memory(ctx._local_copy_config);
+        cleanup_frame_cache(ctx._frame_cache);
         ctx.rng = platform::random_xoshiro128(0);
     }
 }
@@ -7,6 +7,7 @@
 #include "graphics/embedded_assets/clippy.hpp"
 #include "config/config.h"
 #include "utils/time.h"
+#include <stdatomic.h>
 
 namespace bongocat::animation {
     struct animation_player_data_t {
@@ -16,6 +17,72 @@ namespace bongocat::animation {
         int end_frame_index{0};
         platform::timestamp_ms_t time_until_next_frame_ms{0};
     };
+
+    /// animation state the render thread needs, published as one consistent snapshot
+    struct animation_frame_snapshot_t {
+        config::config_animation_type_t anim_type{config::config_animation_type_t::None};
+        int anim_index{0};
+        animation_player_data_t animation_player_data{};
+        // latency instrumentation: when the frame changed and the evdev time of the key press that changed it (0: not key triggered)
+        platform::timestamp_us_t changed_timestamp_us{0};
+        platform::timestamp_us_t input_timestamp_us{0};
+    };
+
+    /// seqlock: the animation thread is the only writer, the render thread reads without blocking it.
+    /// sequence is odd while a write is in progress, a reader retries when the sequence was odd or changed during the read
+    struct published_animation_frame_t {
+        atomic_uint sequence{0};
+        atomic_int anim_type{0};
+        atomic_int anim_index{0};
+        atomic_int frame_index{0};
+        atomic_int sprite_sheet_row{0};
+        atomic_int start_frame_index{0};
+        atomic_int end_frame_index{0};
+        atomic_int64_t time_until_next_frame_ms{0};
+        atomic_int64_t changed_timestamp_us{0};
+        atomic_int64_t input_timestamp_us{0};
+    };
+
+    inline void publish_animation_frame(published_animation_frame_t& published, const animation_frame_snapshot_t& snapshot) {
+        const unsigned sequence = atomic_load_explicit(&published.sequence, memory_order_relaxed);
+        atomic_store_explicit(&published.sequence, sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        atomic_store_explicit(&published.anim_type, static_cast<int>(snapshot.anim_type), memory_order_relaxed);
+        atomic_store_explicit(&published.anim_index, snapshot.anim_index, memory_order_relaxed);
+        atomic_store_explicit(&published.frame_index, snapshot.animation_player_data.frame_index, memory_order_relaxed);
+        atomic_store_explicit(&published.sprite_sheet_row, snapshot.animation_player_data.sprite_sheet_row, memory_order_relaxed);
+        atomic_store_explicit(&published.start_frame_index, snapshot.animation_player_data.start_frame_index, memory_order_relaxed);
+        atomic_store_explicit(&published.end_frame_index, snapshot.animation_player_data.end_frame_index, memory_order_relaxed);
+        atomic_store_explicit(&published.time_until_next_frame_ms, snapshot.animation_player_data.time_until_next_frame_ms, memory_order_relaxed);
+        atomic_store_explicit(&published.changed_timestamp_us, snapshot.changed_timestamp_us, memory_order_relaxed);
+        atomic_store_explicit(&published.input_timestamp_us, snapshot.input_timestamp_us, memory_order_relaxed);
+
+        atomic_store_explicit(&published.sequence, sequence + 2, memory_order_release);
+    }
+
+    inline animation_frame_snapshot_t read_animation_frame(const published_animation_frame_t& published) {
+        animation_frame_snapshot_t ret;
+        unsigned begin = 0;
+        unsigned end = 0;
+        do {
+            begin = atomic_load_explicit(&published.sequence, memory_order_acquire);
+
+            ret.anim_type = static_cast<config::config_animation_type_t>(atomic_load_explicit(&published.anim_type, memory_order_relaxed));
+            ret.anim_index = atomic_load_explicit(&published.anim_index, memory_order_relaxed);
+            ret.animation_player_data.frame_index = atomic_load_explicit(&published.frame_index, memory_order_relaxed);
+            ret.animation_player_data.sprite_sheet_row = atomic_load_explicit(&published.sprite_sheet_row, memory_order_relaxed);
+            ret.animation_player_data.start_frame_index = atomic_load_explicit(&published.start_frame_index, memory_order_relaxed);
+            ret.animation_player_data.end_frame_index = atomic_load_explicit(&published.end_frame_index, memory_order_relaxed);
+            ret.animation_player_data.time_until_next_frame_ms = atomic_load_explicit(&published.time_until_next_frame_ms, memory_order_relaxed);
+            ret.changed_timestamp_us = atomic_load_explicit(&published.changed_timestamp_us, memory_order_relaxed);
+            ret.input_timestamp_us = atomic_load_explicit(&published.input_timestamp_us, memory_order_relaxed);
+
+            atomic_thread_fence(memory_order_acquire);
+            end = atomic_load_explicit(&published.sequence, memory_order_relaxed);
+        } while (begin != end || (begin & 1u) != 0);
+        return ret;
+    }
     struct animation_shared_memory_t {
         // Animation frame data
         config::config_animation_type_t anim_type{config::config_animation_type_t::None};
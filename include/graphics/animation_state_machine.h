@@ -0,0 +1,253 @@
+#ifndef BONGOCAT_ANIMATION_STATE_MACHINE_H
+#define BONGOCAT_ANIMATION_STATE_MACHINE_H
+
+#include "graphics/embedded_assets.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace bongocat::animation {
+    enum class animation_state_row_t : uint8_t {
+        Idle,
+        StartWriting,
+        Writing,
+        EndWriting,
+        Happy,
+        Sleep,
+        WakeUp,
+        Boring,
+        Test,
+    };
+    inline static constexpr size_t ANIMATION_STATES_COUNT = static_cast<size_t>(animation_state_row_t::Test) + 1;
+
+    // events are collected once per update (as bit mask), a transition fires when all of its events are set
+    enum class animation_event_t : uint16_t {
+        None            = 0,
+        KeyDown         = (1u << 0),
+        HappyKpm        = (1u << 1),    // key down while KPM >= happy_kpm (chance rolled)
+        HoldExpired     = (1u << 2),    // no key down for keypress_duration after the last one
+        FrameTick       = (1u << 3),    // animation_speed (or 1/fps) passed since the last frame change
+        IdleTick        = (1u << 4),    // FrameTick with idle_animation enabled
+        ClipEnd         = (1u << 5),    // FrameTick on the last frame of a PlayOnce clip
+        TestStart       = (1u << 6),
+        TestEnd         = (1u << 7),
+        BoringTimeout   = (1u << 8),    // half of idle_sleep_timeout, only once until the next writing
+        SleepTime       = (1u << 9),    // idle_sleep_timeout or scheduled sleep
+    };
+    using animation_events_t = uint16_t;
+
+    constexpr animation_events_t animation_events(animation_event_t a, animation_event_t b = animation_event_t::None) {
+        return static_cast<animation_events_t>(static_cast<animation_events_t>(a) | static_cast<animation_events_t>(b));
+    }
+    constexpr bool has_animation_events(animation_events_t events, animation_events_t required) {
+        return required != 0 && (events & required) == required;
+    }
+
+    enum class animation_playback_t : uint8_t {
+        Still,          // first_frame (or fallback_frame)
+        Toggle,         // alternate first_frame and last_frame (only valid frames), random start
+        ToggleFirst,    // same as Toggle, start with first_frame
+        Loop,           // first_frame..last_frame, wrap around
+        PlayOnce,       // first_frame..last_frame, raises ClipEnd on the last frame
+        Hold,           // first_frame..last_frame, stop on the last frame
+    };
+
+    /// frames of a state (row) in the sprite sheet
+    struct animation_clip_t {
+        int row{0};
+        int first_frame{0};
+        int last_frame{0};
+        int fallback_frame{-1};     // used when neither first_frame nor last_frame is valid (sprite sheet region), -1: none
+        animation_playback_t playback{animation_playback_t::Still};
+    };
+
+    enum class animation_transition_action_t : uint8_t {
+        Enter,      // switch to state, start its clip (nothing changes when already in state)
+        Advance,    // next frame of the clip when already in state, otherwise Enter
+    };
+
+    enum class animation_transition_flags_t : uint8_t {
+        None                    = 0,
+        StartHoldAfterRelease   = (1u << 0),    // keypress hold starts now (clip that plays before writing ended)
+        ResetHold               = (1u << 1),    // key is still pressed, restart keypress hold
+    };
+
+    struct animation_transition_t {
+        animation_state_row_t from{animation_state_row_t::Idle};
+        bool from_any{false};
+        animation_events_t events{0};
+        animation_state_row_t to{animation_state_row_t::Idle};
+        animation_transition_action_t action{animation_transition_action_t::Enter};
+        animation_transition_flags_t flags{animation_transition_flags_t::None};
+    };
+
+    /// per pet family: clip per state and transitions in priority order (first match wins),
+    /// key transitions run on key down, idle transitions run on every update after that
+    struct animation_state_machine_t {
+        animation_clip_t clips[ANIMATION_STATES_COUNT]{};
+        const animation_transition_t *key_transitions{nullptr};
+        size_t key_transitions_count{0};
+        const animation_transition_t *idle_transitions{nullptr};
+        size_t idle_transitions_count{0};
+        int happy_chance_percent{0};    // chance to raise Happy on key down (KPM reached), 0: never
+    };
+
+    constexpr animation_transition_t transition(animation_state_row_t from, animation_events_t events, animation_state_row_t to,
+                                                animation_transition_action_t action = animation_transition_action_t::Enter,
+                                                animation_transition_flags_t flags = animation_transition_flags_t::None) {
+        return { .from = from, .from_any = false, .events = events, .to = to, .action = action, .flags = flags };
+    }
+    constexpr animation_transition_t transition_any(animation_events_t events, animation_state_row_t to,
+                                                    animation_transition_action_t action = animation_transition_action_t::Enter) {
+        return { .from = animation_state_row_t::Idle, .from_any = true, .events = events, .to = to, .action = action, .flags = animation_transition_flags_t::None };
+    }
+    constexpr size_t clip_index(animation_state_row_t state) {
+        return static_cast<size_t>(state);
+    }
+
+    // =============================================================================
+    // BONGOCAT
+    // =============================================================================
+
+#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
+    namespace bongocat_state_machine {
+        using enum animation_state_row_t;
+        using enum animation_event_t;
+        using enum animation_transition_action_t;
+        using enum animation_playback_t;
+
+        inline static constexpr int ROW = assets::BONGOCAT_SPRITE_SHEET_ROWS-1;
+
+        inline static constexpr animation_transition_t KEY_TRANSITIONS[] = {
+            transition_any(animation_events(KeyDown), Writing, Advance),
+        };
+        inline static constexpr animation_transition_t IDLE_TRANSITIONS[] = {
+            transition_any(animation_events(SleepTime), Sleep),
+            transition_any(animation_events(BoringTimeout), Boring),
+            transition_any(animation_events(HoldExpired), Idle),
+            transition(Test, animation_events(TestEnd), Idle),
+            transition(Idle, animation_events(TestStart), Test),
+        };
+
+        inline static constexpr animation_state_machine_t MACHINE = [] {
+            animation_state_machine_t ret;
+            for (auto& clip : ret.clips) {
+                clip = { .row = ROW, .first_frame = assets::BONGOCAT_FRAME_BOTH_UP, .last_frame = assets::BONGOCAT_FRAME_BOTH_UP, .fallback_frame = -1, .playback = Still };
+            }
+            ret.clips[clip_index(Writing)] = { .row = ROW, .first_frame = assets::BONGOCAT_FRAME_LEFT_DOWN, .last_frame = assets::BONGOCAT_FRAME_RIGHT_DOWN, .fallback_frame = -1, .playback = Toggle };
+            ret.clips[clip_index(Test)] = ret.clips[clip_index(Writing)];
+            ret.clips[clip_index(Sleep)] = { .row = ROW, .first_frame = assets::BONGOCAT_FRAME_BOTH_DOWN, .last_frame = assets::BONGOCAT_FRAME_BOTH_DOWN, .fallback_frame = -1, .playback = Still };
+            ret.clips[clip_index(Boring)] = ret.clips[clip_index(Sleep)];
+            ret.key_transitions = KEY_TRANSITIONS;
+            ret.key_transitions_count = sizeof(KEY_TRANSITIONS) / sizeof(KEY_TRANSITIONS[0]);
+            ret.idle_transitions = IDLE_TRANSITIONS;
+            ret.idle_transitions_count = sizeof(IDLE_TRANSITIONS) / sizeof(IDLE_TRANSITIONS[0]);
+            return ret;
+        }();
+    }
+#endif
+
+    // =============================================================================
+    // DIGIMON
+    // =============================================================================
+
+#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
+    namespace digimon_state_machine {
+        using enum animation_state_row_t;
+        using enum animation_event_t;
+        using enum animation_transition_action_t;
+        using enum animation_playback_t;
+
+        inline static constexpr int ROW = assets::DIGIMON_SPRITE_SHEET_ROWS-1;
+
+        inline static constexpr animation_transition_t KEY_TRANSITIONS[] = {
+            transition(Writing, animation_events(HappyKpm), Happy),
+            transition_any(animation_events(KeyDown), Writing, Advance),
+        };
+        inline static constexpr animation_transition_t IDLE_TRANSITIONS[] = {
+            transition(Sleep, animation_events(SleepTime, IdleTick), Sleep, Advance),
+            transition_any(animation_events(SleepTime), Sleep),
+            transition_any(animation_events(BoringTimeout), Boring),
+            transition_any(animation_events(HoldExpired), Idle, Advance),
+            transition(Test, animation_events(TestEnd), Idle, Advance),
+            transition_any(animation_events(IdleTick), Idle, Advance),
+            transition(Idle, animation_events(TestStart), Test),
+        };
+
+        inline static constexpr animation_state_machine_t MACHINE = [] {
+            animation_state_machine_t ret;
+            for (auto& clip : ret.clips) {
+                clip = { .row = ROW, .first_frame = assets::DIGIMON_FRAME_IDLE1, .last_frame = assets::DIGIMON_FRAME_IDLE2, .fallback_frame = -1, .playback = Toggle };
+            }
+            ret.clips[clip_index(Happy)] = { .row = ROW, .first_frame = assets::DIGIMON_FRAME_HAPPY, .last_frame = assets::DIGIMON_FRAME_HAPPY, .fallback_frame = -1, .playback = Still };
+            ret.clips[clip_index(Sleep)] = { .row = ROW, .first_frame = assets::DIGIMON_FRAME_SLEEP1, .last_frame = assets::DIGIMON_FRAME_SLEEP2, .fallback_frame = assets::DIGIMON_FRAME_DOWN1, .playback = ToggleFirst };
+            ret.clips[clip_index(Boring)] = { .row = ROW, .first_frame = assets::DIGIMON_FRAME_SAD, .last_frame = assets::DIGIMON_FRAME_SAD, .fallback_frame = assets::DIGIMON_FRAME_DOWN1, .playback = Still };
+            ret.key_transitions = KEY_TRANSITIONS;
+            ret.key_transitions_count = sizeof(KEY_TRANSITIONS) / sizeof(KEY_TRANSITIONS[0]);
+            ret.idle_transitions = IDLE_TRANSITIONS;
+            ret.idle_transitions_count = sizeof(IDLE_TRANSITIONS) / sizeof(IDLE_TRANSITIONS[0]);
+            ret.happy_chance_percent = assets::HAPPY_CHANCE_PERCENT;
+            return ret;
+        }();
+    }
+#endif
+
+    // =============================================================================
+    // MS PET (CLIPPY)
+    // =============================================================================
+
+#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
+    namespace ms_pet_state_machine {
+        using enum animation_state_row_t;
+        using enum animation_event_t;
+        using enum animation_transition_action_t;
+        using enum animation_playback_t;
+
+        inline static constexpr animation_transition_t KEY_TRANSITIONS[] = {
+            transition(Idle, animation_events(KeyDown), StartWriting),
+            transition(Writing, animation_events(KeyDown), Writing, Advance, animation_transition_flags_t::ResetHold),
+            transition(Sleep, animation_events(KeyDown), WakeUp),
+        };
+        inline static constexpr animation_transition_t IDLE_TRANSITIONS[] = {
+            transition(Idle, animation_events(SleepTime), Sleep),
+            transition(Idle, animation_events(BoringTimeout), Boring),
+            transition(Idle, animation_events(IdleTick), Idle, Advance),
+            transition(Writing, animation_events(HoldExpired), EndWriting),
+            transition(Writing, animation_events(FrameTick), Writing, Advance),
+            transition(StartWriting, animation_events(ClipEnd), Writing, Enter, animation_transition_flags_t::StartHoldAfterRelease),
+            transition(StartWriting, animation_events(FrameTick), StartWriting, Advance),
+            transition(EndWriting, animation_events(ClipEnd), Idle),
+            transition(EndWriting, animation_events(FrameTick), EndWriting, Advance),
+            transition(Sleep, animation_events(FrameTick), Sleep, Advance),
+            transition(WakeUp, animation_events(ClipEnd), Idle),
+            transition(WakeUp, animation_events(FrameTick), WakeUp, Advance),
+            transition(Boring, animation_events(ClipEnd), Idle),
+            transition(Boring, animation_events(FrameTick), Boring, Advance),
+        };
+
+        constexpr animation_clip_t clip(size_t row, size_t frames, animation_playback_t playback) {
+            return { .row = static_cast<int>(row), .first_frame = 0, .last_frame = static_cast<int>(frames)-1, .fallback_frame = -1, .playback = playback };
+        }
+
+        inline static constexpr animation_state_machine_t MACHINE = [] {
+            animation_state_machine_t ret;
+            // Test and Happy are not supported, same as idle
+            for (auto& c : ret.clips) {
+                c = clip(assets::CLIPPY_SPRITE_SHEET_ROW_IDLE, assets::CLIPPY_FRAMES_IDLE, Loop);
+            }
+            ret.clips[clip_index(StartWriting)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_START_WRITING, assets::CLIPPY_FRAMES_START_WRITING, PlayOnce);
+            ret.clips[clip_index(Writing)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_WRITING, assets::CLIPPY_FRAMES_WRITING, Loop);
+            ret.clips[clip_index(EndWriting)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_END_WRITING, assets::CLIPPY_FRAMES_END_WRITING, PlayOnce);
+            ret.clips[clip_index(Sleep)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_SLEEP, assets::CLIPPY_FRAMES_SLEEP, Hold);
+            ret.clips[clip_index(WakeUp)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_WAKE_UP, assets::CLIPPY_FRAMES_WAKE_UP, PlayOnce);
+            ret.clips[clip_index(Boring)] = clip(assets::CLIPPY_SPRITE_SHEET_ROW_BORING, assets::CLIPPY_FRAMES_BORING, PlayOnce);
+            ret.key_transitions = KEY_TRANSITIONS;
+            ret.key_transitions_count = sizeof(KEY_TRANSITIONS) / sizeof(KEY_TRANSITIONS[0]);
+            ret.idle_transitions = IDLE_TRANSITIONS;
+            ret.idle_transitions_count = sizeof(IDLE_TRANSITIONS) / sizeof(IDLE_TRANSITIONS[0]);
+            return ret;
+        }();
+    }
+#endif
+}
+
+#endif // BONGOCAT_ANIMATION_STATE_MACHINE_H
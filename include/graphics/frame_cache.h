@@ -0,0 +1,89 @@
+#ifndef BONGOCAT_ANIMATION_FRAME_CACHE_H
+#define BONGOCAT_ANIMATION_FRAME_CACHE_H
+
+#include "config/config.h"
+#include "utils/memory.h"
+#include <stdatomic.h>
+#include <cstdint>
+#include <cstddef>
+
+namespace bongocat::animation {
+    struct frame_cache_t;
+    void cleanup_frame_cache(frame_cache_t& cache);
+
+    /// frames of the current animation, already scaled to cat_width x cat_height and stored as BGRA (WL_SHM_FORMAT_ARGB8888),
+    /// a slot is built lazily on first draw, transparent pixels have alpha 0
+    struct frame_cache_t {
+        // cache key
+        config::config_animation_type_t anim_type{config::config_animation_type_t::None};
+        int anim_index{-1};
+        int frame_width{0};
+        int frame_height{0};
+
+        AllocatedArray<AllocatedArray<uint8_t>> slots;
+        size_t _size_bytes{0};                  // sum of all built slots
+
+        atomic_bool invalidated{false};         // set by update_config, cache gets dropped before next draw
+
+        frame_cache_t() = default;
+        ~frame_cache_t() {
+            cleanup_frame_cache(*this);
+        }
+
+        frame_cache_t(const frame_cache_t&) = delete;
+        frame_cache_t& operator=(const frame_cache_t&) = delete;
+
+        frame_cache_t(frame_cache_t&& other) noexcept
+            : anim_type(other.anim_type),
+              anim_index(other.anim_index),
+              frame_width(other.frame_width),
+              frame_height(other.frame_height),
+              slots(bongocat::move(other.slots)),
+              _size_bytes(other._size_bytes),
+              invalidated(atomic_load(&other.invalidated))
+        {
+            other.anim_type = config::config_animation_type_t::None;
+            other.anim_index = -1;
+            other.frame_width = 0;
+            other.frame_height = 0;
+            other._size_bytes = 0;
+            atomic_store(&other.invalidated, false);
+        }
+        frame_cache_t& operator=(frame_cache_t&& other) noexcept {
+            if (this != &other) {
+                cleanup_frame_cache(*this);
+
+                anim_type = other.anim_type;
+                anim_index = other.anim_index;
+                frame_width = other.frame_width;
+                frame_height = other.frame_height;
+                slots = bongocat::move(other.slots);
+                _size_bytes = other._size_bytes;
+                atomic_store(&invalidated, atomic_load(&other.invalidated));
+
+                other.anim_type = config::config_animation_type_t::None;
+                other.anim_index = -1;
+                other.frame_width = 0;
+                other.frame_height = 0;
+                other._size_bytes = 0;
+                atomic_store(&other.invalidated, false);
+            }
+            return *this;
+        }
+    };
+    inline void cleanup_frame_cache(frame_cache_t& cache) {
+        if (cache.slots) {
+            release_allocated_array(cache.slots);
+#ifndef BONGOCAT_DISABLE_MEMORY_STATISTICS
+            memory_set_frame_cache_size(0);
+#endif
+        }
+        cache.anim_type = config::config_animation_type_t::None;
+        cache.anim_index = -1;
+        cache.frame_width = 0;
+        cache.frame_height = 0;
+        cache._size_bytes = 0;
+    }
+}
+
+#endif // BONGOCAT_ANIMATION_FRAME_CACHE_H
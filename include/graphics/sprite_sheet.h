@@ -14,6 +14,33 @@ namespace bongocat::animation {
     inline static constexpr size_t MAX_NUM_FRAMES = 15;
     inline static constexpr size_t MAX_DIGIMON_FRAMES = 15;
 
+    /// opaque run in one sprite sheet row: pixels [start, start + length) have alpha > THRESHOLD_ALPHA
+    struct sprite_sheet_span_t {
+        int32_t start{0};
+        int32_t length{0};
+    };
+    /// opaque runs of every sprite sheet row, built once when loading the sprite sheet (see build_sprite_sheet_spans).
+    /// spans of row y: spans[row_offsets[y] .. row_offsets[y+1]), sorted by start
+    struct sprite_sheet_spans_t {
+        AllocatedArray<uint32_t> row_offsets;
+        AllocatedArray<sprite_sheet_span_t> spans;
+    };
+    inline void cleanup_sprite_sheet_spans(sprite_sheet_spans_t& spans) {
+        release_allocated_array(spans.row_offsets);
+        release_allocated_array(spans.spans);
+    }
+
+    inline static constexpr size_t SPRITE_SHEET_MAX_PALETTE_SIZE = 16;
+    /// `channels` of an indexed sprite sheet: one palette index per pixel, palette-unaware consumers fail the size checks instead of reading indices as RGBA
+    inline static constexpr int SPRITE_SHEET_INDEXED_CHANNELS = 1;
+    /// palette of an indexed sprite sheet (bits_per_pixel 1, 2 or 4), pixels hold packed indices (LSB first), index 0 is transparent, channels is SPRITE_SHEET_INDEXED_CHANNELS.
+    /// bits_per_pixel 0: pixels are `channels` bytes per pixel (RGBA)
+    struct sprite_sheet_palette_t {
+        int bits_per_pixel{0};
+        int colors_count{0};
+        uint32_t colors_bgra[SPRITE_SHEET_MAX_PALETTE_SIZE]{};  // ready to store into a WL_SHM_FORMAT_ARGB8888 buffer
+    };
+
     struct sprite_sheet_animation_region_t {
         bool valid{false};
         int col{0};
@@ -24,6 +51,8 @@ namespace bongocat::animation {
         int sprite_sheet_height{0};
         int channels{0};
         AllocatedArray<uint8_t> pixels;
+        sprite_sheet_spans_t spans;
+        sprite_sheet_palette_t palette;
 
         int frame_width{0};
         int frame_height{0};
@@ -55,6 +84,8 @@ namespace bongocat::animation {
         int sprite_sheet_height{0};
         int channels{0};
         AllocatedArray<uint8_t> pixels;
+        sprite_sheet_spans_t spans;
+        sprite_sheet_palette_t palette;
 
         int frame_width{0};
         int frame_height{0};
@@ -73,6 +104,8 @@ namespace bongocat::animation {
         int sprite_sheet_height{0};
         int channels{0};
         AllocatedArray<uint8_t> pixels;
+        sprite_sheet_spans_t spans;
+        sprite_sheet_palette_t palette;
 
         int frame_width{0};
         int frame_height{0};
@@ -100,6 +133,8 @@ namespace bongocat::animation {
             sprite_sheet.sprite_sheet_height = 0;
             sprite_sheet.channels = 0;
             sprite_sheet.pixels = {};
+            sprite_sheet.spans = {};
+            sprite_sheet.palette = {};
             sprite_sheet.frame_width = 0;
             sprite_sheet.frame_height = 0;
             sprite_sheet.total_frames = 0;
@@ -116,6 +151,8 @@ namespace bongocat::animation {
             sprite_sheet.sprite_sheet_height = other.sprite_sheet.sprite_sheet_height;
             sprite_sheet.channels = other.sprite_sheet.channels;
             sprite_sheet.pixels = other.sprite_sheet.pixels;
+            sprite_sheet.spans = other.sprite_sheet.spans;
+            sprite_sheet.palette = other.sprite_sheet.palette;
             sprite_sheet.frame_width = other.sprite_sheet.frame_width;
             sprite_sheet.frame_height = other.sprite_sheet.frame_height;
             sprite_sheet.total_frames = other.sprite_sheet.total_frames;
@@ -130,6 +167,8 @@ namespace bongocat::animation {
                 sprite_sheet.sprite_sheet_height = other.sprite_sheet.sprite_sheet_height;
                 sprite_sheet.channels = other.sprite_sheet.channels;
                 sprite_sheet.pixels = other.sprite_sheet.pixels;
+                sprite_sheet.spans = other.sprite_sheet.spans;
+                sprite_sheet.palette = other.sprite_sheet.palette;
                 sprite_sheet.frame_width = other.sprite_sheet.frame_width;
                 sprite_sheet.frame_height = other.sprite_sheet.frame_height;
                 sprite_sheet.total_frames = other.sprite_sheet.total_frames;
@@ -145,6 +184,8 @@ namespace bongocat::animation {
             sprite_sheet.sprite_sheet_height = other.sprite_sheet.sprite_sheet_height;
             sprite_sheet.channels = other.sprite_sheet.channels;
             sprite_sheet.pixels = bongocat::move(other.sprite_sheet.pixels);
+            sprite_sheet.spans = bongocat::move(other.sprite_sheet.spans);
+            sprite_sheet.palette = other.sprite_sheet.palette;
             sprite_sheet.frame_width = other.sprite_sheet.frame_width;
             sprite_sheet.frame_height = other.sprite_sheet.frame_height;
             sprite_sheet.total_frames = other.sprite_sheet.total_frames;
@@ -156,6 +197,8 @@ namespace bongocat::animation {
             other.sprite_sheet.sprite_sheet_height = 0;
             other.sprite_sheet.channels = 0;
             other.sprite_sheet.pixels = {};
+            other.sprite_sheet.spans = {};
+            other.sprite_sheet.palette = {};
             other.sprite_sheet.frame_width = 0;
             other.sprite_sheet.frame_height = 0;
             other.sprite_sheet.total_frames = 0;
@@ -169,6 +212,8 @@ namespace bongocat::animation {
                 sprite_sheet.sprite_sheet_height = other.sprite_sheet.sprite_sheet_height;
                 sprite_sheet.channels = other.sprite_sheet.channels;
                 sprite_sheet.pixels = bongocat::move(other.sprite_sheet.pixels);
+                sprite_sheet.spans = bongocat::move(other.sprite_sheet.spans);
+                sprite_sheet.palette = other.sprite_sheet.palette;
                 sprite_sheet.frame_width = other.sprite_sheet.frame_width;
                 sprite_sheet.frame_height = other.sprite_sheet.frame_height;
                 sprite_sheet.total_frames = other.sprite_sheet.total_frames;
@@ -180,6 +225,8 @@ namespace bongocat::animation {
                 other.sprite_sheet.sprite_sheet_height = 0;
                 other.sprite_sheet.channels = 0;
                 other.sprite_sheet.pixels = {};
+                other.sprite_sheet.spans = {};
+                other.sprite_sheet.palette = {};
                 other.sprite_sheet.frame_width = 0;
                 other.sprite_sheet.frame_height = 0;
                 other.sprite_sheet.total_frames = 0;
@@ -192,6 +239,8 @@ namespace bongocat::animation {
     };
     inline void cleanup_animation(animation_t& anim) {
         release_allocated_array(anim.sprite_sheet.pixels);
+        cleanup_sprite_sheet_spans(anim.sprite_sheet.spans);
+        anim.sprite_sheet.palette = {};
         anim.sprite_sheet.sprite_sheet_width = 0;
         anim.sprite_sheet.sprite_sheet_height = 0;
         anim.sprite_sheet.channels = 0;
@@ -212,17 +261,23 @@ namespace bongocat::animation {
         int sprite_sheet_height{0};
         int channels{0};
         AllocatedArray<uint8_t> pixels;
+        sprite_sheet_spans_t spans;
 
         int frame_width{0};
         int frame_height{0};
+        int frame_columns{0};
+        int frame_rows{0};
 
         ms_pet_sprite_sheet_t() {
             sprite_sheet_width = 0;
             sprite_sheet_height = 0;
             channels = 0;
             pixels = {};
+            spans = {};
             frame_width = 0;
             frame_height = 0;
+            frame_columns = 0;
+            frame_rows = 0;
         }
         ~ms_pet_sprite_sheet_t() {
             cleanup_animation(*this);
@@ -233,8 +288,11 @@ namespace bongocat::animation {
             sprite_sheet_height = other.sprite_sheet_height;
             channels = other.channels;
             pixels = other.pixels;
+            spans = other.spans;
             frame_width = other.frame_width;
             frame_height = other.frame_height;
+            frame_columns = other.frame_columns;
+            frame_rows = other.frame_rows;
         }
         ms_pet_sprite_sheet_t& operator=(const ms_pet_sprite_sheet_t& other) {
             if (this != &other) {
@@ -243,8 +301,11 @@ namespace bongocat::animation {
                 sprite_sheet_height = other.sprite_sheet_height;
                 channels = other.channels;
                 pixels = other.pixels;
+                spans = other.spans;
                 frame_width = other.frame_width;
                 frame_height = other.frame_height;
+                frame_columns = other.frame_columns;
+                frame_rows = other.frame_rows;
             }
             return *this;
         }
@@ -254,15 +315,21 @@ namespace bongocat::animation {
             sprite_sheet_height = other.sprite_sheet_height;
             channels = other.channels;
             pixels = bongocat::move(other.pixels);
+            spans = bongocat::move(other.spans);
             frame_width = other.frame_width;
             frame_height = other.frame_height;
+            frame_columns = other.frame_columns;
+            frame_rows = other.frame_rows;
 
             other.sprite_sheet_width = 0;
             other.sprite_sheet_height = 0;
             other.channels = 0;
             other.pixels = {};
+            other.spans = {};
             other.frame_width = 0;
             other.frame_height = 0;
+            other.frame_columns = 0;
+            other.frame_rows = 0;
         }
         ms_pet_sprite_sheet_t& operator=(ms_pet_sprite_sheet_t&& other) noexcept {
             if (this != &other) {
@@ -270,26 +337,35 @@ namespace bongocat::animation {
                 sprite_sheet_height = other.sprite_sheet_height;
                 channels = other.channels;
                 pixels = bongocat::move(other.pixels);
+                spans = bongocat::move(other.spans);
                 frame_width = other.frame_width;
                 frame_height = other.frame_height;
+                frame_columns = other.frame_columns;
+                frame_rows = other.frame_rows;
 
                 other.sprite_sheet_width = 0;
                 other.sprite_sheet_height = 0;
                 other.channels = 0;
                 other.pixels = {};
+                other.spans = {};
                 other.frame_width = 0;
                 other.frame_height = 0;
+                other.frame_columns = 0;
+                other.frame_rows = 0;
             }
             return *this;
         }
     };
     inline void cleanup_animation(ms_pet_sprite_sheet_t& sprite_sheet) {
         release_allocated_array(sprite_sheet.pixels);
+        cleanup_sprite_sheet_spans(sprite_sheet.spans);
         sprite_sheet.sprite_sheet_width = 0;
         sprite_sheet.sprite_sheet_height = 0;
         sprite_sheet.channels = 0;
         sprite_sheet.frame_width = 0;
         sprite_sheet.frame_height = 0;
+        sprite_sheet.frame_columns = 0;
+        sprite_sheet.frame_rows = 0;
     }
 }
 
@@ -0,0 +1,28 @@
+#ifndef BONGOCAT_HEADLESS_H
+#define BONGOCAT_HEADLESS_H
+
+#include "global_wayland_context.h"
+#include "graphics/global_animation_context.h"
+#include "platform/input_context.h"
+#include "utils/error.h"
+#include <csignal>
+
+namespace bongocat::platform::headless {
+    inline static constexpr int DEFAULT_SCREEN_WIDTH = 1920;
+
+    /// offscreen rendering without a compositor (benchmarks, CI), see --headless
+    struct headless_options_t {
+        bool enabled{false};
+        int screen_width{DEFAULT_SCREEN_WIDTH};
+        size_t max_frames{0};               // exit after this many drawn frames, 0: run until SIGINT/SIGTERM
+        const char *dump_dir{nullptr};      // write every drawn frame into this directory (nullptr: no dump)
+        bool dump_raw{false};               // dump BGRA as it is in the buffer instead of PPM (RGB)
+    };
+
+    /// same buffers as the wayland backend (shm, WAYLAND_NUM_BUFFERS), but no display, surface or wl_buffer
+    bongocat_error_t setup(wayland::wayland_session_t& ctx, animation::animation_session_t& anim, const headless_options_t& options);
+    /// draw_bar on every render event of the animation thread until stopped by signal or max_frames
+    bongocat_error_t run(wayland::wayland_session_t& ctx, volatile sig_atomic_t& running, int signal_fd, input::input_context_t& input, const headless_options_t& options);
+}
+
+#endif // BONGOCAT_HEADLESS_H
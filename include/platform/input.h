@@ -7,7 +7,7 @@
 #include "utils/error.h"
 
 namespace bongocat::platform::input {
-    created_result_t<input_context_t> create(const config::config_t& config);
+    created_result_t<input_context_t> create(const config::config_t& config, const input_source_t& source = {});
     bongocat_error_t start_monitoring(input_context_t& input, animation::animation_session_t& trigger_ctx, const config::config_t& config);
     bongocat_error_t restart_monitoring(input_context_t& input, animation::animation_session_t& trigger_ctx, const config::config_t& config);
     void update_config(input_context_t& ctx, const config::config_t& config);
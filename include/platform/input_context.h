@@ -3,15 +3,34 @@
 
 #include "config/config.h"
 #include "input_shared_memory.h"
+#include "input_device_registry.h"
+#include "input_uring.h"
 #include "utils/system_memory.h"
 #include "utils/time.h"
 #include <pthread.h>
 #include <stdatomic.h>
 
 namespace bongocat::platform::input {
-    struct input_unique_file_t {
-        const char* device_path{nullptr};     // ref to _device_paths
-        FileDescriptor fd;
+    inline static constexpr auto DEFAULT_INPUT_DEVICE_DIR = "/dev/input";
+
+    enum class input_source_type_t : uint8_t {
+        Devices,        // live evdev devices (keyboard_devices)
+        Replay,         // recorded struct input_event stream (file or pipe)
+    };
+
+    enum class input_backend_t : uint8_t {
+        Epoll,          // epoll_wait + one read() per ready device
+        IoUring,        // reads stay armed in an io_uring, completions are harvested in batches (falls back to Epoll)
+    };
+
+    /// where the input thread reads struct input_event records from
+    struct input_source_t {
+        input_source_type_t type{input_source_type_t::Devices};
+        const char *replay_path{nullptr};       // Replay: file or pipe, "-" for stdin
+        bool replay_fast{false};                // Replay: ignore the recorded timing, feed events as fast as possible (animation runs on the event timestamps)
+        const char *record_path{nullptr};       // Devices: write every event read from the devices into this file
+        const char *device_dir{nullptr};        // Devices: directory watched for hotplug (nullptr: DEFAULT_INPUT_DEVICE_DIR)
+        input_backend_t backend{input_backend_t::Epoll};  // Devices: how device fds are read
     };
 
     struct input_context_t;
@@ -31,12 +50,24 @@ namespace bongocat::platform::input {
         timestamp_ms_t _latest_kpm_update_ms{0};
 
         // thread context
-        AllocatedArray<char*> _device_paths;           // local copy of devices
-        AllocatedArray<size_t> _unique_paths_indices;
-        size_t _unique_paths_indices_capacity{0};      // keep real _unique_paths_indices count here, shrink _unique_paths_indices.count to used unique_paths_indices
-        AllocatedArray<input_unique_file_t> _unique_devices;
+        AllocatedArray<char*> _device_paths;           // local copy of devices (keyboard_device selectors)
+        input_device_registry_t _devices;              // one entry per physical device, index is the epoll tag
+
+        input_source_t _source;
+        FileDescriptor _record_fd;
+
+        // persistent event loop (devices are added/removed incrementally), eventfds wake the input thread
+        FileDescriptor _epoll_fd;
+        FileDescriptor _update_efd;         // config changed
+        FileDescriptor _shutdown_efd;       // stop requested
 
+        // inotify on the device dir (and by-id) in the epoll set, -1: periodic device checks
+        FileDescriptor _hotplug_fd;
+        int _hotplug_wd{-1};
+        int _hotplug_by_id_wd{-1};
 
+        // io_uring backend (thread context), the epoll set then only holds the eventfds and inotify
+        input_uring_t _uring;
 
         input_context_t() = default;
         ~input_context_t() {
@@ -54,15 +85,24 @@ namespace bongocat::platform::input {
               _input_kpm_counter(atomic_load(&other._input_kpm_counter)),
               _latest_kpm_update_ms(other._latest_kpm_update_ms),
               _device_paths(bongocat::move(other._device_paths)),
-              _unique_paths_indices(bongocat::move(other._unique_paths_indices)),
-              _unique_paths_indices_capacity(other._unique_paths_indices_capacity),
-              _unique_devices(bongocat::move(other._unique_devices))
+              _devices(bongocat::move(other._devices)),
+              _source(other._source),
+              _record_fd(bongocat::move(other._record_fd)),
+              _epoll_fd(bongocat::move(other._epoll_fd)),
+              _update_efd(bongocat::move(other._update_efd)),
+              _shutdown_efd(bongocat::move(other._shutdown_efd)),
+              _hotplug_fd(bongocat::move(other._hotplug_fd)),
+              _hotplug_wd(other._hotplug_wd),
+              _hotplug_by_id_wd(other._hotplug_by_id_wd),
+              _uring(bongocat::move(other._uring))
         {
             other._input_thread = 0;
             other._capture_input_running = false;
             other._input_kpm_counter = 0;
             other._latest_kpm_update_ms = 0;
-            other._unique_paths_indices_capacity = 0;
+            other._source = {};
+            other._hotplug_wd = -1;
+            other._hotplug_by_id_wd = -1;
         }
 
         input_context_t& operator=(input_context_t&& other) noexcept {
@@ -76,15 +116,24 @@ namespace bongocat::platform::input {
                 atomic_store(&_input_kpm_counter, atomic_load(&other._input_kpm_counter));
                 _latest_kpm_update_ms = other._latest_kpm_update_ms;
                 _device_paths = bongocat::move(other._device_paths);
-                _unique_paths_indices = bongocat::move(other._unique_paths_indices);
-                _unique_paths_indices_capacity = other._unique_paths_indices_capacity;
-                _unique_devices = bongocat::move(other._unique_devices);
+                _devices = bongocat::move(other._devices);
+                _source = other._source;
+                _record_fd = bongocat::move(other._record_fd);
+                _epoll_fd = bongocat::move(other._epoll_fd);
+                _update_efd = bongocat::move(other._update_efd);
+                _shutdown_efd = bongocat::move(other._shutdown_efd);
+                _hotplug_fd = bongocat::move(other._hotplug_fd);
+                _hotplug_wd = other._hotplug_wd;
+                _hotplug_by_id_wd = other._hotplug_by_id_wd;
+                _uring = bongocat::move(other._uring);
 
                 other._input_thread = 0;
                 other._capture_input_running = false;
                 other._input_kpm_counter = 0;
                 other._latest_kpm_update_ms = 0;
-                other._unique_paths_indices_capacity = 0;
+                other._source = {};
+                other._hotplug_wd = -1;
+                other._hotplug_by_id_wd = -1;
             }
             return *this;
         }
@@ -95,14 +144,22 @@ namespace bongocat::platform::input {
         }
         atomic_store(&input._capture_input_running, false);
         input._input_thread = 0;
-        release_allocated_array(input._unique_devices);
-        input._unique_paths_indices_capacity = 0;
-        release_allocated_array(input._unique_paths_indices);
+        release_input_device_registry(input._devices);
         for (size_t i = 0; i < input._device_paths.count; i++) {
             if (input._device_paths[i]) ::free(input._device_paths[i]);
             input._device_paths[i] = nullptr;
         }
         release_allocated_array(input._device_paths);
+        close_fd(input._record_fd);
+        input._source = {};
+        // closing the inotify instance drops its watches
+        close_fd(input._hotplug_fd);
+        input._hotplug_wd = -1;
+        input._hotplug_by_id_wd = -1;
+        release_input_uring(input._uring);
+        close_fd(input._shutdown_efd);
+        close_fd(input._update_efd);
+        close_fd(input._epoll_fd);
     }
 }
 
@@ -0,0 +1,106 @@
+#ifndef BONGOCAT_INPUT_DEVICE_REGISTRY_H
+#define BONGOCAT_INPUT_DEVICE_REGISTRY_H
+
+#include "core/bongocat.h"
+#include "utils/error.h"
+#include "utils/memory.h"
+#include "utils/system_memory.h"
+#include <sys/types.h>
+#include <cstdint>
+
+namespace bongocat::platform::input {
+    inline static constexpr size_t INPUT_DEVICE_PATH_BUF = 256;
+    inline static constexpr size_t INPUT_DEVICE_NAME_BUF = 128;
+    static_assert(MAX_INPUT_DEVICES <= UINT8_MAX + 1, "device_index in key_event_t is 8 bit");
+
+    // keyboard_device selectors, anything else is a literal path or a path glob (e.g. /dev/input/by-id/*-event-kbd)
+    inline static constexpr auto INPUT_DEVICE_SELECT_AUTO = "auto";             // every event node that looks like a keyboard
+    inline static constexpr auto INPUT_DEVICE_SELECT_NAME_PREFIX = "name:";     // name:<glob> on the device name (EVIOCGNAME)
+
+    enum class input_device_class_t : uint8_t {
+        Unknown,        // not probed (missing, no permission)
+        Keyboard,       // KEY_ESC..KEY_D, same rule as udev (ID_INPUT_KEYBOARD)
+        Buttons,        // keys, but no full keyboard: power/sleep buttons, media keys, macro pads
+        Pointer,        // mouse, touchpad, tablet
+        Other,          // switches, sensors, ...
+    };
+
+    struct input_device_t {
+        char path[INPUT_DEVICE_PATH_BUF]{};       // as configured or matched (can be a by-id link), empty: free slot
+        char name[INPUT_DEVICE_NAME_BUF]{};
+        // identity of the node: links and duplicate selectors resolve to the same st_rdev (st_ino for FIFO stand-ins)
+        dev_t rdev{0};
+        ino_t ino{0};
+        input_device_class_t device_class{input_device_class_t::Unknown};
+        uint16_t num_keys{0};                     // supported keys below BTN_MISC
+        bool pinned{false};                       // literal path from config, kept while missing (hotplug)
+        bool event_mask{false};                   // EVIOCSMASK installed on fd, the kernel drops everything but EV_KEY
+        FileDescriptor fd;
+    };
+
+    /// one entry (and one fd) per physical device, selected by the keyboard_device entries
+    struct input_device_registry_t {
+        AllocatedArray<input_device_t> devices;       // MAX_INPUT_DEVICES slots, [0, count) in use, index is the device_index of key events
+        size_t count{0};
+        const char *const *selectors{nullptr};        // ref to keyboard_device entries
+        size_t num_selectors{0};
+        const char *device_dir{nullptr};
+
+        input_device_registry_t() = default;
+        ~input_device_registry_t() = default;
+
+        input_device_registry_t(const input_device_registry_t&) = delete;
+        input_device_registry_t& operator=(const input_device_registry_t&) = delete;
+
+        input_device_registry_t(input_device_registry_t&& other) noexcept
+            : devices(bongocat::move(other.devices)),
+              count(other.count),
+              selectors(other.selectors),
+              num_selectors(other.num_selectors),
+              device_dir(other.device_dir)
+        {
+            other.count = 0;
+            other.selectors = nullptr;
+            other.num_selectors = 0;
+            other.device_dir = nullptr;
+        }
+        input_device_registry_t& operator=(input_device_registry_t&& other) noexcept {
+            if (this != &other) {
+                devices = bongocat::move(other.devices);
+                count = other.count;
+                selectors = other.selectors;
+                num_selectors = other.num_selectors;
+                device_dir = other.device_dir;
+
+                other.count = 0;
+                other.selectors = nullptr;
+                other.num_selectors = 0;
+                other.device_dir = nullptr;
+            }
+            return *this;
+        }
+    };
+
+    /// device name (EVIOCGNAME) and class from the EVIOCGBIT capabilities of an open evdev node
+    input_device_class_t probe_input_device(int fd, char *name, size_t name_size, uint16_t& num_keys);
+    /// kernel side event filter on an open evdev fd (EVIOCSMASK, Linux 4.4+): only EV_KEY is queued, frames without keys don't wake the reader,
+    /// false when not supported (older kernel, FIFO stand-in), the reader still filters in user space
+    bool set_key_event_mask(int fd);
+    /// expand the selectors into one entry per physical device (deduplicated by st_rdev), devices are not opened
+    bongocat_error_t build_input_device_registry(input_device_registry_t& registry, const char *const *selectors, size_t num_selectors, const char *device_dir);
+    /// entry of a (hotplugged) node, added when a selector picks it up, -1 when not selected or same device as another entry
+    ssize_t registry_lookup_or_add(input_device_registry_t& registry, const char *path);
+    /// identity and (when not probed yet) name/class from the freshly opened fd
+    void registry_refresh_device(input_device_t& device, int fd);
+    /// another entry with the same identity has an open fd
+    bool registry_is_duplicate(const input_device_registry_t& registry, size_t index);
+    /// free the slot of a removed (non-pinned) device, fd must be closed
+    void registry_remove_device(input_device_registry_t& registry, size_t index);
+    void release_input_device_registry(input_device_registry_t& registry);
+
+    /// same string or same device node (st_rdev)
+    bool same_input_device(const char *a, const char *b);
+    const char *input_device_class_string(input_device_class_t device_class);
+}
+
+#endif // BONGOCAT_INPUT_DEVICE_REGISTRY_H
@@ -2,14 +2,107 @@
 #define BONGOCAT_INPUT_SHARED_MEMORY_H
 
 #include "utils/time.h"
+#include <cstddef>
+#include <cstdint>
 #include <stdatomic.h>
 
 namespace bongocat::platform::input {
+    // =============================================================================
+    // KEY EVENT RING (input thread -> animation thread)
+    // =============================================================================
+
+    inline static constexpr size_t KEY_EVENT_RING_SIZE = 256;
+    static_assert((KEY_EVENT_RING_SIZE & (KEY_EVENT_RING_SIZE - 1)) == 0, "KEY_EVENT_RING_SIZE must be a power of two (indices wrap)");
+
+    enum class key_event_type_t : uint8_t {
+        Release = 0,
+        Press = 1,
+    };
+
+    struct key_event_t {
+        timestamp_us_t timestamp_us{0};         // evdev timestamp (CLOCK_REALTIME, same clock as get_current_time_us)
+        uint16_t code{0};                       // KEY_* / BTN_*
+        key_event_type_t type{key_event_type_t::Release};
+        uint8_t device_index{0};                // index into the unique input devices
+        uint16_t kpm{0};                        // input_shared_memory_t::kpm when the event was read
+    };
+
+    /// single-producer (input thread) single-consumer (animation thread) ring, head/tail run freely and wrap
+    struct key_event_ring_t {
+        atomic_uint head{0};                    // written by the producer only
+        atomic_uint tail{0};                    // written by the consumer only
+        atomic_uint dropped{0};                 // events lost because the ring was full
+        atomic_uint resets{0};                  // bumped when releases may be lost (ring full, device detached, ring recreated), consumer forgets held keys
+        key_event_t events[KEY_EVENT_RING_SIZE];
+
+        key_event_ring_t() = default;
+        ~key_event_ring_t() = default;
+
+        key_event_ring_t(const key_event_ring_t& other)
+            : head(atomic_load(&other.head)),
+              tail(atomic_load(&other.tail)),
+              dropped(atomic_load(&other.dropped)),
+              resets(atomic_load(&other.resets)) {
+            for (size_t i = 0; i < KEY_EVENT_RING_SIZE; i++) {
+                events[i] = other.events[i];
+            }
+        }
+        key_event_ring_t& operator=(const key_event_ring_t& other) {
+            if (this != &other) {
+                atomic_store(&head, atomic_load(&other.head));
+                atomic_store(&tail, atomic_load(&other.tail));
+                atomic_store(&dropped, atomic_load(&other.dropped));
+                atomic_store(&resets, atomic_load(&other.resets));
+                for (size_t i = 0; i < KEY_EVENT_RING_SIZE; i++) {
+                    events[i] = other.events[i];
+                }
+            }
+            return *this;
+        }
+    };
+
+    /// producer side, @return true when the ring was empty before (consumer needs a wake-up)
+    inline bool push_key_event(key_event_ring_t& ring, const key_event_t& ev) {
+        const unsigned int head = atomic_load_explicit(&ring.head, memory_order_relaxed);
+        if (head - atomic_load(&ring.tail) >= KEY_EVENT_RING_SIZE) {
+            // full, the consumer is already signaled
+            atomic_fetch_add_explicit(&ring.dropped, 1u, memory_order_relaxed);
+            atomic_fetch_add(&ring.resets, 1u);
+            return false;
+        }
+        ring.events[head % KEY_EVENT_RING_SIZE] = ev;
+        // seq_cst store head/load tail pairs with store tail/load head in pop_key_event:
+        // either the consumer still sees this event or we see the ring drained and signal
+        atomic_store(&ring.head, head + 1);
+        return atomic_load(&ring.tail) == head;
+    }
+
+    /// producer side, slots that can be pushed without dropping (the consumer only frees more)
+    inline size_t key_event_ring_free(key_event_ring_t& ring) {
+        return KEY_EVENT_RING_SIZE - (atomic_load_explicit(&ring.head, memory_order_relaxed) - atomic_load(&ring.tail));
+    }
+
+    /// consumer side, @return false when the ring is empty
+    inline bool pop_key_event(key_event_ring_t& ring, key_event_t& ev) {
+        const unsigned int tail = atomic_load_explicit(&ring.tail, memory_order_relaxed);
+        if (tail == atomic_load(&ring.head)) {
+            return false;
+        }
+        ev = ring.events[tail % KEY_EVENT_RING_SIZE];
+        atomic_store(&ring.tail, tail + 1);
+        return true;
+    }
+
+    // =============================================================================
+    // INPUT SHARED MEMORY
+    // =============================================================================
+
     struct input_shared_memory_t {
         int any_key_pressed{0};
         int kpm{0};                                     // keystrokes per minute
         atomic_int input_counter{0};
         timestamp_ms_t last_key_pressed_timestamp{0};
+        key_event_ring_t key_events;
 
         input_shared_memory_t() = default;
         ~input_shared_memory_t() = default;
@@ -18,13 +111,15 @@ namespace bongocat::platform::input {
             : any_key_pressed(other.any_key_pressed),
               kpm(other.kpm),
               input_counter(atomic_load(&other.input_counter)),
-              last_key_pressed_timestamp(other.last_key_pressed_timestamp) {}
+              last_key_pressed_timestamp(other.last_key_pressed_timestamp),
+              key_events(other.key_events) {}
         input_shared_memory_t& operator=(const input_shared_memory_t& other) {
             if (this != &other) {
                 any_key_pressed = other.any_key_pressed;
                 kpm = other.kpm;
                 atomic_store(&input_counter, atomic_load(&other.input_counter));
                 last_key_pressed_timestamp = other.last_key_pressed_timestamp;
+                key_events = other.key_events;
             }
             return *this;
         }
@@ -32,12 +127,14 @@ namespace bongocat::platform::input {
         input_shared_memory_t(input_shared_memory_t&& other) noexcept
             : any_key_pressed(other.any_key_pressed),
               kpm(other.kpm),
-              last_key_pressed_timestamp(other.last_key_pressed_timestamp) {
+              last_key_pressed_timestamp(other.last_key_pressed_timestamp),
+              key_events(other.key_events) {
             atomic_store(&input_counter, atomic_load(&other.input_counter));
 
             other.any_key_pressed = 0;
             other.kpm = 0;
             atomic_store(&other.input_counter, false);
+            other.key_events = {};
         }
         input_shared_memory_t& operator=(input_shared_memory_t&& other) noexcept {
             if (this != &other) {
@@ -45,10 +142,12 @@ namespace bongocat::platform::input {
                 kpm = other.kpm;
                 atomic_store(&input_counter, atomic_load(&other.input_counter));
                 last_key_pressed_timestamp = other.last_key_pressed_timestamp;
+                key_events = other.key_events;
 
                 other.any_key_pressed = 0;
                 other.kpm = 0;
                 atomic_store(&other.input_counter, false);
+                other.key_events = {};
             }
             return *this;
         }
@@ -0,0 +1,98 @@
+#ifndef BONGOCAT_INPUT_URING_H
+#define BONGOCAT_INPUT_URING_H
+
+#include "utils/error.h"
+#include "utils/memory.h"
+#include "utils/system_memory.h"
+#include <cstddef>
+#include <cstdint>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace bongocat::platform::input {
+    inline static constexpr unsigned INPUT_URING_ENTRIES = 512;         // >= one poll per device slot + cancels + control poll
+
+    /// minimal io_uring on raw syscalls (no liburing): single mmap for both rings, EXT_ARG wait timeout (Linux 5.11+)
+    struct io_uring_t {
+        FileDescriptor ring_fd;
+        void *rings{nullptr};
+        size_t rings_size{0};
+        io_uring_sqe *sqes{nullptr};
+        size_t sqes_size{0};
+
+        unsigned *sq_head{nullptr};
+        unsigned *sq_tail{nullptr};
+        unsigned sq_mask{0};
+        unsigned sq_entries{0};
+        unsigned sq_local_tail{0};          // prepared sqes, published with the next submit
+
+        unsigned *cq_head{nullptr};
+        unsigned *cq_tail{nullptr};
+        unsigned cq_mask{0};
+        io_uring_cqe *cqes{nullptr};
+
+        io_uring_t() = default;
+        ~io_uring_t();
+
+        io_uring_t(const io_uring_t&) = delete;
+        io_uring_t& operator=(const io_uring_t&) = delete;
+        io_uring_t(io_uring_t&& other) noexcept;
+        io_uring_t& operator=(io_uring_t&& other) noexcept;
+    };
+
+    bongocat_error_t uring_setup(io_uring_t& ring, unsigned entries);
+    /// zeroed sqe, nullptr when the submission queue is full
+    io_uring_sqe* uring_get_sqe(io_uring_t& ring);
+    /// publish prepared sqes and wait for one completion (one io_uring_enter), -errno on error (-ETIME: timeout)
+    int uring_submit_and_wait(io_uring_t& ring, int timeout_ms);
+    /// next completion or nullptr, release it with uring_cqe_seen
+    const io_uring_cqe* uring_peek_cqe(const io_uring_t& ring);
+    void uring_cqe_seen(io_uring_t& ring);
+    void uring_release(io_uring_t& ring);
+
+    void uring_prep_poll(io_uring_sqe *sqe, int fd, uint64_t user_data);
+    void uring_prep_cancel(io_uring_sqe *sqe, uint64_t target_user_data, uint64_t user_data);
+    uint64_t uring_cqe_user_data(const io_uring_cqe *cqe);
+    int32_t uring_cqe_res(const io_uring_cqe *cqe);
+
+    /// io_uring input backend state: a poll stays armed on every device, completions are harvested in batches
+    /// and the ready devices are read with non-blocking read() on the input thread (see input_uring.cpp)
+    struct input_uring_t {
+        io_uring_t ring;
+        AllocatedArray<uint32_t> generations;       // bumped on detach, completions of an old fd are dropped
+        AllocatedArray<uint8_t> poll_armed;         // poll of the current fd in flight per device slot
+        bool control_armed{false};                  // poll on the epoll fd (eventfds, inotify)
+
+        input_uring_t() = default;
+        ~input_uring_t() = default;
+
+        input_uring_t(const input_uring_t&) = delete;
+        input_uring_t& operator=(const input_uring_t&) = delete;
+
+        input_uring_t(input_uring_t&& other) noexcept
+            : ring(bongocat::move(other.ring)),
+              generations(bongocat::move(other.generations)),
+              poll_armed(bongocat::move(other.poll_armed)),
+              control_armed(other.control_armed)
+        {
+            other.control_armed = false;
+        }
+        input_uring_t& operator=(input_uring_t&& other) noexcept {
+            if (this != &other) {
+                ring = bongocat::move(other.ring);
+                generations = bongocat::move(other.generations);
+                poll_armed = bongocat::move(other.poll_armed);
+                control_armed = other.control_armed;
+                other.control_armed = false;
+            }
+            return *this;
+        }
+    };
+
+    /// ring and per-slot state for num_devices slots, BONGOCAT_ERROR_INPUT when io_uring is not available (kernel, seccomp, FEATURE_INPUT_IO_URING)
+    bongocat_error_t setup_input_uring(input_uring_t& uring, size_t num_devices);
+    void release_input_uring(input_uring_t& uring);
+}
+
+#endif // BONGOCAT_INPUT_URING_H
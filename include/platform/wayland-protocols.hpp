@@ -14,6 +14,8 @@ extern "C" {
 #include "../protocols/xdg-output-unstable-v1-client-protocol.h"
 #include "../protocols/xdg-shell-client-protocol.h"
 #include "../protocols/zwlr-layer-shell-v1-client-protocol.h"
+#include "../protocols/viewporter-client-protocol.h"
+#include "../protocols/presentation-time-client-protocol.h"
 }
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic pop
@@ -24,4 +26,6 @@ extern "C" {
 #include "../protocols/xdg-output-unstable-v1-client-protocol.h"
 #include "../protocols/xdg-shell-client-protocol.h"
 #include "../protocols/zwlr-layer-shell-v1-client-protocol.h"
+#include "../protocols/viewporter-client-protocol.h"
+#include "../protocols/presentation-time-client-protocol.h"
 #endif
\ No newline at end of file
@@ -18,6 +18,8 @@ namespace bongocat::platform::wayland {
     void update_config(wayland_context_t& ctx, const config::config_t& config, animation::animation_session_t& trigger_ctx);
 
     FileDescriptor create_shm(off_t size);
+    /// (re)create sprite sized buffers for the sprite subsurface
+    bongocat_error_t setup_sprite_buffers(wayland_context_t& ctx, animation::animation_session_t& anim, int width, int height);
 
     int get_screen_width(const wayland_session_t& ctx);
     const char* get_current_layer_name();
@@ -9,10 +9,39 @@ struct zwlr_layer_surface_v1;
 #include "config/config.h"
 #include <wayland-client.h>
 #include <stdatomic.h>
+#include <ctime>
 
 
 namespace bongocat::platform::wayland {
     inline static constexpr int MAX_ATTEMPTS = 2048;
+    /// frames in flight with a pending wp_presentation_feedback, frames beyond that are not measured
+    inline static constexpr size_t MAX_PRESENTATION_FEEDBACKS = 8;
+
+    /// wp_presentation_feedback for one commit, free when feedback is nullptr
+    struct presentation_feedback_slot_t {
+        struct wp_presentation_feedback *feedback{nullptr};
+        clockid_t clock_id{CLOCK_MONOTONIC};
+        timestamp_us_t committed_us{0};         // commit time in clock_id
+        timestamp_us_t input_timestamp_us{0};   // evdev timestamp of the key press that caused this frame (0: none)
+        frame_latency_stats_t *_stats{nullptr};
+    };
+
+    /// identity of the last presented frame, draw_bar skips clear, blit and commit when the next frame has the same key
+    struct frame_key_t {
+        config::config_animation_type_t anim_type{config::config_animation_type_t::None};
+        int anim_index{-1};
+        int sprite_sheet_row{-1};
+        int frame_index{-1};
+        int x{0};
+        int y{0};
+        int width{0};
+        int height{0};
+        int opacity{-1};
+        bool fullscreen{false};
+        bool valid{false};
+
+        bool operator==(const frame_key_t&) const = default;
+    };
 
     struct wayland_context_t;
     void cleanup_wayland_context(wayland_context_t& ctx);
@@ -26,6 +55,15 @@ namespace bongocat::platform::wayland {
         wl_output *output{nullptr};
         wl_surface *surface{nullptr};
         zwlr_layer_surface_v1 *layer_surface{nullptr};
+        // optional sprite subsurface (enable_subsurface), only this surface gets a new buffer per animation frame
+        wl_subcompositor *subcompositor{nullptr};
+        wl_surface *sprite_surface{nullptr};
+        wl_subsurface *sprite_subsurface{nullptr};
+        // optional compositor side scaling of the sprite subsurface, buffers stay at sprite sheet frame size
+        wp_viewporter *viewporter{nullptr};
+        wp_viewport *sprite_viewport{nullptr};
+        // optional presentation timing, only used for the latency statistics (enable_debug)
+        wp_presentation *presentation{nullptr};
 
         // @NOTE: variable can be shared between child process and parent (see mmap)
         MMapMemory<wayland_shared_memory_t> ctx_shm;
@@ -36,6 +74,13 @@ namespace bongocat::platform::wayland {
         int _screen_width{0};
         char* _output_name_str{nullptr};                  // ref to existing name in output, Will default to automatic one if kept null
         bool _fullscreen_detected{false};
+        bool _headless{false};                            // offscreen buffers only (no display/surface), see headless::setup
+        int _sprite_x{0};
+        int _sprite_y{0};
+        bool _sprite_visible{false};
+        int _sprite_viewport_width{0};
+        int _sprite_viewport_height{0};
+        frame_key_t _last_frame_key;
 
         // frame done callback data
         wl_callback *_frame_cb{nullptr};
@@ -44,6 +89,11 @@ namespace bongocat::platform::wayland {
         atomic_bool _redraw_after_frame{false};
         timestamp_ms_t _last_frame_timestamp_ms{0};
 
+        // latency statistics
+        clockid_t _presentation_clock_id{CLOCK_MONOTONIC};
+        presentation_feedback_slot_t _presentation_feedbacks[MAX_PRESENTATION_FEEDBACKS];
+        timestamp_us_t _last_latency_frame_us{0};   // changed_timestamp_us of the last measured frame
+
         wayland_context_t() = default;
         ~wayland_context_t() {
             cleanup_wayland_context(*this);
@@ -61,18 +111,37 @@ namespace bongocat::platform::wayland {
               output(other.output),
               surface(other.surface),
               layer_surface(other.layer_surface),
+              subcompositor(other.subcompositor),
+              sprite_surface(other.sprite_surface),
+              sprite_subsurface(other.sprite_subsurface),
+              viewporter(other.viewporter),
+              sprite_viewport(other.sprite_viewport),
+              presentation(other.presentation),
               ctx_shm(bongocat::move(other.ctx_shm)),
               _local_copy_config(bongocat::move(other._local_copy_config)),
               _bar_height(other._bar_height),
               _screen_width(other._screen_width),
               _output_name_str(other._output_name_str),
               _fullscreen_detected(other._fullscreen_detected),
+              _headless(other._headless),
+              _sprite_x(other._sprite_x),
+              _sprite_y(other._sprite_y),
+              _sprite_visible(other._sprite_visible),
+              _sprite_viewport_width(other._sprite_viewport_width),
+              _sprite_viewport_height(other._sprite_viewport_height),
+              _last_frame_key(other._last_frame_key),
               _frame_cb(other._frame_cb),
               _frame_cb_lock(bongocat::move(other._frame_cb_lock)),
               _frame_pending(other._frame_pending.load()),
               _redraw_after_frame(other._redraw_after_frame.load()),
-              _last_frame_timestamp_ms(other._last_frame_timestamp_ms)
+              _last_frame_timestamp_ms(other._last_frame_timestamp_ms),
+              _presentation_clock_id(other._presentation_clock_id),
+              _last_latency_frame_us(other._last_latency_frame_us)
         {
+            for (size_t i = 0; i < MAX_PRESENTATION_FEEDBACKS; i++) {
+                _presentation_feedbacks[i] = other._presentation_feedbacks[i];
+                other._presentation_feedbacks[i] = {};
+            }
             other.display = nullptr;
             other.compositor = nullptr;
             other.shm = nullptr;
@@ -81,6 +150,12 @@ namespace bongocat::platform::wayland {
             other.output = nullptr;
             other.surface = nullptr;
             other.layer_surface = nullptr;
+            other.subcompositor = nullptr;
+            other.sprite_surface = nullptr;
+            other.sprite_subsurface = nullptr;
+            other.viewporter = nullptr;
+            other.sprite_viewport = nullptr;
+            other.presentation = nullptr;
             other._output_name_str = nullptr;
             other._frame_cb = nullptr;
             other._frame_pending = false;
@@ -88,7 +163,16 @@ namespace bongocat::platform::wayland {
             other._bar_height = 0;
             other._screen_width = 0;
             other._fullscreen_detected = false;
+            other._headless = false;
+            other._sprite_x = 0;
+            other._sprite_y = 0;
+            other._sprite_visible = false;
+            other._sprite_viewport_width = 0;
+            other._sprite_viewport_height = 0;
+            other._last_frame_key = {};
             other._last_frame_timestamp_ms = 0;
+            other._presentation_clock_id = CLOCK_MONOTONIC;
+            other._last_latency_frame_us = 0;
         }
         wayland_context_t& operator=(wayland_context_t&& other) noexcept {
             if (this != &other) {
@@ -102,6 +186,12 @@ namespace bongocat::platform::wayland {
                 output = other.output;
                 surface = other.surface;
                 layer_surface = other.layer_surface;
+                subcompositor = other.subcompositor;
+                sprite_surface = other.sprite_surface;
+                sprite_subsurface = other.sprite_subsurface;
+                viewporter = other.viewporter;
+                sprite_viewport = other.sprite_viewport;
+                presentation = other.presentation;
 
                 ctx_shm = bongocat::move(other.ctx_shm);
                 _local_copy_config = bongocat::move(other._local_copy_config);
@@ -110,6 +200,13 @@ namespace bongocat::platform::wayland {
                 _screen_width = other._screen_width;
                 _output_name_str = other._output_name_str;
                 _fullscreen_detected = other._fullscreen_detected;
+                _headless = other._headless;
+                _sprite_x = other._sprite_x;
+                _sprite_y = other._sprite_y;
+                _sprite_visible = other._sprite_visible;
+                _sprite_viewport_width = other._sprite_viewport_width;
+                _sprite_viewport_height = other._sprite_viewport_height;
+                _last_frame_key = other._last_frame_key;
 
                 _frame_cb = other._frame_cb;
                 _frame_cb_lock = bongocat::move(other._frame_cb_lock);
@@ -117,6 +214,13 @@ namespace bongocat::platform::wayland {
                 _redraw_after_frame.store(other._redraw_after_frame.load());
                 _last_frame_timestamp_ms = other._last_frame_timestamp_ms;
 
+                _presentation_clock_id = other._presentation_clock_id;
+                for (size_t i = 0; i < MAX_PRESENTATION_FEEDBACKS; i++) {
+                    _presentation_feedbacks[i] = other._presentation_feedbacks[i];
+                    other._presentation_feedbacks[i] = {};
+                }
+                _last_latency_frame_us = other._last_latency_frame_us;
+
                 // reset moved-from
                 other.display = nullptr;
                 other.compositor = nullptr;
@@ -126,6 +230,12 @@ namespace bongocat::platform::wayland {
                 other.output = nullptr;
                 other.surface = nullptr;
                 other.layer_surface = nullptr;
+                other.subcompositor = nullptr;
+                other.sprite_surface = nullptr;
+                other.sprite_subsurface = nullptr;
+                other.viewporter = nullptr;
+                other.sprite_viewport = nullptr;
+                other.presentation = nullptr;
                 other._output_name_str = nullptr;
                 other._frame_cb = nullptr;
                 other._frame_pending = false;
@@ -133,7 +243,16 @@ namespace bongocat::platform::wayland {
                 other._screen_width = 0;
                 other._bar_height = 0;
                 other._fullscreen_detected = false;
+                other._headless = false;
+                other._sprite_x = 0;
+                other._sprite_y = 0;
+                other._sprite_visible = false;
+                other._sprite_viewport_width = 0;
+                other._sprite_viewport_height = 0;
+                other._last_frame_key = {};
                 other._last_frame_timestamp_ms = 0;
+                other._presentation_clock_id = CLOCK_MONOTONIC;
+                other._last_latency_frame_us = 0;
             }
             return *this;
         }
@@ -165,7 +284,26 @@ namespace bongocat::platform::wayland {
         ctx._frame_cb = nullptr;
         ctx._last_frame_timestamp_ms = 0;
 
+        // pending presentation feedback (unanswered frames are not measured)
+        for (size_t i = 0; i < MAX_PRESENTATION_FEEDBACKS; i++) {
+            if (ctx._presentation_feedbacks[i].feedback) wp_presentation_feedback_destroy(ctx._presentation_feedbacks[i].feedback);
+            ctx._presentation_feedbacks[i] = {};
+        }
+        ctx._last_latency_frame_us = 0;
+
         // surfaces
+        if (ctx.sprite_viewport) {
+            wp_viewport_destroy(ctx.sprite_viewport);
+            ctx.sprite_viewport = nullptr;
+        }
+        if (ctx.sprite_subsurface) {
+            wl_subsurface_destroy(ctx.sprite_subsurface);
+            ctx.sprite_subsurface = nullptr;
+        }
+        if (ctx.sprite_surface) {
+            wl_surface_destroy(ctx.sprite_surface);
+            ctx.sprite_surface = nullptr;
+        }
         if (ctx.layer_surface) {
             zwlr_layer_surface_v1_destroy(ctx.layer_surface);
             ctx.layer_surface = nullptr;
@@ -183,6 +321,18 @@ namespace bongocat::platform::wayland {
             xdg_wm_base_destroy(ctx.xdg_wm_base);
             ctx.xdg_wm_base = nullptr;
         }
+        if (ctx.presentation) {
+            wp_presentation_destroy(ctx.presentation);
+            ctx.presentation = nullptr;
+        }
+        if (ctx.viewporter) {
+            wp_viewporter_destroy(ctx.viewporter);
+            ctx.viewporter = nullptr;
+        }
+        if (ctx.subcompositor) {
+            wl_subcompositor_destroy(ctx.subcompositor);
+            ctx.subcompositor = nullptr;
+        }
         if (ctx.shm) {
             wl_shm_destroy(ctx.shm);
             ctx.shm = nullptr;
@@ -196,7 +346,10 @@ namespace bongocat::platform::wayland {
         if (ctx.ctx_shm.ptr && ctx.ctx_shm.ptr != MAP_FAILED) {
             for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
                 cleanup_shm_buffer(ctx.ctx_shm->buffers[i]);
+                cleanup_shm_buffer(ctx.ctx_shm->sprite_buffers[i]);
             }
+            ctx.ctx_shm->sprite_buffer_width = 0;
+            ctx.ctx_shm->sprite_buffer_height = 0;
         }
         release_allocated_mmap_memory(ctx.ctx_shm);
         release_allocated_mmap_memory(ctx._local_copy_config);
@@ -220,12 +373,26 @@ namespace bongocat::platform::wayland {
         ctx.output = nullptr;
         ctx.surface = nullptr;
         ctx.layer_surface = nullptr;
+        ctx.subcompositor = nullptr;
+        ctx.sprite_surface = nullptr;
+        ctx.sprite_subsurface = nullptr;
+        ctx.viewporter = nullptr;
+        ctx.sprite_viewport = nullptr;
+        ctx.presentation = nullptr;
         ctx._output_name_str = nullptr;
         ctx._frame_pending = false;
         ctx._redraw_after_frame = false;
         ctx._bar_height = 0;
         ctx._screen_width = 0;
         ctx._fullscreen_detected = false;
+        ctx._headless = false;
+        ctx._sprite_x = 0;
+        ctx._sprite_y = 0;
+        ctx._sprite_visible = false;
+        ctx._sprite_viewport_width = 0;
+        ctx._sprite_viewport_height = 0;
+        ctx._last_frame_key = {};
+        ctx._presentation_clock_id = CLOCK_MONOTONIC;
     }
 }
 
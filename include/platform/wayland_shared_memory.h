@@ -2,11 +2,21 @@
 #define BONGOCAT_WAYLAND_SHARED_MEMORY_H
 
 #include "graphics/global_animation_context.h"
+#include "utils/time.h"
+#include "utils/histogram.h"
 #include <wayland-client.h>
 #include <stdatomic.h>
 
 namespace bongocat::platform::wayland {
-    inline static constexpr size_t WAYLAND_NUM_BUFFERS = 1;
+    /// swapchain size, draw_bar picks any free buffer so a frame is only dropped when the compositor holds all of them
+    inline static constexpr size_t WAYLAND_NUM_BUFFERS = 3;
+
+    struct wayland_shm_buffer_rect_t {
+        int x{0};
+        int y{0};
+        int width{0};
+        int height{0};
+    };
 
     struct wayland_shm_buffer_t;
     void cleanup_shm_buffer(wayland_shm_buffer_t& buffer);
@@ -17,6 +27,12 @@ namespace bongocat::platform::wayland {
         atomic_bool busy{false};        // 0: free / 1: busy
         atomic_bool pending{false};     // 0/1: a render was requested while busy
         size_t index{0};                  // index track from wayland_shared_memory_t.buffers
+        platform::timestamp_us_t released_timestamp_us{0};    // last wl_buffer.release (0: never attached)
+        platform::timestamp_us_t committed_timestamp_us{0};   // last attach + commit
+
+        // damage tracking: everything outside of last_sprite_rect is background (cleared with opacity)
+        wayland_shm_buffer_rect_t last_sprite_rect;
+        atomic_bool needs_full_redraw{true};  // clear whole buffer on next draw (configure, opacity or fullscreen changed)
 
         // extra context for listeners
         animation::animation_session_t *_animation_trigger_context{nullptr};
@@ -33,16 +49,24 @@ namespace bongocat::platform::wayland {
             : buffer(other.buffer),
               pixels(bongocat::move(other.pixels)),
               index(other.index),
+              released_timestamp_us(other.released_timestamp_us),
+              committed_timestamp_us(other.committed_timestamp_us),
+              last_sprite_rect(other.last_sprite_rect),
               _animation_trigger_context(other._animation_trigger_context)
         {
             atomic_store(&busy, atomic_load(&other.busy));
             atomic_store(&pending, atomic_load(&other.pending));
+            atomic_store(&needs_full_redraw, atomic_load(&other.needs_full_redraw));
 
             other.buffer = nullptr;
             other.index = 0;
+            other.released_timestamp_us = 0;
+            other.committed_timestamp_us = 0;
+            other.last_sprite_rect = {};
             other._animation_trigger_context = nullptr;
             atomic_store(&other.busy, false);
             atomic_store(&other.pending, false);
+            atomic_store(&other.needs_full_redraw, true);
         }
         wayland_shm_buffer_t& operator=(wayland_shm_buffer_t&& other) noexcept {
             if (this != &other) {
@@ -51,13 +75,51 @@ namespace bongocat::platform::wayland {
                 atomic_store(&busy, atomic_load(&other.busy));
                 atomic_store(&pending, atomic_load(&other.pending));
                 index = other.index;
+                released_timestamp_us = other.released_timestamp_us;
+                committed_timestamp_us = other.committed_timestamp_us;
+                last_sprite_rect = other.last_sprite_rect;
+                atomic_store(&needs_full_redraw, atomic_load(&other.needs_full_redraw));
                 _animation_trigger_context = other._animation_trigger_context;
 
                 other.buffer = nullptr;
                 other.index = 0;
+                other.released_timestamp_us = 0;
+                other.committed_timestamp_us = 0;
+                other.last_sprite_rect = {};
                 other._animation_trigger_context = nullptr;
                 atomic_store(&other.busy, false);
                 atomic_store(&other.pending, false);
+                atomic_store(&other.needs_full_redraw, true);
+            }
+            return *this;
+        }
+    };
+
+    /// input-to-photon latency (us), only recorded with enable_debug
+    struct frame_latency_stats_t {
+        histogram_t input_to_animation;     // evdev timestamp -> animation thread published the new frame
+        histogram_t animation_to_commit;    // frame published -> wl_surface_commit
+        histogram_t commit_to_presented;    // wl_surface_commit -> wp_presentation_feedback.presented
+        histogram_t input_to_presented;     // evdev timestamp -> presented (only for frames caused by a key press)
+        atomic_size_t discarded{0};         // wp_presentation_feedback.discarded
+
+        frame_latency_stats_t() = default;
+        ~frame_latency_stats_t() = default;
+
+        frame_latency_stats_t(const frame_latency_stats_t& other)
+            : input_to_animation(other.input_to_animation),
+              animation_to_commit(other.animation_to_commit),
+              commit_to_presented(other.commit_to_presented),
+              input_to_presented(other.input_to_presented),
+              discarded(atomic_load(&other.discarded)) {
+        }
+        frame_latency_stats_t& operator=(const frame_latency_stats_t& other) {
+            if (this != &other) {
+                input_to_animation = other.input_to_animation;
+                animation_to_commit = other.animation_to_commit;
+                commit_to_presented = other.commit_to_presented;
+                input_to_presented = other.input_to_presented;
+                atomic_store(&discarded, atomic_load(&other.discarded));
             }
             return *this;
         }
@@ -66,34 +128,61 @@ namespace bongocat::platform::wayland {
     // Wayland globals
     struct wayland_shared_memory_t {
         wayland_shm_buffer_t buffers[WAYLAND_NUM_BUFFERS];
-        int current_buffer_index{0};
+        int current_buffer_index{0};        // last committed buffer (front buffer)
+        // sprite sized buffers for the sprite subsurface (enable_subsurface), created on first draw and when the sprite size changes
+        wayland_shm_buffer_t sprite_buffers[WAYLAND_NUM_BUFFERS];
+        int sprite_buffer_width{0};
+        int sprite_buffer_height{0};
         atomic_bool configured{false};
+        atomic_size_t dropped_frames{0};    // draw_bar was called while every buffer was held by the compositor
+        atomic_size_t skipped_commits{0};   // draw_bar was called, but the frame was identical to the last presented one
+        frame_latency_stats_t latency;
 
         wayland_shared_memory_t() = default;
         ~wayland_shared_memory_t() {
             atomic_store(&configured, false);
             current_buffer_index = 0;
+            atomic_store(&dropped_frames, 0);
+            atomic_store(&skipped_commits, 0);
+            histogram_reset(latency.input_to_animation);
+            histogram_reset(latency.animation_to_commit);
+            histogram_reset(latency.commit_to_presented);
+            histogram_reset(latency.input_to_presented);
+            atomic_store(&latency.discarded, 0);
             for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
                 cleanup_shm_buffer(buffers[i]);
+                cleanup_shm_buffer(sprite_buffers[i]);
             }
+            sprite_buffer_width = 0;
+            sprite_buffer_height = 0;
         }
 
         wayland_shared_memory_t(const wayland_shared_memory_t&) = delete;
         wayland_shared_memory_t& operator=(const wayland_shared_memory_t&) = delete;
 
         wayland_shared_memory_t(wayland_shared_memory_t&& other) noexcept
-            : buffers{}
+            : buffers{}, sprite_buffers{}
         {
             atomic_store(&configured, false);
             current_buffer_index = other.current_buffer_index;
             // Manually move each buffer
             for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
                 buffers[i] = bongocat::move(other.buffers[i]);
+                sprite_buffers[i] = bongocat::move(other.sprite_buffers[i]);
             }
+            sprite_buffer_width = other.sprite_buffer_width;
+            sprite_buffer_height = other.sprite_buffer_height;
             atomic_store(&configured, atomic_load(&other.configured));
+            atomic_store(&dropped_frames, atomic_load(&other.dropped_frames));
+            atomic_store(&skipped_commits, atomic_load(&other.skipped_commits));
+            latency = other.latency;
 
             other.current_buffer_index = 0;
+            other.sprite_buffer_width = 0;
+            other.sprite_buffer_height = 0;
             atomic_store(&other.configured, false);
+            atomic_store(&other.dropped_frames, 0);
+            atomic_store(&other.skipped_commits, 0);
         }
         wayland_shared_memory_t& operator=(wayland_shared_memory_t&& other) noexcept {
             if (this != &other) {
@@ -101,11 +190,21 @@ namespace bongocat::platform::wayland {
                 current_buffer_index = other.current_buffer_index;
                 for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; ++i) {
                     buffers[i] = move(other.buffers[i]);
+                    sprite_buffers[i] = move(other.sprite_buffers[i]);
                 }
+                sprite_buffer_width = other.sprite_buffer_width;
+                sprite_buffer_height = other.sprite_buffer_height;
                 atomic_store(&configured, atomic_load(&other.configured));
+                atomic_store(&dropped_frames, atomic_load(&other.dropped_frames));
+                atomic_store(&skipped_commits, atomic_load(&other.skipped_commits));
+                latency = other.latency;
 
                 other.current_buffer_index = 0;
+                other.sprite_buffer_width = 0;
+                other.sprite_buffer_height = 0;
                 atomic_store(&other.configured, false);
+                atomic_store(&other.dropped_frames, 0);
+                atomic_store(&other.skipped_commits, 0);
             }
             return *this;
         }
@@ -119,8 +218,49 @@ namespace bongocat::platform::wayland {
         release_allocated_mmap_file_buffer(buffer.pixels);
         atomic_store(&buffer.busy, false);
         buffer.index = 0;
+        buffer.released_timestamp_us = 0;
+        buffer.committed_timestamp_us = 0;
+        buffer.last_sprite_rect = {};
+        atomic_store(&buffer.needs_full_redraw, true);
         buffer._animation_trigger_context = nullptr;
     }
+
+    /// mark every buffer dirty, next draw_bar will clear and damage the whole surface
+    inline void request_full_redraw(wayland_shared_memory_t& ctx_shm) {
+        for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
+            atomic_store(&ctx_shm.buffers[i].needs_full_redraw, true);
+        }
+    }
+
+    /// free buffer with the oldest wl_buffer.release (never attached buffers first), nullptr when all buffers are busy
+    inline wayland_shm_buffer_t* find_free_buffer(wayland_shm_buffer_t (&buffers)[WAYLAND_NUM_BUFFERS]) {
+        wayland_shm_buffer_t *ret = nullptr;
+        for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
+            wayland_shm_buffer_t& buffer = buffers[i];
+            if (buffer.pixels.data == nullptr || atomic_load(&buffer.busy)) {
+                continue;
+            }
+            if (ret == nullptr || buffer.released_timestamp_us < ret->released_timestamp_us) {
+                ret = &buffer;
+            }
+        }
+        return ret;
+    }
+
+    /// busy buffer with the oldest commit, compositors release buffers in commit order so this one gets freed first
+    inline wayland_shm_buffer_t* find_oldest_busy_buffer(wayland_shm_buffer_t (&buffers)[WAYLAND_NUM_BUFFERS]) {
+        wayland_shm_buffer_t *ret = nullptr;
+        for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
+            wayland_shm_buffer_t& buffer = buffers[i];
+            if (buffer.pixels.data == nullptr || !atomic_load(&buffer.busy)) {
+                continue;
+            }
+            if (ret == nullptr || buffer.committed_timestamp_us < ret->committed_timestamp_us) {
+                ret = &buffer;
+            }
+        }
+        return ret;
+    }
 }
 
 #endif // BONGOCAT_WAYLAND_SHARED_MEMORY_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef BONGOCAT_HISTOGRAM_H
+#define BONGOCAT_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdatomic.h>
+
+namespace bongocat {
+    // HDR-style log-bucket histogram: every power-of-two range is split into HISTOGRAM_SUB_BUCKETS linear buckets,
+    // values below HISTOGRAM_SUB_BUCKETS are exact, relative error is at most 1/HISTOGRAM_SUB_BUCKETS
+    inline static constexpr size_t HISTOGRAM_SUB_BUCKET_BITS = 3;
+    inline static constexpr size_t HISTOGRAM_SUB_BUCKETS = 1u << HISTOGRAM_SUB_BUCKET_BITS;
+    inline static constexpr size_t HISTOGRAM_RANGES = 38;                 // up to 2^40 (~12 days in us), larger values land in the last bucket
+    inline static constexpr size_t HISTOGRAM_BUCKETS = HISTOGRAM_RANGES * HISTOGRAM_SUB_BUCKETS;
+
+    /// fixed memory, recording is a few relaxed atomic adds (no allocation, no lock)
+    struct histogram_t {
+        atomic_int64_t buckets[HISTOGRAM_BUCKETS];
+        atomic_int64_t count{0};
+        atomic_int64_t sum{0};
+        atomic_int64_t max{0};
+
+        histogram_t() {
+            for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                atomic_init(&buckets[i], 0);
+            }
+        }
+        ~histogram_t() = default;
+
+        histogram_t(const histogram_t& other)
+            : count(atomic_load(&other.count)),
+              sum(atomic_load(&other.sum)),
+              max(atomic_load(&other.max)) {
+            for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                atomic_init(&buckets[i], atomic_load_explicit(&other.buckets[i], memory_order_relaxed));
+            }
+        }
+        histogram_t& operator=(const histogram_t& other) {
+            if (this != &other) {
+                for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                    atomic_store_explicit(&buckets[i], atomic_load_explicit(&other.buckets[i], memory_order_relaxed), memory_order_relaxed);
+                }
+                atomic_store(&count, atomic_load(&other.count));
+                atomic_store(&sum, atomic_load(&other.sum));
+                atomic_store(&max, atomic_load(&other.max));
+            }
+            return *this;
+        }
+    };
+
+    void histogram_record(histogram_t& histogram, int64_t value);
+    void histogram_reset(histogram_t& histogram);
+    /// upper bound of the bucket that holds the percentile (0-100), clamped to the recorded max
+    int64_t histogram_value_at_percentile(const histogram_t& histogram, double percentile);
+    /// one log line: count, mean, p50/p95/p99 and max
+    void histogram_print(const char *name, const char *unit, const histogram_t& histogram);
+}
+
+#endif // BONGOCAT_HISTOGRAM_H
@@ -39,10 +39,14 @@ namespace bongocat {
         atomic_size_t peak_allocated;
         atomic_size_t allocation_count;
         atomic_size_t free_count;
+        atomic_size_t frame_cache_allocated;
+        atomic_size_t frame_cache_peak;
     };
 
     void memory_get_stats(memory_stats_t& stats);
     void memory_print_stats();
+    // pre-scaled frame cache (see frame_cache_t), memory is already included in allocated
+    void memory_set_frame_cache_size(size_t bytes);
 #endif
 
     // Memory leak detection (debug builds)
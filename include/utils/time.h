@@ -14,6 +14,9 @@ namespace bongocat::platform {
     timestamp_us_t get_current_time_us();
     timestamp_ms_t get_current_time_ms();
 
+    /// CLOCK_MONOTONIC, for measuring intervals (not affected by wall clock changes)
+    time_us_t get_monotonic_time_us();
+
     time_us_t get_uptime_us();
     time_ms_t get_uptime_ms();
 }
@@ -0,0 +1,85 @@
+#!/usr/bin/bash
+
+# Compare the epoll and io_uring input backends: syscalls and CPU time per 10k events
+# FIFOs in a temporary --input-dir stand in for evdev devices, bongocat runs headless.
+# Both backends wait for readiness (epoll, io_uring poll) and read() on the input thread, so FIFOs and evdev
+# nodes take the same path; io-wq kernel workers (iou-wrk-*) would run outside of the measured thread and are listed
+#
+# Usage: scripts/bench_input_backends.sh [events] [devices]
+#   BONGOCAT=./build/bongocat   binary to run
+#   STRACE=1                    also count all syscalls of the input thread with strace -c
+
+set -euo pipefail
+
+BONGOCAT="${BONGOCAT:-./build/bongocat}"
+EVENTS="${1:-10000}"
+DEVICES="${2:-4}"
+
+if [[ ! -x "$BONGOCAT" ]]; then
+    echo "bongocat binary not found: $BONGOCAT (build first or set BONGOCAT)" >&2
+    exit 1
+fi
+
+TMP_DIR="$(mktemp -d)"
+trap 'rm -rf "$TMP_DIR"' EXIT
+
+# events per device, key press/release frames (EV_KEY + SYN_REPORT) in bursts like a 1000 Hz device
+feed_devices() {
+    python3 - "$TMP_DIR/dev" "$EVENTS" <<'EOF'
+import os, struct, sys, time
+dev_dir, events = sys.argv[1], int(sys.argv[2])
+fds = [os.open(os.path.join(dev_dir, f), os.O_WRONLY) for f in sorted(os.listdir(dev_dir)) if f.startswith("event")]
+frame_events = 4
+for n in range(events // (frame_events * len(fds))):
+    now = time.time()
+    sec, usec = int(now), int((now % 1) * 1000000)
+    frame = (struct.pack("qqHHi", sec, usec, 1, 30, 1) + struct.pack("qqHHi", sec, usec, 0, 0, 0) +
+             struct.pack("qqHHi", sec, usec, 1, 30, 0) + struct.pack("qqHHi", sec, usec, 0, 0, 0))
+    for fd in fds:
+        os.write(fd, frame)
+    time.sleep(0.001)
+# keep the writers open, EOF would reopen the devices
+time.sleep(0.5)
+EOF
+}
+
+run_backend() {
+    local backend="$1"
+    rm -rf "$TMP_DIR/dev"
+    mkdir -p "$TMP_DIR/dev"
+    for i in $(seq 0 $((DEVICES - 1))); do
+        mkfifo "$TMP_DIR/dev/event$i"
+    done
+    cat > "$TMP_DIR/bench.conf" <<EOF
+enable_debug=1
+keyboard_device=$TMP_DIR/dev/event*
+EOF
+
+    local log="$TMP_DIR/$backend.log"
+    if [[ "${STRACE:-0}" == "1" ]]; then
+        strace -c -f -o "$TMP_DIR/$backend.strace" \
+            "$BONGOCAT" --headless --config "$TMP_DIR/bench.conf" --input-dir "$TMP_DIR/dev" --input-backend "$backend" > "$log" 2>&1 &
+    else
+        "$BONGOCAT" --headless --config "$TMP_DIR/bench.conf" --input-dir "$TMP_DIR/dev" --input-backend "$backend" > "$log" 2>&1 &
+    fi
+    local pid=$!
+    sleep 1
+
+    feed_devices
+    # idle io-wq workers linger for a few seconds, still visible here
+    local workers
+    workers="$(cat /proc/"$pid"/task/*/comm 2>/dev/null | grep -c '^iou-wrk' || true)"
+    kill -TERM "$pid"
+    wait "$pid" || true
+
+    echo "== $backend"
+    grep -E "Input loop|fall back" "$log" | sed 's/^.*DEBUG: //' || echo "no input loop statistics (enable_debug=1 required)"
+    echo "io-wq worker threads: $workers"
+    if [[ "${STRACE:-0}" == "1" ]]; then
+        grep -E "epoll_wait|read|io_uring_enter|total" "$TMP_DIR/$backend.strace" || true
+    fi
+}
+
+echo "Input backend benchmark: $EVENTS events on $DEVICES devices"
+run_backend epoll
+run_backend io_uring
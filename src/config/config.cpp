@@ -91,6 +91,10 @@ namespace bongocat::config {
     static inline constexpr auto CAT_ALIGN_KEY                      = "cat_align";
     static inline constexpr auto IDLE_ANIMATION_KEY                 = "idle_animation";
     static inline constexpr auto INPUT_FPS_KEY                      = "input_fps";
+    static inline constexpr auto ENABLE_SUBSURFACE_KEY              = "enable_subsurface";
+    static inline constexpr auto FPS_ACTIVE_KEY                     = "fps_active";
+    static inline constexpr auto FPS_IDLE_KEY                       = "fps_idle";
+    static inline constexpr auto FPS_SLEEP_KEY                      = "fps_sleep";
 
     static inline constexpr size_t VALUE_BUF = 256;
     static inline constexpr size_t LINE_BUF  = 512;
@@ -120,6 +124,9 @@ namespace bongocat::config {
         config_clamp_int(config.animation_speed_ms, MIN_DURATION_MS, MAX_DURATION_MS, TEST_ANIMATION_DURATION_KEY);
         config_clamp_int(config.idle_sleep_timeout_sec, MIN_TIMEOUT, MAX_TIMEOUT, IDLE_SLEEP_TIMEOUT_KEY);
         config_clamp_int(config.input_fps, 0, MAX_FPS, INPUT_FPS_KEY);
+        config_clamp_int(config.fps_active, MIN_FPS, MAX_FPS, FPS_ACTIVE_KEY);
+        config_clamp_int(config.fps_idle, MIN_FPS, MAX_FPS, FPS_IDLE_KEY);
+        config_clamp_int(config.fps_sleep, MIN_FPS, MAX_FPS, FPS_SLEEP_KEY);
 
         // Validate interval (0 is allowed to disable)
         if (config.test_animation_interval_sec < 0 || config.test_animation_interval_sec > MAX_INTERVAL_SEC) {
@@ -243,6 +250,7 @@ namespace bongocat::config {
         config.invert_color = config.invert_color ? 1 : 0;
         config.idle_animation = config.idle_animation ? 1 : 0;
         config.enable_scheduled_sleep = config.enable_scheduled_sleep ? 1 : 0;
+        config.enable_subsurface = config.enable_subsurface ? 1 : 0;
 
         config_validate_dimensions(config);
         config_validate_timing(config);
@@ -366,6 +374,14 @@ namespace bongocat::config {
             config.idle_animation = int_value;
         } else if (strcmp(key, INPUT_FPS_KEY) == 0) {
             config.input_fps = int_value;
+        } else if (strcmp(key, ENABLE_SUBSURFACE_KEY) == 0) {
+            config.enable_subsurface = int_value;
+        } else if (strcmp(key, FPS_ACTIVE_KEY) == 0) {
+            config.fps_active = int_value;
+        } else if (strcmp(key, FPS_IDLE_KEY) == 0) {
+            config.fps_idle = int_value;
+        } else if (strcmp(key, FPS_SLEEP_KEY) == 0) {
+            config.fps_sleep = int_value;
         } else {
             return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM; // Unknown key
         }
@@ -680,6 +696,10 @@ namespace bongocat::config {
         cfg.animation_type = config_animation_type_t::Bongocat;
         cfg.idle_animation = 0;
         cfg.input_fps = 0;          // when 0 fallback to fps
+        cfg.enable_subsurface = 0;
+        cfg.fps_active = 0;         // when 0 fallback to fps
+        cfg.fps_idle = 0;           // when 0 fallback to fps
+        cfg.fps_sleep = 0;          // when 0 fallback to fps_idle
 
         config = bongocat::move(cfg);
     }
@@ -704,7 +724,7 @@ namespace bongocat::config {
                               config.animation_index,
                               config.cat_x_offset, config.cat_y_offset);
         }
-        BONGOCAT_LOG_DEBUG("  FPS: %d, Opacity: %d", config.fps, config.overlay_opacity);
+        BONGOCAT_LOG_DEBUG("  FPS: %d (active: %d, idle: %d, sleep: %d), Opacity: %d", config.fps, config.fps_active, config.fps_idle, config.fps_sleep, config.overlay_opacity);
         BONGOCAT_LOG_DEBUG("  Position: %s", config.overlay_position == overlay_position_t::POSITION_TOP ? "top" : "bottom");
         BONGOCAT_LOG_DEBUG("  Alignment: %d", config.cat_align, config.cat_align == align_type_t::ALIGN_CENTER ? "(center)" : "");
         BONGOCAT_LOG_DEBUG("  Layer: %s", config.layer == layer_type_t::LAYER_TOP ? "top" : "overlay");
@@ -732,6 +752,15 @@ namespace bongocat::config {
         if (ret.input_fps <= 0) {
             ret.input_fps = ret.fps;
         }
+        if (ret.fps_active <= 0) {
+            ret.fps_active = ret.fps;
+        }
+        if (ret.fps_idle <= 0) {
+            ret.fps_idle = ret.fps;
+        }
+        if (ret.fps_sleep <= 0) {
+            ret.fps_sleep = ret.fps_idle;
+        }
 
         // Set default keyboard device if none specified
         if (ret.num_keyboard_devices == 0) {
@@ -1,5 +1,6 @@
 #include "core/bongocat.h"
 #include "platform/wayland.h"
+#include "platform/headless.h"
 #include "graphics/animation.h"
 #include "platform/input.h"
 #include "config/config.h"
@@ -39,6 +40,10 @@ namespace bongocat {
         platform::input::input_context_t input;
         animation::animation_session_t animation;
         platform::wayland::wayland_session_t wayland;
+        platform::headless::headless_options_t headless;
+        platform::input::input_source_t input_source;
+        bool has_seed{false};
+        uint32_t seed{0};
 
         platform::Mutex config_reload_mutex;
         const char *signal_watch_path{nullptr};
@@ -104,6 +109,18 @@ namespace bongocat {
         bool show_help{false};
         bool show_version{false};
         const char *output_name{};
+        bool headless{false};
+        int headless_width{platform::headless::DEFAULT_SCREEN_WIDTH};
+        size_t headless_frames{0};
+        const char *dump_frames_dir{};
+        bool dump_raw{false};
+        const char *replay_file{};
+        bool replay_fast{false};
+        const char *record_file{};
+        const char *input_dir{};
+        platform::input::input_backend_t input_backend{platform::input::input_backend_t::Epoll};
+        bool has_seed{false};
+        uint32_t seed{0};
     };
 
     // =============================================================================
@@ -114,6 +131,7 @@ namespace bongocat {
     
     inline static constexpr auto DEFAULT_PID_FILE = "/tmp/bongocat.pid";
     inline static constexpr auto PID_FILE_WITH_SUFFIX_TEMPLATE = "/tmp/bongocat-%s.pid";
+    inline static constexpr auto HEADLESS_PID_FILE_SUFFIX = "headless";
 
     static platform::FileDescriptor process_create_pid_file(const char *pid_filename) {
         platform::FileDescriptor fd = platform::FileDescriptor(open(pid_filename, O_CREAT | O_WRONLY | O_TRUNC, 0644));
@@ -245,7 +263,8 @@ namespace bongocat {
         for (int i = 0; i < new_config.num_keyboard_devices; i++) {
             bool found = false;
             for (int j = 0; j < old_config.num_keyboard_devices; j++) {
-                if (strcmp(new_config.keyboard_devices[i], old_config.keyboard_devices[j]) == 0) {
+                // links to the same node are the same device (selectors like auto/globs compare as strings)
+                if (platform::input::same_input_device(new_config.keyboard_devices[i], old_config.keyboard_devices[j])) {
                     found = true;
                     break;
                 }
@@ -327,6 +346,7 @@ namespace bongocat {
         sigaddset(&mask, SIGINT);
         sigaddset(&mask, SIGTERM);
         sigaddset(&mask, SIGCHLD);
+        sigaddset(&mask, SIGUSR1);
         sigaddset(&mask, SIGUSR2);
 
         // Block signals globally so they are only delivered via signalfd
@@ -351,7 +371,7 @@ namespace bongocat {
     static bongocat_error_t system_initialize_components(main_context_t& ctx) {
         // Initialize input system
         do {
-            auto [input, input_result] = platform::input::create(ctx.config);
+            auto [input, input_result] = platform::input::create(ctx.config, ctx.input_source);
             if (input_result != bongocat_error_t::BONGOCAT_SUCCESS) {
                 BONGOCAT_LOG_ERROR("Failed to initialize animation system: %s", bongocat::error_string(input_result));
                 return input_result;
@@ -367,6 +387,10 @@ namespace bongocat {
                 return animation_result;
             }
             ctx.animation = bongocat::move(animation);
+            // fixed seed, same random choices (e.g. happy chance) on every run
+            if (ctx.has_seed) {
+                ctx.animation.anim.rng = platform::random_xoshiro128(ctx.seed);
+            }
         } while (false);
 
         // Initialize Wayland
@@ -380,8 +404,10 @@ namespace bongocat {
             ctx.wayland = bongocat::move(wayland);
         } while (false);
 
-        // Setup wayland
-        bongocat_error_t setup_wayland_result = setup(ctx.wayland, ctx.animation);
+        // Setup wayland (or offscreen buffers)
+        bongocat_error_t setup_wayland_result = ctx.headless.enabled
+            ? platform::headless::setup(ctx.wayland, ctx.animation, ctx.headless)
+            : setup(ctx.wayland, ctx.animation);
         if (setup_wayland_result != bongocat_error_t::BONGOCAT_SUCCESS) {
             BONGOCAT_LOG_ERROR("Failed to setup wayland: %s", bongocat::error_string(setup_wayland_result));
             return setup_wayland_result;
@@ -409,6 +435,11 @@ namespace bongocat {
 
          [[maybe_unused]] const bool enable_debug = ctx.config.enable_debug;
 
+        // animation context is released by cleanup, dump its frame pacing first
+        if (enable_debug) {
+            animation::print_frame_timing_stats(ctx.animation.anim);
+        }
+
         ctx.running = 0;
         // Remove PID file
         process_remove_pid_file(pid_filename);
@@ -446,6 +477,17 @@ namespace bongocat {
         printf("  -w, --watch-config    Watch config file for changes and reload automatically\n");
         printf("  -t, --toggle          Toggle bongocat on/off (start if not running, stop if running)\n");
         printf("  -o, --output-name     Specify output name (overwrite output_name from config)\n");
+        printf("      --headless        Render offscreen without a Wayland compositor (benchmarks, CI)\n");
+        printf("      --headless-width  Bar width in headless mode (default: %d)\n", platform::headless::DEFAULT_SCREEN_WIDTH);
+        printf("      --frames          Exit after N drawn frames in headless mode (default: run until stopped)\n");
+        printf("      --dump-frames     Write every drawn frame as PPM into a directory (headless mode)\n");
+        printf("      --dump-raw        Dump frames as raw BGRA instead of PPM\n");
+        printf("      --replay          Read input events from a recording instead of devices ('-' for stdin)\n");
+        printf("      --replay-fast     Replay without waiting, the animation follows the recorded timestamps\n");
+        printf("      --record          Record raw input events of the keyboard devices into a file\n");
+        printf("      --input-dir       Directory watched for input device hotplug (default: %s)\n", platform::input::DEFAULT_INPUT_DEVICE_DIR);
+        printf("      --input-backend   Read input devices with epoll or io_uring (default: epoll)\n");
+        printf("      --seed            Seed for the animation random generator (deterministic runs)\n");
         printf("\nConfiguration is loaded from bongocat.conf in the current directory.\n");
     }
 
@@ -463,6 +505,18 @@ namespace bongocat {
             .show_help = false,
             .show_version = false,
             .output_name = nullptr,
+            .headless = false,
+            .headless_width = platform::headless::DEFAULT_SCREEN_WIDTH,
+            .headless_frames = 0,
+            .dump_frames_dir = nullptr,
+            .dump_raw = false,
+            .replay_file = nullptr,
+            .replay_fast = false,
+            .record_file = nullptr,
+            .input_dir = nullptr,
+            .input_backend = platform::input::input_backend_t::Epoll,
+            .has_seed = false,
+            .seed = 0,
         };
 
         for (int i = 1; i < argc; i++) {
@@ -490,6 +544,80 @@ namespace bongocat {
                     BONGOCAT_LOG_ERROR("--output-name option requires a output name");
                     return EXIT_FAILURE;
                 }
+            } else if (strcmp(argv[i], "--headless") == 0) {
+                args.headless = true;
+            } else if (strcmp(argv[i], "--headless-width") == 0) {
+                if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                    args.headless_width = atoi(argv[i + 1]);
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--headless-width option requires a width > 0");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--frames") == 0) {
+                if (i + 1 < argc && atoi(argv[i + 1]) > 0) {
+                    args.headless_frames = static_cast<size_t>(atoi(argv[i + 1]));
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--frames option requires a frame count > 0");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--dump-frames") == 0) {
+                if (i + 1 < argc) {
+                    args.dump_frames_dir = argv[i + 1];
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--dump-frames option requires a directory");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--dump-raw") == 0) {
+                args.dump_raw = true;
+            } else if (strcmp(argv[i], "--replay") == 0) {
+                if (i + 1 < argc) {
+                    args.replay_file = argv[i + 1];
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--replay option requires a file path");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--replay-fast") == 0) {
+                args.replay_fast = true;
+            } else if (strcmp(argv[i], "--record") == 0) {
+                if (i + 1 < argc) {
+                    args.record_file = argv[i + 1];
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--record option requires a file path");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--input-dir") == 0) {
+                if (i + 1 < argc) {
+                    args.input_dir = argv[i + 1];
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--input-dir option requires a directory");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--input-backend") == 0) {
+                if (i + 1 < argc && strcmp(argv[i + 1], "epoll") == 0) {
+                    args.input_backend = platform::input::input_backend_t::Epoll;
+                    i++;
+                } else if (i + 1 < argc && strcmp(argv[i + 1], "io_uring") == 0) {
+                    args.input_backend = platform::input::input_backend_t::IoUring;
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--input-backend option requires 'epoll' or 'io_uring'");
+                    return EXIT_FAILURE;
+                }
+            } else if (strcmp(argv[i], "--seed") == 0) {
+                if (i + 1 < argc) {
+                    args.seed = static_cast<uint32_t>(strtoul(argv[i + 1], nullptr, 10));
+                    args.has_seed = true;
+                    i++;
+                } else {
+                    BONGOCAT_LOG_ERROR("--seed option requires a number");
+                    return EXIT_FAILURE;
+                }
             } else {
                 BONGOCAT_LOG_WARNING("Unknown argument: %s", argv[i]);
             }
@@ -542,9 +670,44 @@ int main(int argc, char *argv[]) {
     ctx.config = bongocat::move(config);
     bongocat::error_init(ctx.config.enable_debug);
 
-    // set pid file, based on output_name
+    ctx.headless = {
+        .enabled = args.headless,
+        .screen_width = args.headless_width,
+        .max_frames = args.headless_frames,
+        .dump_dir = args.dump_frames_dir,
+        .dump_raw = args.dump_raw,
+    };
+    if (!args.headless && (args.headless_frames > 0 || args.dump_frames_dir)) {
+        BONGOCAT_LOG_WARNING("--frames and --dump-frames are only used with --headless");
+    }
+
+    ctx.input_source = {
+        .type = args.replay_file ? platform::input::input_source_type_t::Replay : platform::input::input_source_type_t::Devices,
+        .replay_path = args.replay_file,
+        .replay_fast = args.replay_fast,
+        .record_path = args.record_file,
+        .device_dir = args.input_dir,
+        .backend = args.input_backend,
+    };
+    if (args.replay_file && args.record_file) {
+        BONGOCAT_LOG_WARNING("--record is ignored while replaying input");
+    }
+    ctx.has_seed = args.has_seed;
+    ctx.seed = args.seed;
+
+    // set pid file, based on output_name (headless instances don't block the overlay)
     char* pid_filename = nullptr;
-    if (ctx.config.output_name && ctx.config.output_name[0] != '\0') {
+    if (ctx.headless.enabled && (!ctx.config.output_name || ctx.config.output_name[0] == '\0')) {
+        const int needed_size = snprintf(nullptr, 0, PID_FILE_WITH_SUFFIX_TEMPLATE, HEADLESS_PID_FILE_SUFFIX) + 1;
+        assert(needed_size >= 0);
+        pid_filename = static_cast<char *>(::malloc(static_cast<size_t>(needed_size)));
+        if (pid_filename != nullptr) {
+            snprintf(pid_filename, static_cast<size_t>(needed_size), PID_FILE_WITH_SUFFIX_TEMPLATE, HEADLESS_PID_FILE_SUFFIX);
+        } else {
+            BONGOCAT_LOG_ERROR("Failed to allocate PID filename");
+            return EXIT_FAILURE;
+        }
+    } else if (ctx.config.output_name && ctx.config.output_name[0] != '\0') {
         const int needed_size = snprintf(nullptr, 0, PID_FILE_WITH_SUFFIX_TEMPLATE, ctx.config.output_name) + 1;
         assert(needed_size >= 0);
         pid_filename = static_cast<char *>(::malloc(static_cast<size_t>(needed_size)));
@@ -621,7 +784,9 @@ int main(int argc, char *argv[]) {
     // trigger initial rendering
     platform::wayland::request_render(ctx.animation);
     // Main Wayland event loop with graceful shutdown
-    result = run(ctx.wayland, ctx.running, ctx.signal_fd._fd, ctx.input, ctx.config, ctx.config_watcher, config_reload_callback);
+    result = ctx.headless.enabled
+        ? platform::headless::run(ctx.wayland, ctx.running, ctx.signal_fd._fd, ctx.input, ctx.headless)
+        : run(ctx.wayland, ctx.running, ctx.signal_fd._fd, ctx.input, ctx.config, ctx.config_watcher, config_reload_callback);
     if (result != bongocat_error_t::BONGOCAT_SUCCESS) {
         BONGOCAT_LOG_ERROR("Wayland event loop error: %s", bongocat::error_string(result));
         system_cleanup_and_exit(ctx, pid_filename, EXIT_FAILURE);
@@ -1,6 +1,7 @@
 #include "graphics/embedded_assets.h"
 #include "graphics/animation_context.h"
 #include "graphics/animation.h"
+#include "graphics/animation_state_machine.h"
 #include "platform/wayland.h"
 #include "utils/time.h"
 #include "utils/memory.h"
@@ -11,16 +12,20 @@
 #include <climits>
 #include <poll.h>
 #include <unistd.h>
+#include <sys/timerfd.h>
+#include <linux/input-event-codes.h>
 
 namespace bongocat::animation {
     // =============================================================================
     // GLOBAL STATE AND CONFIGURATION
     // =============================================================================
 
-    inline static constexpr platform::time_ms_t POOL_MIN_TIMEOUT_MS = 5;
-    inline static constexpr platform::time_ms_t POOL_MAX_TIMEOUT_MS = 1000;
-    inline static constexpr size_t MAX_ATTEMPTS = 2048;
-    static_assert(POOL_MAX_TIMEOUT_MS >= POOL_MIN_TIMEOUT_MS);
+    // no pending state change, only a key press (or config update) can change the frame
+    inline static constexpr platform::time_ms_t NO_DEADLINE_MS = -1;
+    inline static constexpr int MINUTES_PER_DAY = 24 * 60;
+    // fps_active decays exponentially towards fps_idle after the last input, excess frame rate halves every half-life
+    inline static constexpr platform::time_ms_t FPS_DECAY_HALF_LIFE_MS = 500;
+    inline static constexpr platform::time_ms_t FPS_DECAY_MAX_HALVINGS = 16;
 
     // =============================================================================
     // ANIMATION STATE MANAGEMENT MODULE
@@ -44,951 +49,630 @@ namespace bongocat::animation {
                             : (now_minutes >= begin || now_minutes < end));
     }
 
-    enum class animation_state_row_t : uint8_t {
-        Idle,
-        StartWriting,
-        Writing,
-        EndWriting,
-        Happy,
-        Sleep,
-        WakeUp,
-        Boring,
-        Test,
+    // time until the next sleep_begin/sleep_end minute boundary, NO_DEADLINE_MS when sleeping all day
+    static platform::time_ms_t ms_until_sleep_schedule_change(const config::config_t& config) {
+        timespec now{};
+        clock_gettime(CLOCK_REALTIME, &now);
+        const time_t raw_time = now.tv_sec;
+        tm time_info{};
+        localtime_r(&raw_time, &time_info);
+
+        const int now_minutes = time_info.tm_hour * 60 + time_info.tm_min;
+        const int begin = config.sleep_begin.hour * 60 + config.sleep_begin.min;
+        const int end = config.sleep_end.hour * 60 + config.sleep_end.min;
+        if (begin == end) {
+            return NO_DEADLINE_MS;
+        }
+
+        int to_begin = ((begin - now_minutes) % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+        int to_end = ((end - now_minutes) % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+        to_begin = to_begin == 0 ? MINUTES_PER_DAY : to_begin;
+        to_end = to_end == 0 ? MINUTES_PER_DAY : to_end;
+        const int minutes = to_begin < to_end ? to_begin : to_end;
+
+        return static_cast<platform::time_ms_t>(minutes) * 60 * 1000
+               - static_cast<platform::time_ms_t>(time_info.tm_sec) * 1000
+               - now.tv_nsec / 1000000L;
+    }
+
+    // keyboard half of a key (QWERTY), picks the paw
+    enum class key_side_t : uint8_t {
+        Unknown,
+        Left,
+        Right,
     };
 
+    static key_side_t key_code_side(uint16_t code) {
+        switch (code) {
+            case KEY_ESC: case KEY_GRAVE: case KEY_TAB: case KEY_CAPSLOCK:
+            case KEY_LEFTSHIFT: case KEY_102ND: case KEY_LEFTCTRL: case KEY_LEFTMETA: case KEY_LEFTALT:
+                return key_side_t::Left;
+            case KEY_SPACE:
+                return key_side_t::Unknown;
+            default:
+                break;
+        }
+        if ((code >= KEY_1 && code <= KEY_5) || (code >= KEY_Q && code <= KEY_T) ||
+            (code >= KEY_A && code <= KEY_G) || (code >= KEY_Z && code <= KEY_B) ||
+            (code >= KEY_F1 && code <= KEY_F5)) {
+            return key_side_t::Left;
+        }
+        // mouse/joystick buttons
+        return code < BTN_MISC ? key_side_t::Right : key_side_t::Unknown;
+    }
+
     struct animation_state_t {
         platform::time_ms_t frame_delta_ms_counter{0};
         platform::time_ns_t frame_time_ns{0};
         platform::time_ms_t frame_time_ms{0};
         platform::time_ms_t hold_frame_ms{0};
+        // CLOCK_MONOTONIC (same as the tick timerfd), a wall clock step must not freeze or fast-forward the animation
         platform::timestamp_ms_t last_frame_update_ms{0};
+        platform::timestamp_ms_t last_input_ms{0};
+        int fps{0};
+        int keys_down{0};                               // pressed minus released keys (from the key event ring)
+        unsigned int key_events_resets{0};              // key_event_ring_t::resets seen by keys_down
+        platform::time_ms_t next_deadline_ms{NO_DEADLINE_MS};   // of the last update, the replay clock advances by it
+        platform::timestamp_ms_t last_key_pressed_ms{0};    // replay clock only, live idle timeouts use the input thread's timestamp
+        bool replay_started{false};                     // replay clock: first key event seen, the timeline starts there
+        key_side_t key_side{key_side_t::Unknown};       // keyboard side of the last press, only set while running key transitions
         animation_state_row_t row_state{animation_state_row_t::Idle};
         bool boring_frame_showed{false};
         bool hold_frame_after_release{false};
     };
 
-    struct anim_next_frame_result_t {
-        bool changed{false};
-        int new_frame{0};
+    /// time of one state update: live input runs on CLOCK_MONOTONIC (frame timing) and the wall clock (key event timestamps),
+    /// a fast replay (--replay-fast) on the recorded key event timestamps for both, so its timeline doesn't depend on scheduling
+    struct anim_clock_t {
+        platform::timestamp_ms_t now_ms{0};             // frame counters, hold, governor
+        platform::timestamp_ms_t wall_ms{0};            // idle sleep timeout (key press timestamps)
+        bool replay{false};                             // key events are applied one at a time, see anim_replay_update_state
     };
 
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_bongocat_idle_next_frame(animation_context_t& ctx, const platform::input::input_context_t& input,
-                                                                  animation_state_t& state, bool any_key_pressed) {
-        using namespace assets;
+    static anim_clock_t anim_live_clock() {
+        return { .now_ms = platform::get_monotonic_time_us() / 1000, .wall_ms = platform::get_current_time_ms(), .replay = false };
+    }
 
-        // read-only config
-        assert(ctx._local_copy_config != nullptr);
-        const config::config_t& current_config = *ctx._local_copy_config;
+    static anim_clock_t anim_replay_clock(platform::timestamp_ms_t at_ms) {
+        return { .now_ms = at_ms, .wall_ms = at_ms, .replay = true };
+    }
 
+    static bool anim_uses_replay_clock(const platform::input::input_context_t& input) {
+        return input._source.type == platform::input::input_source_type_t::Replay && input._source.replay_fast;
+    }
+
+    static platform::timestamp_ms_t anim_last_key_pressed_ms(const platform::input::input_context_t& input, const animation_state_t& state, const anim_clock_t& clock) {
         assert(input.shm != nullptr);
-        assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-        const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        // @TODO: get variables as struct to make it more reusable
-        const bool hold_frame_after_release = !any_key_pressed && state.hold_frame_ms > current_config.keypress_duration_ms;
-        //const bool process_idle_animation = (current_config.idle_animation && current_config.animation_speed_ms > 0 && state.frame_delta_ms_counter > current_config.animation_speed_ms) || (current_config.idle_animation && current_config.animation_speed_ms <= 0 && state.frame_delta_ms_counter > 1000/current_config.fps);
-        const bool trigger_test_animation = current_config.test_animation_interval_sec > 0 && state.frame_delta_ms_counter > current_config.test_animation_interval_sec*1000;
-        const bool release_test_frame = current_config.test_animation_duration_ms > 0 && state.frame_delta_ms_counter > current_config.test_animation_duration_ms;
-        const bool check_for_idle_sleep = current_config.idle_sleep_timeout_sec > 0 && state.frame_delta_ms_counter > current_config.idle_sleep_timeout_sec*1000/2;
-
-        if (!hold_frame_after_release && !trigger_test_animation && !release_test_frame && !check_for_idle_sleep && !current_config.enable_scheduled_sleep) {
-            return { .changed = false, .new_frame = new_frame};
-        }
+        // the input thread runs ahead of a fast replay, live input also counts presses while suspended
+        return clock.replay ? state.last_key_pressed_ms : input.shm->last_key_pressed_timestamp;
+    }
 
-        // Test animation
-        if (!any_key_pressed && trigger_test_animation && current_row_state == animation_state_row_t::Idle) {
-            new_row = BONGOCAT_SPRITE_SHEET_ROWS-1;
-            new_start_frame_index = BONGOCAT_FRAME_LEFT_DOWN;
-            new_end_frame_index = BONGOCAT_FRAME_RIGHT_DOWN;
-            new_row_state = animation_state_row_t::Test;
-            // toggle frame
-            if (current_frame == BONGOCAT_FRAME_LEFT_DOWN) {
-                new_frame = BONGOCAT_FRAME_RIGHT_DOWN;
-            } else if (current_frame == BONGOCAT_FRAME_RIGHT_DOWN) {
-                new_frame = BONGOCAT_FRAME_LEFT_DOWN;
-            } else {
-                static_assert(BONGOCAT_FRAME_RIGHT_DOWN >= BONGOCAT_FRAME_LEFT_DOWN);
-                static_assert(BONGOCAT_FRAME_LEFT_DOWN >= 0);
-                static_assert(BONGOCAT_FRAME_RIGHT_DOWN >= 0);
-                new_frame = static_cast<int>(ctx.rng.range(BONGOCAT_FRAME_LEFT_DOWN, BONGOCAT_FRAME_RIGHT_DOWN));
-            }
-        }
-        // Idle Animation
-        if (hold_frame_after_release || (trigger_test_animation && current_row_state == animation_state_row_t::Test && release_test_frame)) {
-            // back to idle
-            new_start_frame_index = BONGOCAT_FRAME_BOTH_UP;
-            new_end_frame_index = BONGOCAT_FRAME_BOTH_UP;
-            new_frame = BONGOCAT_FRAME_BOTH_UP;
-            new_row = BONGOCAT_SPRITE_SHEET_ROWS-1;
-            new_row_state = animation_state_row_t::Idle;
-        }
+    // =============================================================================
+    // FRAME RATE GOVERNOR
+    // =============================================================================
 
-        // Sleep Mode
-        if (current_config.enable_scheduled_sleep) {
-            if (is_sleep_time(current_config)) {
-                new_frame = BONGOCAT_FRAME_BOTH_DOWN;
-                new_start_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_end_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_row_state = animation_state_row_t::Sleep;
-            }
+    // fps_sleep while sleeping, fps_active on input decaying to fps_idle
+    static int governor_fps(const config::config_t& config, const animation_state_t& state, platform::timestamp_ms_t now) {
+        if (state.row_state == animation_state_row_t::Sleep) {
+            return config.fps_sleep;
         }
-        // Idle Sleep
-        if (current_config.idle_sleep_timeout_sec > 0 && last_key_pressed_timestamp > 0) {
-            const platform::timestamp_ms_t now = platform::get_current_time_ms();
-            const platform::time_ms_t idle_sleep_timeout_ms = current_config.idle_sleep_timeout_sec*1000;
-            // boring
-            if (!state.boring_frame_showed && now - last_key_pressed_timestamp >= idle_sleep_timeout_ms/2) {
-                new_frame = BONGOCAT_FRAME_BOTH_DOWN;
-                new_start_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_end_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_row_state = animation_state_row_t::Boring;
-            }
-            // sleep
-            if (now - last_key_pressed_timestamp >= idle_sleep_timeout_ms) {
-                new_frame = BONGOCAT_FRAME_BOTH_DOWN;
-                new_start_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_end_frame_index = BONGOCAT_FRAME_BOTH_DOWN;
-                new_row_state = animation_state_row_t::Sleep;
-            }
+        if (state.last_input_ms <= 0 || now < state.last_input_ms) {
+            return config.fps_idle;
         }
 
-        const bool changed = animation_player_data.frame_index != new_frame || animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            ctx.shm->animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (new_row_state == animation_state_row_t::Boring) {
-                state.boring_frame_showed = true;
-            }
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
-            }
-            state.frame_delta_ms_counter = 0;
+        const platform::time_ms_t since_input_ms = now - state.last_input_ms;
+        const platform::time_ms_t halvings = since_input_ms / FPS_DECAY_HALF_LIFE_MS;
+        if (halvings >= FPS_DECAY_MAX_HALVINGS) {
+            return config.fps_idle;
         }
-
-        return { .changed = changed, .new_frame = new_frame};
+        // linear between two halvings, no libm needed
+        const platform::time_ms_t excess = config.fps_active - config.fps_idle;
+        const platform::time_ms_t high = excess / (1LL << halvings);
+        const platform::time_ms_t low = excess / (1LL << (halvings + 1));
+        const platform::time_ms_t rem_ms = since_input_ms % FPS_DECAY_HALF_LIFE_MS;
+        return config.fps_idle + static_cast<int>(high - (high - low) * rem_ms / FPS_DECAY_HALF_LIFE_MS);
     }
-#endif
-
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_digimon_idle_next_frame(animation_context_t& ctx, const platform::input::input_context_t& input,
-                                                                 animation_state_t& state, bool any_key_pressed) {
-        using namespace assets;
 
+    static void anim_update_frame_rate(animation_context_t& ctx, animation_state_t& state, platform::timestamp_ms_t now) {
         // read-only config
         assert(ctx._local_copy_config != nullptr);
         const config::config_t& current_config = *ctx._local_copy_config;
 
-        assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        const int anim_index = anim_shm.anim_index;
-        const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        const bool hold_frame_after_release = !any_key_pressed && state.hold_frame_ms > current_config.keypress_duration_ms;
-        const bool process_idle_animation = (current_config.idle_animation && current_config.animation_speed_ms > 0 && state.frame_delta_ms_counter > current_config.animation_speed_ms) || (current_config.idle_animation && current_config.animation_speed_ms <= 0 && state.frame_delta_ms_counter > 1000/current_config.fps);
-        const bool trigger_test_animation = current_config.test_animation_interval_sec > 0 && state.frame_delta_ms_counter > current_config.test_animation_interval_sec*1000;
-        const bool release_test_frame = current_config.test_animation_duration_ms > 0 && state.frame_delta_ms_counter > current_config.test_animation_duration_ms;
-        const bool check_for_idle_sleep = current_config.idle_sleep_timeout_sec > 0 && state.frame_delta_ms_counter > current_config.idle_sleep_timeout_sec*1000/2;
-
-        if (!hold_frame_after_release && !trigger_test_animation && !release_test_frame && !process_idle_animation && !check_for_idle_sleep && !current_config.enable_scheduled_sleep) {
-            return { .changed = false, .new_frame = new_frame};
+        int fps = governor_fps(current_config, state, now);
+        fps = fps > 0 ? fps : current_config.fps;
+        assert(fps > 0);
+        if (fps != state.fps) {
+            BONGOCAT_LOG_VERBOSE("Frame rate governor: %d fps", fps);
         }
+        state.fps = fps;
+        state.frame_time_ns = 1000000000LL / fps;
+        state.frame_time_ms = state.frame_time_ns / 1000000LL;
+        atomic_store(&ctx._governed_fps, fps);
+    }
 
-        /// @TODO: extract set animation state
-
-        const auto& current_frames = anim_shm.dm_anims[anim_index].digimon;
-        new_row = DIGIMON_SPRITE_SHEET_ROWS-1;
-        // Test Animation
-        if (!any_key_pressed && trigger_test_animation && current_row_state == animation_state_row_t::Idle) {
-            new_start_frame_index = DIGIMON_FRAME_IDLE1;
-            new_end_frame_index = DIGIMON_FRAME_IDLE2;
-            new_row_state = animation_state_row_t::Test;
-            // toggle frame
-            if (current_frame == DIGIMON_FRAME_IDLE2) {
-                new_frame = DIGIMON_FRAME_IDLE1;
-            } else if (current_frame == DIGIMON_FRAME_IDLE1) {
-                new_frame = DIGIMON_FRAME_IDLE2;
-            } else {
-                static_assert(DIGIMON_FRAME_IDLE2 >= DIGIMON_FRAME_IDLE1);
-                static_assert(DIGIMON_FRAME_IDLE1 >= 0);
-                static_assert(DIGIMON_FRAME_IDLE2 >= 0);
-                new_frame = static_cast<int>(ctx.rng.range(DIGIMON_FRAME_IDLE1, DIGIMON_FRAME_IDLE2)); // Frame 0 or 1 (active frames)
-            }
-        }
-        // Idle Animation
-        if (hold_frame_after_release || process_idle_animation || (trigger_test_animation && release_test_frame && current_row_state == animation_state_row_t::Test)) {
-            new_start_frame_index = DIGIMON_FRAME_IDLE1;
-            new_end_frame_index = DIGIMON_FRAME_IDLE2;
-            new_row_state = animation_state_row_t::Idle;
-            // toggle frame
-            if (current_frame == DIGIMON_FRAME_IDLE2) {
-                new_frame = DIGIMON_FRAME_IDLE1;
-            } else if (current_frame == DIGIMON_FRAME_IDLE1) {
-                new_frame = DIGIMON_FRAME_IDLE2;
-            } else {
-                static_assert(DIGIMON_FRAME_IDLE2 >= DIGIMON_FRAME_IDLE1);
-                static_assert(DIGIMON_FRAME_IDLE1 >= 0);
-                static_assert(DIGIMON_FRAME_IDLE2 >= 0);
-                new_frame = static_cast<int>(ctx.rng.range(DIGIMON_FRAME_IDLE1, DIGIMON_FRAME_IDLE2)); // Frame 0 or 1 (active frames)
-            }
+    // =============================================================================
+    // ANIMATION STATE MACHINE (tables in animation_state_machine.h)
+    // =============================================================================
+
+    static const animation_state_machine_t* get_state_machine(config::config_animation_type_t anim_type) {
+        switch (anim_type) {
+            case config::config_animation_type_t::None:
+                return nullptr;
+            case config::config_animation_type_t::Bongocat:
+#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
+                return &bongocat_state_machine::MACHINE;
+#else
+                return nullptr;
+#endif
+            case config::config_animation_type_t::Digimon:
+#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
+                return &digimon_state_machine::MACHINE;
+#else
+                return nullptr;
+#endif
+            case config::config_animation_type_t::MsPet:
+#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
+                return &ms_pet_state_machine::MACHINE;
+#else
+                return nullptr;
+#endif
         }
-        // Sleep animation
-        if (current_config.enable_scheduled_sleep && is_sleep_time(current_config)) {
-            // toggle sleep frame (if 2 frame exists for sleeping)
-            if (current_frame == DIGIMON_FRAME_SLEEP1) {
-                if (current_frames.sleep_2.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SLEEP2;
-                    new_end_frame_index = DIGIMON_FRAME_SLEEP2;
-                    new_frame = DIGIMON_FRAME_SLEEP2;
-                    new_row_state = animation_state_row_t::Sleep;
-                } else if (current_frames.sleep1.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_end_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_frame = DIGIMON_FRAME_SLEEP1;
-                    new_row_state = animation_state_row_t::Sleep;
-                } else if (current_frames.down1.valid) {
-                    BONGOCAT_LOG_VERBOSE("No Sleeping Frame for %d", anim_index);
-                    // fallback frame
-                    new_start_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_end_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_frame = DIGIMON_FRAME_DOWN1;
-                    new_row_state = animation_state_row_t::Sleep;
-                }
-            } else if (current_frame == DIGIMON_FRAME_SLEEP2) {
-                if (current_frames.sleep1.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_end_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_frame = DIGIMON_FRAME_SLEEP1;
-                    new_row_state = animation_state_row_t::Sleep;
-                } else if (current_frames.down1.valid) {
-                    BONGOCAT_LOG_VERBOSE("No Sleeping Frame for %d", anim_index);
-                    // fallback frame
-                    new_start_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_end_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_frame = DIGIMON_FRAME_DOWN1;
-                    new_row_state = animation_state_row_t::Sleep;
-                }
-            } else {
-                // start sleeping
-                if (current_frames.sleep1.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_end_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_frame = DIGIMON_FRAME_SLEEP1;
-                    new_row_state = animation_state_row_t::Sleep;
-                } else if (current_frames.down1.valid) {
-                    BONGOCAT_LOG_VERBOSE("No Sleeping Frame for %d", anim_index);
-                    // fallback frame
-                    new_start_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_end_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_frame = DIGIMON_FRAME_DOWN1;
-                    new_row_state = animation_state_row_t::Sleep;
-                }
+        return nullptr;
+    }
+
+    // bit per frame region that exists in the current sprite sheet, ms pet sheets are always complete
+    static uint32_t get_valid_frames(const animation_shared_memory_t& anim_shm) {
+        static_assert(MAX_NUM_FRAMES <= 32);
+        [[maybe_unused]] const auto valid_frames_of = [](const generic_sprite_sheet_animation_t& sheet) {
+            uint32_t ret = 0;
+            for (size_t i = 0; i < MAX_NUM_FRAMES; i++) {
+                ret |= sheet.frames[i].valid ? (1u << i) : 0u;
             }
+            return ret;
+        };
+        switch (anim_shm.anim_type) {
+            case config::config_animation_type_t::None:
+                return 0;
+            case config::config_animation_type_t::Bongocat:
+#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
+                return valid_frames_of(anim_shm.bongocat_anims[anim_shm.anim_index].sprite_sheet);
+#else
+                return 0;
+#endif
+            case config::config_animation_type_t::Digimon:
+#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
+                return valid_frames_of(anim_shm.dm_anims[anim_shm.anim_index].sprite_sheet);
+#else
+                return 0;
+#endif
+            case config::config_animation_type_t::MsPet:
+                return UINT32_MAX;
         }
-        // Idle Sleep
-        if (current_config.idle_sleep_timeout_sec > 0 && last_key_pressed_timestamp > 0) {
-            const platform::timestamp_ms_t now = platform::get_current_time_ms();
-            const platform::time_ms_t idle_sleep_timeout_ms = current_config.idle_sleep_timeout_sec*1000;
-            // boring
-            if (!state.boring_frame_showed && now - last_key_pressed_timestamp >= idle_sleep_timeout_ms/2) {
-                if (current_frames.sad.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SAD;
-                    new_end_frame_index = DIGIMON_FRAME_SAD;
-                    new_frame = DIGIMON_FRAME_SAD;
-                    new_row_state = animation_state_row_t::Boring;
-                } else if (current_frames.down1.valid) {
-                    BONGOCAT_LOG_VERBOSE("No Boring Frame for %d", anim_index);
-                    // fallback frame
-                    new_start_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_end_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_frame = DIGIMON_FRAME_DOWN1;
-                    new_row_state = animation_state_row_t::Boring;
+        return 0;
+    }
+
+    static bool is_valid_frame(uint32_t valid_frames, int frame) {
+        return frame >= 0 && frame < 32 && (valid_frames & (1u << frame)) != 0;
+    }
+
+    static int clip_toggle_frame(animation_context_t& ctx, const animation_clip_t& clip, int current_frame, uint32_t valid_frames, key_side_t key_side) {
+        const bool first_valid = is_valid_frame(valid_frames, clip.first_frame);
+        const bool last_valid = is_valid_frame(valid_frames, clip.last_frame);
+        if (first_valid && last_valid) {
+            // first frame is the left paw, last frame the right paw
+            if (key_side != key_side_t::Unknown) {
+                if (const int side_frame = key_side == key_side_t::Left ? clip.first_frame : clip.last_frame; side_frame != current_frame) {
+                    return side_frame;
                 }
             }
-            // sleep
-            if (now - last_key_pressed_timestamp >= idle_sleep_timeout_ms) {
-                // start sleeping
-                if (current_frames.sleep1.valid) {
-                    new_start_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_end_frame_index = DIGIMON_FRAME_SLEEP1;
-                    new_frame = DIGIMON_FRAME_SLEEP1;
-                    new_row_state = animation_state_row_t::Sleep;
-                } else if (current_frames.down1.valid) {
-                    BONGOCAT_LOG_VERBOSE("No Sleeping Frame for %d", anim_index);
-                    // fallback frame
-                    new_start_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_end_frame_index = DIGIMON_FRAME_DOWN1;
-                    new_frame = DIGIMON_FRAME_DOWN1;
-                    new_row_state = animation_state_row_t::Sleep;
-                }
+            if (current_frame == clip.first_frame) {
+                return clip.last_frame;
             }
-        }
-
-        const bool changed = animation_player_data.frame_index != new_frame || animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (new_row_state == animation_state_row_t::Boring) {
-                state.boring_frame_showed = true;
-            } else if (state.boring_frame_showed && new_row_state == animation_state_row_t::Writing) {
-                // reset boring frame state
-                state.boring_frame_showed = false;
+            if (current_frame == clip.last_frame) {
+                return clip.first_frame;
             }
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+            if (clip.playback == animation_playback_t::ToggleFirst) {
+                return clip.first_frame;
             }
-            state.frame_delta_ms_counter = 0;
+            return ctx.rng.range(0, 1) == 0 ? clip.first_frame : clip.last_frame;
         }
-
-        return { .changed = changed, .new_frame = new_frame};
+        if (first_valid) {
+            return clip.first_frame;
+        }
+        if (last_valid) {
+            return clip.last_frame;
+        }
+        return is_valid_frame(valid_frames, clip.fallback_frame) ? clip.fallback_frame : -1;
     }
-#endif
 
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_ms_pet_idle_next_frame(animation_context_t& ctx, const platform::input::input_context_t& input,
-                                                                animation_state_t& state, bool any_key_pressed) {
-        using namespace assets;
-
-        // read-only config
+    /// frame when entering the state of clip, -1 when the sprite sheet has no frame for it
+    static int clip_enter_frame(animation_context_t& ctx, const animation_clip_t& clip, animation_state_row_t to, int current_frame, uint32_t valid_frames, key_side_t key_side) {
         assert(ctx._local_copy_config != nullptr);
         const config::config_t& current_config = *ctx._local_copy_config;
 
-        assert(input.shm != nullptr);
-        assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-        const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        const bool go_next_frame = (current_config.animation_speed_ms > 0 && state.frame_delta_ms_counter > current_config.animation_speed_ms) || (current_config.animation_speed_ms <= 0 && state.frame_delta_ms_counter > 1000/current_config.fps);
-        const bool hold_frame_after_release = !any_key_pressed && state.hold_frame_ms > current_config.keypress_duration_ms;
-        const bool process_idle_animation = (current_config.idle_animation && current_config.animation_speed_ms > 0 && state.frame_delta_ms_counter > current_config.animation_speed_ms) || (current_config.idle_animation && current_config.animation_speed_ms <= 0 && state.frame_delta_ms_counter > 1000/current_config.fps);
-        //const bool trigger_test_animation = current_config.test_animation_interval_sec > 0 && state.frame_delta_ms_counter > current_config.test_animation_interval_sec*1000;
-        //const bool release_test_frame = current_config.test_animation_duration_ms > 0 && state.frame_delta_ms_counter > current_config.test_animation_duration_ms;
-        const bool check_for_idle_sleep = current_config.idle_sleep_timeout_sec > 0 && state.frame_delta_ms_counter > current_config.idle_sleep_timeout_sec*1000/2;
-
-        // only show next frame by animation speed or when any key was pressed (writing animation)
-        if (state.frame_delta_ms_counter <= current_config.animation_speed_ms && !any_key_pressed && !check_for_idle_sleep && !current_config.enable_scheduled_sleep) {
-            return { .changed = false, .new_frame = new_frame};
-        }
-
-        /// @TODO: extract state change and player_data update
-
-        switch (current_row_state) {
-            case animation_state_row_t::Test:
-            case animation_state_row_t::Happy:
-                // not supported, same as idle
-            case animation_state_row_t::Idle: {
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_IDLE-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_IDLE;
-                new_row_state = animation_state_row_t::Idle;
-                if (current_config.idle_animation && process_idle_animation) {
-                    // loop idle animation
-                    const int range = animation_player_data.end_frame_index - animation_player_data.start_frame_index + 1;
-                    new_frame = (range != 0) ? animation_player_data.start_frame_index +
-                        ((current_frame - animation_player_data.start_frame_index + 1) % range) : current_frame;
-                } else if (!current_config.idle_animation) {
-                    new_frame = current_config.idle_animation;
-                }
-                // is not sleeping, yet
-                if (current_row_state != animation_state_row_t::Sleep) {
-                    // Sleep Mode
-                    if (current_config.enable_scheduled_sleep) {
-                        if (is_sleep_time(current_config)) {
-                            // start sleeping
-                            new_frame = 0;
-                            new_start_frame_index = 0;
-                            new_end_frame_index = CLIPPY_FRAMES_SLEEP-1;
-                            new_row = CLIPPY_SPRITE_SHEET_ROW_SLEEP;
-                            new_row_state = animation_state_row_t::Sleep;
-                        }
-                    }
-                    // Idle Sleep
-                    if (current_config.idle_sleep_timeout_sec > 0 && last_key_pressed_timestamp > 0) {
-                        const platform::timestamp_ms_t now = platform::get_current_time_ms();
-                        const platform::time_ms_t idle_sleep_timeout_ms = current_config.idle_sleep_timeout_sec*1000;
-                        // boring
-                        if (!state.boring_frame_showed && now - last_key_pressed_timestamp >= idle_sleep_timeout_ms/2) {
-                            // start boring animation
-                            new_frame = 0;
-                            new_start_frame_index = 0;
-                            new_end_frame_index = CLIPPY_FRAMES_BORING-1;
-                            new_row = CLIPPY_SPRITE_SHEET_ROW_BORING;
-                            new_row_state = animation_state_row_t::Boring;
-                        }
-                        // sleeping
-                        if (now - last_key_pressed_timestamp >= idle_sleep_timeout_ms) {
-                            // start sleeping
-                            new_frame = 0;
-                            new_start_frame_index = 0;
-                            new_end_frame_index = CLIPPY_FRAMES_SLEEP-1;
-                            new_row = CLIPPY_SPRITE_SHEET_ROW_SLEEP;
-                            new_row_state = animation_state_row_t::Sleep;
-                        }
-                    }
-                }
-            }break;
-            case animation_state_row_t::Writing: {
-                // keep writing
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_WRITING-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_WRITING;
-                new_row_state = animation_state_row_t::Writing;
-                // loop idle animation
-                if (any_key_pressed || go_next_frame) {
-                    const int range = animation_player_data.end_frame_index - animation_player_data.start_frame_index + 1;
-                    new_frame = (range != 0) ? animation_player_data.start_frame_index +
-                        ((current_frame - animation_player_data.start_frame_index + 1) % range) : current_frame;
-                }
-                // still in writing process ?
-                if (state.hold_frame_after_release && any_key_pressed) {
-                    state.hold_frame_after_release = false;
-                    state.hold_frame_ms = 0;
-                }
-                // cancel writing
-                if (hold_frame_after_release) {
-                    // start, end writing animation
-                    new_frame = 0;
-                    new_start_frame_index = 0;
-                    new_end_frame_index = CLIPPY_FRAMES_END_WRITING-1;
-                    new_row = CLIPPY_SPRITE_SHEET_ROW_END_WRITING;
-                    new_row_state = animation_state_row_t::EndWriting;
-                }
-            }break;
-            case animation_state_row_t::StartWriting:
-                // end current animation
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_START_WRITING-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_START_WRITING;
-                new_row_state = animation_state_row_t::StartWriting;
-                if (go_next_frame) {
-                    new_frame = current_frame + 1;
-                }
-                if (new_frame > new_end_frame_index) {
-                    // start writing animation
-                    new_frame = 0;
-                    new_start_frame_index = 0;
-                    new_end_frame_index = CLIPPY_FRAMES_WRITING-1;
-                    new_row = CLIPPY_SPRITE_SHEET_ROW_WRITING;
-                    new_row_state = animation_state_row_t::Writing;
-                    // reset release counter after writing is started (for real)
-                    state.hold_frame_after_release = true;
-                    state.hold_frame_ms = 0;
-                }
-                break;
-            case animation_state_row_t::EndWriting:
-                // end current animation
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_END_WRITING-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_END_WRITING;
-                new_row_state = animation_state_row_t::EndWriting;
-                if (go_next_frame) {
-                    new_frame = current_frame + 1;
-                }
-                if (new_frame > new_end_frame_index) {
-                    // back to idle
-                    if (current_config.idle_animation) {
-                        new_frame = 0;
-                    } else {
-                        new_frame = current_config.idle_frame;
-                    }
-                    new_start_frame_index = 0;
-                    new_end_frame_index = CLIPPY_FRAMES_IDLE-1;
-                    new_row = CLIPPY_SPRITE_SHEET_ROW_IDLE;
-                    new_row_state = animation_state_row_t::Idle;
-                }
-                break;
-            case animation_state_row_t::Sleep:
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_SLEEP-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_SLEEP;
-                new_row_state = animation_state_row_t::Sleep;
-                // continue (start) sleeping, stop at last frame
-                if (go_next_frame) {
-                    if (new_frame < new_end_frame_index) {
-                        new_frame = current_frame + 1;
-                    } else {
-                        new_frame = new_end_frame_index;
-                    }
-                }
-                break;
-            case animation_state_row_t::WakeUp:
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_WAKE_UP-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_WAKE_UP;
-                new_row_state = animation_state_row_t::WakeUp;
-                if (go_next_frame) {
-                    new_frame = current_frame + 1;
-                }
-                if (new_frame > new_end_frame_index) {
-                    // back to idle
-                    if (current_config.idle_animation) {
-                        new_frame = 0;
-                    } else {
-                        new_frame = current_config.idle_frame;
-                    }
-                    new_start_frame_index = 0;
-                    new_end_frame_index = CLIPPY_FRAMES_IDLE-1;
-                    new_row = CLIPPY_SPRITE_SHEET_ROW_IDLE;
-                    new_row_state = animation_state_row_t::Idle;
-                }
-                break;
-            case animation_state_row_t::Boring:
-                // end current animation
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_BORING-1;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_BORING;
-                new_row_state = animation_state_row_t::Boring;
-                if (go_next_frame) {
-                    new_frame = current_frame + 1;
+        switch (clip.playback) {
+            case animation_playback_t::Still:
+                if (is_valid_frame(valid_frames, clip.first_frame)) {
+                    return clip.first_frame;
                 }
-                if (new_frame > new_end_frame_index) {
-                    // back to idle
-                    if (current_config.idle_animation) {
-                        new_frame = 0;
-                    } else {
-                        new_frame = current_config.idle_frame;
-                    }
-                    new_start_frame_index = 0;
-                    new_end_frame_index = CLIPPY_FRAMES_IDLE-1;
-                    new_row = CLIPPY_SPRITE_SHEET_ROW_IDLE;
-                    new_row_state = animation_state_row_t::Idle;
+                return is_valid_frame(valid_frames, clip.fallback_frame) ? clip.fallback_frame : -1;
+            case animation_playback_t::Toggle:
+            case animation_playback_t::ToggleFirst:
+                return clip_toggle_frame(ctx, clip, current_frame, valid_frames, key_side);
+            case animation_playback_t::Loop:
+                // idle loop stands still on idle_frame without idle animation
+                if (to == animation_state_row_t::Idle && !current_config.idle_animation &&
+                    current_config.idle_frame >= clip.first_frame && current_config.idle_frame <= clip.last_frame) {
+                    return current_config.idle_frame;
                 }
-                break;
+                return clip.first_frame;
+            case animation_playback_t::PlayOnce:
+            case animation_playback_t::Hold:
+                return clip.first_frame;
         }
+        return -1;
+    }
 
-
-        const bool changed = animation_player_data.frame_index != new_frame || animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (new_row_state == animation_state_row_t::Boring) {
-                state.boring_frame_showed = true;
-            } else if (state.boring_frame_showed && (new_row_state == animation_state_row_t::StartWriting || new_row_state == animation_state_row_t::Writing || new_row_state == animation_state_row_t::EndWriting)) {
-                // reset boring frame state
-                state.boring_frame_showed = false;
-            }
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+    /// next frame while staying in the state of clip
+    static int clip_next_frame(animation_context_t& ctx, const animation_clip_t& clip, animation_state_row_t state, int current_frame, uint32_t valid_frames, key_side_t key_side) {
+        const bool in_clip = current_frame >= clip.first_frame && current_frame <= clip.last_frame;
+        switch (clip.playback) {
+            case animation_playback_t::Still:
+                return clip_enter_frame(ctx, clip, state, current_frame, valid_frames, key_side);
+            case animation_playback_t::Toggle:
+            case animation_playback_t::ToggleFirst:
+                return clip_toggle_frame(ctx, clip, current_frame, valid_frames, key_side);
+            case animation_playback_t::Loop: {
+                const int range = clip.last_frame - clip.first_frame + 1;
+                return in_clip && range > 0 ? clip.first_frame + ((current_frame - clip.first_frame + 1) % range) : clip.first_frame;
             }
-            state.frame_delta_ms_counter = 0;
+            case animation_playback_t::PlayOnce:
+            case animation_playback_t::Hold:
+                if (!in_clip) {
+                    return clip.first_frame;
+                }
+                return current_frame < clip.last_frame ? current_frame + 1 : clip.last_frame;
         }
-
-        return { .changed = changed, .new_frame = new_frame };
+        return current_frame;
     }
-#endif
 
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_bongocat_key_pressed_next_frame(animation_context_t& ctx,
-                                                                         animation_state_t& state) {
-        using namespace assets;
-
-        // read-only config
+    /// kpm: of the key event (key_event_t::kpm), the input thread can be ahead of the animation
+    static animation_events_t anim_collect_key_events(animation_context_t& ctx, const animation_state_machine_t& machine, int kpm) {
         assert(ctx._local_copy_config != nullptr);
         const config::config_t& current_config = *ctx._local_copy_config;
 
-        assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        //const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-        //const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        /// @TODO: use state machine for animation (states)
-
-        // toggle frame
-        if (current_frame == BONGOCAT_FRAME_LEFT_DOWN) {
-            new_frame = BONGOCAT_FRAME_RIGHT_DOWN;
-        } else if (current_frame == BONGOCAT_FRAME_RIGHT_DOWN) {
-            new_frame = BONGOCAT_FRAME_LEFT_DOWN;
-        } else {
-            static_assert(BONGOCAT_FRAME_RIGHT_DOWN >= BONGOCAT_FRAME_LEFT_DOWN);
-            static_assert(BONGOCAT_FRAME_LEFT_DOWN >= 0);
-            static_assert(BONGOCAT_FRAME_RIGHT_DOWN >= 0);
-            new_frame = static_cast<int>(ctx.rng.range(BONGOCAT_FRAME_LEFT_DOWN, BONGOCAT_FRAME_RIGHT_DOWN));
-        }
-        // in Writing mode/start writing
-        new_row = BONGOCAT_SPRITE_SHEET_ROWS-1;
-        new_start_frame_index = BONGOCAT_FRAME_LEFT_DOWN;
-        new_end_frame_index = BONGOCAT_FRAME_RIGHT_DOWN;
-        new_row_state = animation_state_row_t::Writing;
-
-        const bool changed = anim_shm.animation_player_data.frame_index != new_frame || anim_shm.animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            anim_shm.animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+        animation_events_t events = animation_events(animation_event_t::KeyDown);
+        if (machine.happy_chance_percent > 0 && current_config.happy_kpm > 0 && kpm > 0 && kpm >= current_config.happy_kpm) {
+            if (machine.happy_chance_percent >= 100 || static_cast<int>(ctx.rng.range(0, 99)) < machine.happy_chance_percent) {
+                BONGOCAT_LOG_VERBOSE("Happy at %d KPM", kpm);
+                events |= animation_events(animation_event_t::HappyKpm);
             }
-            state.frame_delta_ms_counter = 0;
         }
-
-        return { .changed = changed, .new_frame = new_frame};
+        return events;
     }
-#endif
-
-
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_digimon_key_pressed_next_frame(animation_context_t& ctx, const platform::input::input_context_t& input,
-                                                                        animation_state_t& state) {
-        using namespace assets;
 
-        // read-only config
+    static animation_events_t anim_collect_idle_events(const animation_context_t& ctx, const platform::input::input_context_t& input, const animation_state_t& state,
+                                                       const animation_state_machine_t& machine, bool any_key_pressed, const anim_clock_t& clock) {
         assert(ctx._local_copy_config != nullptr);
-        const config::config_t& current_config = *ctx._local_copy_config;
-
         assert(input.shm != nullptr);
         assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-        //const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-        const auto& current_frames = anim_shm.dm_anims[anim_shm.anim_index].digimon;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        /// @TODO: use state machine for animation (states)
-
-        // in Writing mode/start writing
-        new_row = DIGIMON_SPRITE_SHEET_ROWS-1;
-        new_start_frame_index = DIGIMON_FRAME_IDLE1;
-        new_end_frame_index = DIGIMON_FRAME_IDLE2;
-        new_row_state = animation_state_row_t::Writing;
-        // toggle frame
-        if (current_frame == DIGIMON_FRAME_IDLE1) {
-            new_frame = DIGIMON_FRAME_IDLE2;
-
-            if (input_shm.kpm > 0) {
-                if (current_config.happy_kpm > 0 && input_shm.kpm >= current_config.happy_kpm) {
-                    if (current_frames.happy.valid) {
-                        if (HAPPY_CHANCE_PERCENT >= 100 || ctx.rng.range(0, 99) < HAPPY_CHANCE_PERCENT) {
-                            BONGOCAT_LOG_VERBOSE("Show Happy Frame at %d KPM", input_shm.kpm);
-                            new_start_frame_index = DIGIMON_FRAME_HAPPY;
-                            new_end_frame_index = DIGIMON_FRAME_HAPPY;
-                            new_frame = DIGIMON_FRAME_HAPPY;
-                            new_row_state = animation_state_row_t::Happy;
-                        }
-                    }
-                }
+        const config::config_t& current_config = *ctx._local_copy_config;
+        const auto& animation_player_data = ctx.shm->animation_player_data;
+
+        const platform::time_ms_t frame_interval_ms = current_config.animation_speed_ms > 0 ? current_config.animation_speed_ms : 1000 / current_config.fps;
+        const platform::time_ms_t counter_ms = state.frame_delta_ms_counter;
+
+        animation_events_t events = 0;
+        if (!any_key_pressed && state.keys_down <= 0 && state.hold_frame_ms > current_config.keypress_duration_ms) {
+            events |= animation_events(animation_event_t::HoldExpired);
+        }
+        if (counter_ms > frame_interval_ms) {
+            events |= animation_events(animation_event_t::FrameTick);
+            if (current_config.idle_animation) {
+                events |= animation_events(animation_event_t::IdleTick);
+            }
+            const animation_clip_t& clip = machine.clips[clip_index(state.row_state)];
+            if (clip.playback == animation_playback_t::PlayOnce && animation_player_data.frame_index >= clip.last_frame) {
+                events |= animation_events(animation_event_t::ClipEnd);
             }
-        } else if (current_frame == DIGIMON_FRAME_IDLE2) {
-            new_frame = DIGIMON_FRAME_IDLE1;
-        } else {
-            static_assert(DIGIMON_FRAME_IDLE2 >= DIGIMON_FRAME_IDLE1);
-            static_assert(DIGIMON_FRAME_IDLE1 >= 0);
-            static_assert(DIGIMON_FRAME_IDLE2 >= 0);
-            new_frame = static_cast<int>(ctx.rng.range(DIGIMON_FRAME_IDLE1, DIGIMON_FRAME_IDLE2)); // Frame 0 or 1 (active frames)
         }
-
-        const bool changed = anim_shm.animation_player_data.frame_index != new_frame || anim_shm.animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            anim_shm.animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+        if (current_config.test_animation_interval_sec > 0 && counter_ms > current_config.test_animation_interval_sec*1000) {
+            if (!any_key_pressed) {
+                events |= animation_events(animation_event_t::TestStart);
+            }
+            if (current_config.test_animation_duration_ms > 0 && counter_ms > current_config.test_animation_duration_ms) {
+                events |= animation_events(animation_event_t::TestEnd);
             }
-            state.frame_delta_ms_counter = 0;
         }
-
-        return { .changed = changed, .new_frame = new_frame};
+        const platform::timestamp_ms_t last_key_pressed_ms = anim_last_key_pressed_ms(input, state, clock);
+        if (current_config.idle_sleep_timeout_sec > 0 && last_key_pressed_ms > 0) {
+            const platform::time_ms_t idle_sleep_timeout_ms = current_config.idle_sleep_timeout_sec*1000;
+            const platform::time_ms_t since_key_pressed_ms = clock.wall_ms - last_key_pressed_ms;
+            if (!state.boring_frame_showed && since_key_pressed_ms >= idle_sleep_timeout_ms/2) {
+                events |= animation_events(animation_event_t::BoringTimeout);
+            }
+            if (since_key_pressed_ms >= idle_sleep_timeout_ms) {
+                events |= animation_events(animation_event_t::SleepTime);
+            }
+        }
+        if (current_config.enable_scheduled_sleep && is_sleep_time(current_config)) {
+            events |= animation_events(animation_event_t::SleepTime);
+        }
+        return events;
     }
-#endif
 
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-    static anim_next_frame_result_t anim_ms_pet_key_pressed_next_frame(animation_context_t& ctx,
-                                                                       animation_state_t& state) {
-        using namespace assets;
+    /// run the first matching transition (table order = priority)
+    static bool anim_run_transitions(animation_context_t& ctx, animation_state_t& state, const animation_state_machine_t& machine,
+                                     const animation_transition_t *transitions, size_t transitions_count, animation_events_t events) {
+        if (events == 0) {
+            return false;
+        }
 
         // read-only config
         assert(ctx._local_copy_config != nullptr);
         const config::config_t& current_config = *ctx._local_copy_config;
 
         assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        //const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
+        auto& animation_player_data = ctx.shm->animation_player_data;
         const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-        //const platform::timestamp_ms_t last_key_pressed_timestamp = input_shm.last_key_pressed_timestamp;
-
-        animation_state_row_t new_row_state = state.row_state;
-        int new_row = animation_player_data.sprite_sheet_row;
-        int new_start_frame_index = animation_player_data.start_frame_index;
-        int new_end_frame_index = animation_player_data.end_frame_index;
-        int new_frame = current_frame;
-
-        /// @TODO: use state machine for animation (states)
-
-        // in Writing mode/start writing
-        switch (current_row_state) {
-            case animation_state_row_t::Test:
-            case animation_state_row_t::Happy:
-            case animation_state_row_t::Idle:
-                // START Writing
-                new_frame = 0;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_START_WRITING;
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_START_WRITING-1;
-                new_row_state = animation_state_row_t::StartWriting;
-                break;
-            case animation_state_row_t::StartWriting:
-                // process animation in anim_ms_pet_idle_next_frame
-                break;
-            case animation_state_row_t::Writing:
-                // process animation in anim_ms_pet_idle_next_frame
-                break;
-            case animation_state_row_t::EndWriting:
-                // start end writing and process animation in anim_ms_pet_idle_next_frame
-                break;
-            case animation_state_row_t::Sleep:
-                // wake up when sleeping
-                new_frame = 0;
-                new_row = CLIPPY_SPRITE_SHEET_ROW_WAKE_UP;
-                new_start_frame_index = 0;
-                new_end_frame_index = CLIPPY_FRAMES_WAKE_UP-1;
-                new_row_state = animation_state_row_t::WakeUp;
-            case animation_state_row_t::WakeUp:
-                // process animation in anim_ms_pet_idle_next_frame
-                break;
-            case animation_state_row_t::Boring:
-                // process animation in anim_ms_pet_idle_next_frame
-                break;
-        }
+        const uint32_t valid_frames = get_valid_frames(*ctx.shm);
 
-        const bool changed = anim_shm.animation_player_data.frame_index != new_frame || anim_shm.animation_player_data.sprite_sheet_row != new_row || current_row_state != new_row_state;
-        if (changed) {
-            anim_shm.animation_player_data.frame_index = new_frame;
-            animation_player_data.sprite_sheet_row = new_row;
-            animation_player_data.start_frame_index = new_start_frame_index;
-            animation_player_data.end_frame_index = new_end_frame_index;
-            state.row_state = new_row_state;
-            if (current_config.enable_debug) {
-                BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+        for (size_t i = 0; i < transitions_count; i++) {
+            const animation_transition_t& t = transitions[i];
+            if ((!t.from_any && t.from != state.row_state) || !has_animation_events(events, t.events)) {
+                continue;
             }
-            state.frame_delta_ms_counter = 0;
-        }
 
-        return { .changed = changed, .new_frame = new_frame };
-    }
-#endif
+            const animation_clip_t& clip = machine.clips[clip_index(t.to)];
+            int new_frame = current_frame;
+            if (t.to == state.row_state) {
+                if (t.action == animation_transition_action_t::Enter) {
+                    // stay in state, lower priority transitions don't apply
+                    return false;
+                }
+                new_frame = clip_next_frame(ctx, clip, t.to, current_frame, valid_frames, state.key_side);
+            } else {
+                new_frame = clip_enter_frame(ctx, clip, t.to, current_frame, valid_frames, state.key_side);
+            }
+            if (new_frame < 0) {
+                // no frame for this state in the sprite sheet, try the next transition
+                continue;
+            }
 
-    static bool anim_handle_idle_animation(animation_context_t& ctx, const platform::input::input_context_t& input, animation_state_t& state, bool any_key_pressed) {
-        using namespace assets;
+            const auto flags = static_cast<uint8_t>(t.flags);
+            if (flags & static_cast<uint8_t>(animation_transition_flags_t::StartHoldAfterRelease)) {
+                state.hold_frame_after_release = true;
+                state.hold_frame_ms = 0;
+            }
+            if (flags & static_cast<uint8_t>(animation_transition_flags_t::ResetHold)) {
+                state.hold_frame_after_release = false;
+                state.hold_frame_ms = 0;
+            }
 
-        // read-only config
-        assert(ctx._local_copy_config != nullptr);
-        const config::config_t& current_config = *ctx._local_copy_config;
+            const bool changed = animation_player_data.frame_index != new_frame || animation_player_data.sprite_sheet_row != clip.row || state.row_state != t.to;
+            if (changed) {
+                animation_player_data.frame_index = new_frame;
+                animation_player_data.sprite_sheet_row = clip.row;
+                animation_player_data.start_frame_index = clip.first_frame;
+                animation_player_data.end_frame_index = clip.last_frame;
+                if (t.to == animation_state_row_t::Boring) {
+                    state.boring_frame_showed = true;
+                } else if (t.to == animation_state_row_t::StartWriting || t.to == animation_state_row_t::Writing || t.to == animation_state_row_t::EndWriting) {
+                    // reset boring frame state
+                    state.boring_frame_showed = false;
+                }
+                state.row_state = t.to;
+                if (current_config.enable_debug) {
+                    BONGOCAT_LOG_VERBOSE("Animation frame change: %d", new_frame);
+                }
+                state.frame_delta_ms_counter = 0;
+            }
+            return changed;
+        }
+        return false;
+    }
 
-        assert(input.shm != nullptr);
+    static bool anim_handle_idle_animation(animation_context_t& ctx, const platform::input::input_context_t& input, animation_state_t& state, bool any_key_pressed,
+                                           const anim_clock_t& clock) {
         assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        //const auto& input_shm = *input.shm;
-        //auto& animation_player_data = anim_shm.animation_player_data;
-        //const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        //const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
-
-        if (current_config.animation_speed_ms <= 0 && current_config.test_animation_interval_sec <= 0 && !current_config.idle_animation && !current_config.enable_scheduled_sleep) {
+        const animation_state_machine_t *machine = get_state_machine(ctx.shm->anim_type);
+        if (machine == nullptr) {
             return false;
         }
 
-        bool ret = false;
-        switch (anim_shm.anim_type) {
-            case config::config_animation_type_t::None:
-                break;
-            case config::config_animation_type_t::Bongocat: {
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_bongocat_idle_next_frame(ctx, input, state, any_key_pressed);
-                ret = changed;
-#endif
-            }break;
-            case config::config_animation_type_t::Digimon: {
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_digimon_idle_next_frame(ctx, input, state, any_key_pressed);
-                ret = changed;
-#endif
-            }break;
-            case config::config_animation_type_t::MsPet: {
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_ms_pet_idle_next_frame(ctx, input, state, any_key_pressed);
-                ret = changed;
-#endif
-            }break;
+        const animation_events_t events = anim_collect_idle_events(ctx, input, state, *machine, any_key_pressed, clock);
+        return anim_run_transitions(ctx, state, *machine, machine->idle_transitions, machine->idle_transitions_count, events);
+    }
+
+    /// trigger_efd only signals the empty -> non-empty transition of the key event ring, reset it
+    static void anim_reset_trigger(animation_session_t& animation_trigger_ctx) {
+        BONGOCAT_LOG_VERBOSE("Receive animation trigger event");
+        uint64_t u;
+        if (read(animation_trigger_ctx.trigger_efd._fd, &u, sizeof(uint64_t)) != sizeof(uint64_t) && errno != EAGAIN) {
+            BONGOCAT_LOG_ERROR("Error reading animation trigger eventfd: %s", strerror(errno));
+        }
+    }
+
+    /// held keys and, for a press, the key transitions: random choices are made once per press, not per drained batch
+    static bool anim_apply_key_event(animation_context_t& ctx, animation_state_t& state, const animation_state_machine_t *machine,
+                                     const platform::input::key_event_t& key_event, const anim_clock_t& clock) {
+        // event timestamps are wall clock (evdev), the governor runs on the animation clock
+        state.last_input_ms = clock.now_ms;
+        if (key_event.type != platform::input::key_event_type_t::Press) {
+            if (state.keys_down > 0) {
+                state.keys_down--;
+            }
+            return false;
+        }
+        BONGOCAT_LOG_VERBOSE("Key press: code=%d, device=%d", key_event.code, key_event.device_index);
+        state.keys_down++;
+        state.last_key_pressed_ms = clock.wall_ms;
+        if (machine == nullptr) {
+            return false;
         }
-        return ret;
+
+        const animation_events_t events = anim_collect_key_events(ctx, *machine, key_event.kpm);
+        state.key_side = key_code_side(key_event.code);
+        const bool changed = anim_run_transitions(ctx, state, *machine, machine->key_transitions, machine->key_transitions_count, events);
+        state.key_side = key_side_t::Unknown;
+        return changed;
     }
 
     struct anim_handle_key_press_result_t {
         bool any_key_pressed{false};
         bool changed{false};
+        platform::timestamp_us_t input_timestamp_us{0};     // evdev time of the first press of this batch
     };
-    static anim_handle_key_press_result_t anim_handle_key_press(animation_session_t& animation_trigger_ctx, animation_state_t& state) {
-        using namespace assets;
-
+    /// live: drain the key event ring; replay clock: only replay_event (popped by anim_replay_update_state)
+    static anim_handle_key_press_result_t anim_handle_key_press(animation_session_t& animation_trigger_ctx, animation_state_t& state,
+                                                                const anim_clock_t& clock, const platform::input::key_event_t *replay_event) {
         assert(animation_trigger_ctx._input != nullptr);
         assert(animation_trigger_ctx._input->shm != nullptr);
         animation_context_t& ctx = animation_trigger_ctx.anim;
-        [[maybe_unused]] const platform::input::input_context_t& input = *animation_trigger_ctx._input;
+        platform::input::input_context_t& input = *animation_trigger_ctx._input;
         // read-only config
         assert(ctx._local_copy_config != nullptr);
         assert(ctx.shm != nullptr);
-        const config::config_t& current_config = *ctx._local_copy_config;
-
 
-        constexpr size_t fds_animation_trigger_index = 0;
-        constexpr int fds_count = 1;
-        pollfd fds[fds_count] = {
-            { .fd = animation_trigger_ctx.trigger_efd._fd, .events = POLLIN, .revents = 0 },
+        const animation_state_machine_t *machine = get_state_machine(ctx.shm->anim_type);
+        int presses = 0;
+        bool changed = false;
+        platform::timestamp_us_t first_press_us = 0;
+        const auto apply_key_event = [&](const platform::input::key_event_t& key_event) {
+            if (key_event.type == platform::input::key_event_type_t::Press) {
+                first_press_us = presses == 0 ? key_event.timestamp_us : first_press_us;
+                presses++;
+            }
+            changed |= anim_apply_key_event(ctx, state, machine, key_event, clock);
         };
-        assert(fds_count == LEN_ARRAY(fds));
-
-        // check poll, close to FPS, 1/3 part of worktime (max) ?
-        platform::time_ms_t timeout_ms = current_config.fps > 0 ? 1000 / current_config.fps / 3 : 0;
-        timeout_ms = timeout_ms < POOL_MIN_TIMEOUT_MS ? POOL_MIN_TIMEOUT_MS : timeout_ms;
-        timeout_ms = timeout_ms > POOL_MAX_TIMEOUT_MS ? POOL_MAX_TIMEOUT_MS : timeout_ms;
-
-        int any_key_pressed = 0;
-        timeout_ms = timeout_ms >= INT_MAX ? INT_MAX : timeout_ms;
-        const int poll_result = poll(fds, fds_count, static_cast<int>(timeout_ms));
-        if (poll_result > 0) {
-            // animation trigger event
-            if (fds[fds_animation_trigger_index].revents & POLLIN) {
-                BONGOCAT_LOG_VERBOSE("Receive animation trigger event");
-                any_key_pressed = 1;
-
-                uint64_t u;
-                assert(MAX_ATTEMPTS <= INT_MAX);
-                while (read(animation_trigger_ctx.trigger_efd._fd, &u, sizeof(uint64_t)) == sizeof(uint64_t) && any_key_pressed <= static_cast<int>(MAX_ATTEMPTS)) {
-                    any_key_pressed++;
-                }
-                // supress compiler warning
-#if EAGAIN == EWOULDBLOCK
-                if (errno != EAGAIN) {
-                    BONGOCAT_LOG_ERROR("Error reading animation trigger eventfd: %s", strerror(errno));
-                }
-#else
-                if (errno != EAGAIN && errno != EWOULDBLOCK) {
-                    BONGOCAT_LOG_ERROR("Error reading animation trigger eventfd: %s", strerror(errno));
-                }
-#endif
+        if (clock.replay) {
+            if (replay_event != nullptr) {
+                apply_key_event(*replay_event);
             }
+        } else {
+            // always drain the ring, the producer only signals again once it saw the ring empty
+            platform::input::key_event_t key_event;
+            while (platform::input::pop_key_event(input.shm->key_events, key_event)) {
+                apply_key_event(key_event);
+            }
+        }
+        // checked after draining: presses from before the lost releases are counted, then forgotten
+        if (const unsigned int resets = atomic_load(&input.shm->key_events.resets); resets != state.key_events_resets) {
+            BONGOCAT_LOG_VERBOSE("Key releases may be lost, reset held keys: %d", state.keys_down);
+            state.key_events_resets = resets;
+            state.keys_down = 0;
         }
-        if (any_key_pressed <= 0) {
+        if (presses <= 0) {
             return { .any_key_pressed = false, .changed = false};
         }
+        // hold (back to idle) counts from the last release
+        state.hold_frame_ms = 0;
+        BONGOCAT_LOG_VERBOSE("Key press detected - switching to frame %d", ctx.shm->animation_player_data.frame_index);
+
+        // recorded timestamps of a fast replay are no input-to-photon latency
+        return { .any_key_pressed = true, .changed = changed, .input_timestamp_us = clock.replay ? 0 : first_press_us };
+    }
+
+    static void earliest_deadline(platform::time_ms_t& deadline_ms, platform::time_ms_t remaining_ms) {
+        // already due (and evaluated by this update) or no change pending
+        if (remaining_ms <= 0) {
+            return;
+        }
+        if (deadline_ms == NO_DEADLINE_MS || remaining_ms < deadline_ms) {
+            deadline_ms = remaining_ms;
+        }
+    }
+
+    // frame of the current clip advances with FrameTick/IdleTick (see idle transitions of the state)
+    static bool state_has_frame_tick(const animation_state_machine_t& machine, const config::config_t& config, const animation_state_t& state, int current_frame) {
+        const animation_events_t tick_events = animation_events(animation_event_t::FrameTick, animation_event_t::ClipEnd) |
+                                               (config.idle_animation ? animation_events(animation_event_t::IdleTick) : 0);
+        for (size_t i = 0; i < machine.idle_transitions_count; i++) {
+            const animation_transition_t& t = machine.idle_transitions[i];
+            if ((!t.from_any && t.from != state.row_state) || (t.events & tick_events) == 0) {
+                continue;
+            }
+            const animation_clip_t& clip = machine.clips[clip_index(t.to)];
+            // hold clip already stopped on its last frame
+            if (t.to == state.row_state && clip.playback == animation_playback_t::Hold && current_frame >= clip.last_frame) {
+                continue;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // earliest time (from now) at which anim_update_state can change the frame without a key press, NO_DEADLINE_MS if none
+    // see events in anim_collect_idle_events; frame_delta_ms_counter is reset on every frame change
+    static platform::time_ms_t anim_next_deadline_ms(const animation_context_t& ctx, const platform::input::input_context_t& input, const animation_state_t& state,
+                                                     const anim_clock_t& clock) {
+        // read-only config
+        assert(ctx._local_copy_config != nullptr);
+        const config::config_t& current_config = *ctx._local_copy_config;
 
         assert(input.shm != nullptr);
         assert(ctx.shm != nullptr);
-        animation_shared_memory_t& anim_shm = *ctx.shm;
-        //const auto& input_shm = *input.shm;
-        auto& animation_player_data = anim_shm.animation_player_data;
-        const int current_frame = animation_player_data.frame_index;
-        //const int current_row = animation_player_data.sprite_sheet_row;
-        //const animation_state_row_t current_row_state = state.row_state;
-        //const int anim_index = anim_shm.anim_index;
+        const animation_shared_memory_t& anim_shm = *ctx.shm;
+        const auto& animation_player_data = anim_shm.animation_player_data;
 
-        bool ret = false;
-        [[maybe_unused]] int ret_new_frame = current_frame;
-        switch (anim_shm.anim_type) {
-            case config::config_animation_type_t::None:
-                break;
-            case config::config_animation_type_t::Bongocat: {
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_bongocat_key_pressed_next_frame(ctx, state);
-                ret = changed;
-                ret_new_frame = new_frame;
-#endif
-            }break;
-            case config::config_animation_type_t::Digimon: {
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_digimon_key_pressed_next_frame(ctx, input, state);
-                ret = changed;
-                ret_new_frame = new_frame;
-#endif
-            }break;
-            case config::config_animation_type_t::MsPet: {
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-                auto [changed, new_frame] = anim_ms_pet_key_pressed_next_frame(ctx, state);
-                ret = changed;
-                ret_new_frame = new_frame;
-#endif
-            }break;
+        const animation_state_machine_t *machine = get_state_machine(anim_shm.anim_type);
+        if (machine == nullptr) {
+            return NO_DEADLINE_MS;
         }
-        BONGOCAT_LOG_VERBOSE("Key press detected - switching to frame %d", ret_new_frame);
-            return { .any_key_pressed = any_key_pressed > 0, .changed = ret };
+
+        const platform::time_ms_t frame_interval_ms = current_config.animation_speed_ms > 0 ? current_config.animation_speed_ms : 1000 / current_config.fps;
+        const platform::time_ms_t counter_ms = state.frame_delta_ms_counter;
+        platform::time_ms_t deadline_ms = NO_DEADLINE_MS;
+
+        // keypress hold expiry (back to idle)
+        if (state.hold_frame_after_release && state.keys_down <= 0) {
+            earliest_deadline(deadline_ms, current_config.keypress_duration_ms - state.hold_frame_ms + 1);
+        }
+
+        // next frame of the current clip
+        if (state_has_frame_tick(*machine, current_config, state, animation_player_data.frame_index)) {
+            earliest_deadline(deadline_ms, frame_interval_ms - counter_ms + 1);
+        }
+
+        // test animation
+        if (current_config.test_animation_interval_sec > 0) {
+            earliest_deadline(deadline_ms, current_config.test_animation_interval_sec*1000 - counter_ms + 1);
+            if (current_config.test_animation_duration_ms > 0 && state.row_state == animation_state_row_t::Test) {
+                earliest_deadline(deadline_ms, current_config.test_animation_duration_ms - counter_ms + 1);
+            }
+        }
+
+        // boring/sleep timeout (after last key press)
+        const platform::timestamp_ms_t last_key_pressed_timestamp = anim_last_key_pressed_ms(input, state, clock);
+        if (current_config.idle_sleep_timeout_sec > 0 && last_key_pressed_timestamp > 0 && state.row_state != animation_state_row_t::Sleep) {
+            const platform::time_ms_t idle_sleep_timeout_ms = current_config.idle_sleep_timeout_sec*1000;
+            const platform::time_ms_t since_key_pressed_ms = clock.wall_ms - last_key_pressed_timestamp;
+            if (!state.boring_frame_showed) {
+                earliest_deadline(deadline_ms, idle_sleep_timeout_ms/2 - since_key_pressed_ms);
+            }
+            earliest_deadline(deadline_ms, idle_sleep_timeout_ms - since_key_pressed_ms);
+        }
+
+        // scheduled sleep boundary
+        if (current_config.enable_scheduled_sleep) {
+            earliest_deadline(deadline_ms, ms_until_sleep_schedule_change(current_config));
+        }
+
+        // never faster than the governed frame rate
+        if (deadline_ms != NO_DEADLINE_MS && deadline_ms < state.frame_time_ms) {
+            deadline_ms = state.frame_time_ms;
+        }
+
+        return deadline_ms;
     }
 
-    static bool anim_update_state(animation_session_t& animation_trigger_ctx, animation_state_t& state) {
+    struct anim_update_state_result_t {
+        bool changed{false};
+        platform::time_ms_t next_deadline_ms{NO_DEADLINE_MS};
+    };
+    /// advance the state to clock, replay_event: the key event of a replay clock update (nullptr for a deadline)
+    static anim_update_state_result_t anim_update_state(animation_session_t& animation_trigger_ctx, animation_state_t& state,
+                                                        const anim_clock_t& clock, const platform::input::key_event_t *replay_event) {
         assert(animation_trigger_ctx._input);
         const platform::input::input_context_t& input = *animation_trigger_ctx._input;
         animation_context_t& ctx = animation_trigger_ctx.anim;
@@ -997,12 +681,22 @@ namespace bongocat::animation {
         const config::config_t& current_config = *ctx._local_copy_config;
 
         bool ret = false;
+        platform::time_ms_t next_deadline_ms = NO_DEADLINE_MS;
         do {
             platform::LockGuard guard (ctx.anim_lock);
-            state.frame_delta_ms_counter += state.frame_time_ms;
+            const platform::time_us_t locked_start_us = platform::get_monotonic_time_us();
+            // thread is woken up by deadline or key press, advance by the elapsed time of the animation clock
+            const platform::timestamp_ms_t now = clock.now_ms;
+            const platform::time_ms_t elapsed_ms = now > state.last_frame_update_ms ? now - state.last_frame_update_ms : 0;
+            state.last_frame_update_ms = now;
+            state.frame_delta_ms_counter += elapsed_ms;
+            // keypress hold only runs down while no key is held
+            if (state.hold_frame_after_release && state.keys_down <= 0) {
+                state.hold_frame_ms += elapsed_ms;
+            }
 
-            const auto [any_key_pressed, press_changed] = anim_handle_key_press(animation_trigger_ctx, state);
-            const bool idle_changed = anim_handle_idle_animation(ctx, input, state, any_key_pressed);
+            const auto [any_key_pressed, press_changed, input_timestamp_us] = anim_handle_key_press(animation_trigger_ctx, state, clock, replay_event);
+            const bool idle_changed = anim_handle_idle_animation(ctx, input, state, any_key_pressed, clock);
 
             if (press_changed) {
                 BONGOCAT_LOG_VERBOSE("Trigger key press animation");
@@ -1019,12 +713,67 @@ namespace bongocat::animation {
                 state.hold_frame_after_release = false;
                 state.hold_frame_ms = 0;
             }
-            if (state.hold_frame_after_release) {
-                state.hold_frame_ms += state.frame_time_ms;
+
+            // after the state update, sleep state picks fps_sleep
+            anim_update_frame_rate(ctx, state, now);
+            next_deadline_ms = anim_next_deadline_ms(ctx, input, state, clock);
+            state.next_deadline_ms = next_deadline_ms;
+            ctx.shm->animation_player_data.time_until_next_frame_ms = next_deadline_ms;
+
+            // render thread only sees the published frame, anim_type/anim_index may also be changed by update_config
+            const animation_frame_snapshot_t published = read_animation_frame(ctx._published_frame);
+            animation_frame_snapshot_t current = { .anim_type = ctx.shm->anim_type, .anim_index = ctx.shm->anim_index,
+                                                   .animation_player_data = ctx.shm->animation_player_data,
+                                                   .changed_timestamp_us = published.changed_timestamp_us,
+                                                   .input_timestamp_us = published.input_timestamp_us };
+            if (published.anim_type != current.anim_type || published.anim_index != current.anim_index ||
+                published.animation_player_data.frame_index != current.animation_player_data.frame_index ||
+                published.animation_player_data.sprite_sheet_row != current.animation_player_data.sprite_sheet_row) {
+                ret = true;
+                // latency instrumentation (see draw_bar), same clock as the evdev timestamps
+                current.changed_timestamp_us = platform::get_current_time_us();
+                current.input_timestamp_us = press_changed ? input_timestamp_us : 0;
             }
+            publish_animation_frame(ctx._published_frame, current);
+
+            histogram_record(ctx._frame_timing.update_locked_us, platform::get_monotonic_time_us() - locked_start_us);
         } while(false);
 
-        return ret;
+        return { .changed = ret, .next_deadline_ms = next_deadline_ms };
+    }
+
+    /// --replay-fast: key events are applied one at a time at their recorded timestamps, the deadlines expiring in between run
+    /// as the tick timer would have fired them; once the recording ended the timeline goes on deadline by deadline (tick_due)
+    static anim_update_state_result_t anim_replay_update_state(animation_session_t& animation_trigger_ctx, animation_state_t& state, bool tick_due) {
+        assert(animation_trigger_ctx._input != nullptr);
+        assert(animation_trigger_ctx._input->shm != nullptr);
+        platform::input::input_context_t& input = *animation_trigger_ctx._input;
+
+        bool changed = false;
+        platform::input::key_event_t key_event;
+        while (platform::input::pop_key_event(input.shm->key_events, key_event)) {
+            const platform::timestamp_ms_t event_ms = key_event.timestamp_us / 1000;
+            if (!state.replay_started) {
+                // timeline starts with the first recorded event (replay start), idle timeouts count from there
+                state.replay_started = true;
+                state.last_frame_update_ms = event_ms;
+                state.last_key_pressed_ms = event_ms;
+            }
+            const platform::timestamp_ms_t at_ms = event_ms > state.last_frame_update_ms ? event_ms : state.last_frame_update_ms;
+            while (state.next_deadline_ms != NO_DEADLINE_MS && state.last_frame_update_ms + state.next_deadline_ms < at_ms) {
+                changed |= anim_update_state(animation_trigger_ctx, state, anim_replay_clock(state.last_frame_update_ms + state.next_deadline_ms), nullptr).changed;
+            }
+            changed |= anim_update_state(animation_trigger_ctx, state, anim_replay_clock(at_ms), &key_event).changed;
+        }
+
+        // a later event can be older than any deadline, the timeline only moves on its own once the recording is done
+        if (!state.replay_started || atomic_load(&input._capture_input_running)) {
+            return { .changed = changed, .next_deadline_ms = NO_DEADLINE_MS };
+        }
+        if (tick_due && state.next_deadline_ms != NO_DEADLINE_MS) {
+            changed |= anim_update_state(animation_trigger_ctx, state, anim_replay_clock(state.last_frame_update_ms + state.next_deadline_ms), nullptr).changed;
+        }
+        return { .changed = changed, .next_deadline_ms = state.next_deadline_ms };
     }
 
     // =============================================================================
@@ -1034,16 +783,22 @@ namespace bongocat::animation {
     static void anim_init_state(animation_context_t& ctx, animation_state_t& state) {
         // read-only config
         assert(ctx._local_copy_config != nullptr);
-        const config::config_t& current_config = *ctx._local_copy_config;
+        [[maybe_unused]] const config::config_t& current_config = *ctx._local_copy_config;
         assert(current_config.fps > 0);
 
         state.hold_frame_ms = 0;
         state.frame_delta_ms_counter = 0;
-        state.frame_time_ns = 1000000000LL / current_config.fps;
-        state.frame_time_ms = state.frame_time_ns/1000000LL;
-        state.last_frame_update_ms = platform::get_current_time_ms();
+        state.last_frame_update_ms = platform::get_monotonic_time_us() / 1000;
+        state.last_input_ms = 0;
+        state.keys_down = 0;
+        state.next_deadline_ms = NO_DEADLINE_MS;
+        state.last_key_pressed_ms = 0;
+        state.replay_started = false;
+        state.key_side = key_side_t::Unknown;
         state.row_state = animation_state_row_t::Idle;
         state.boring_frame_showed = false;
+        state.fps = 0;
+        anim_update_frame_rate(ctx, state, state.last_frame_update_ms);
     }
 
 
@@ -1065,49 +820,54 @@ namespace bongocat::animation {
         anim_init_state(ctx, state);
 
         // setup animation player
-        switch (current_config.animation_type) {
-            case config::config_animation_type_t::None:
-                break;
-            case config::config_animation_type_t::Bongocat:
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-                animation_player_data.frame_index = current_config.idle_frame;
-                animation_player_data.sprite_sheet_row = assets::BONGOCAT_SPRITE_SHEET_ROWS-1;
-                animation_player_data.start_frame_index = 0;
-                animation_player_data.end_frame_index = 1;
-                state.row_state = animation_state_row_t::Idle;
-#endif
-                break;
-            case config::config_animation_type_t::Digimon:
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-                animation_player_data.frame_index = current_config.idle_frame;
-                animation_player_data.sprite_sheet_row = assets::DIGIMON_SPRITE_SHEET_ROWS-1;
-                animation_player_data.start_frame_index = 0;
-                animation_player_data.end_frame_index = 1;
-                state.row_state = animation_state_row_t::Idle;
-#endif
-                break;
-            case config::config_animation_type_t::MsPet:
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-                animation_player_data.frame_index = current_config.idle_frame;
-                animation_player_data.sprite_sheet_row = assets::CLIPPY_SPRITE_SHEET_ROW_IDLE;
-                animation_player_data.start_frame_index = 0;
-                animation_player_data.end_frame_index = assets::CLIPPY_FRAMES_IDLE-1;
-                state.row_state = animation_state_row_t::Idle;
-#endif
-                break;
+        if (const animation_state_machine_t *machine = get_state_machine(current_config.animation_type)) {
+            const animation_clip_t& idle_clip = machine->clips[clip_index(animation_state_row_t::Idle)];
+            animation_player_data.frame_index = current_config.idle_frame;
+            animation_player_data.sprite_sheet_row = idle_clip.row;
+            animation_player_data.start_frame_index = idle_clip.first_frame;
+            animation_player_data.end_frame_index = idle_clip.last_frame;
+            state.row_state = animation_state_row_t::Idle;
         }
 
+        publish_animation_frame(ctx._published_frame, { .anim_type = anim_shm.anim_type, .anim_index = anim_shm.anim_index,
+                                                         .animation_player_data = animation_player_data });
+
         atomic_store(&ctx._animation_running, true);
         BONGOCAT_LOG_DEBUG("Animation thread main loop started");
 
-        timespec next_frame_time{};
-        clock_gettime(CLOCK_MONOTONIC, &next_frame_time);
+        constexpr size_t fds_tick_index = 0;
+        constexpr size_t fds_animation_trigger_index = 1;
+        constexpr int fds_count = 2;
+        pollfd fds[fds_count] = {
+            { .fd = ctx._tick_tfd._fd, .events = POLLIN, .revents = 0 },
+            { .fd = trigger_ctx.trigger_efd._fd, .events = POLLIN, .revents = 0 },
+        };
+        assert(fds_count == LEN_ARRAY(fds));
 
         // trigger initial render
         platform::wayland::request_render(trigger_ctx);
 
+        bool triggered = false;
+        platform::time_us_t scheduled_tick_us = 0;     // monotonic time the tick timer is armed for (0: disarmed)
         while (atomic_load(&ctx._animation_running)) {
-            const bool frame_changed = anim_update_state(trigger_ctx, state);
+            const platform::time_us_t tick_start_us = platform::get_monotonic_time_us();
+            if (triggered) {
+                anim_reset_trigger(trigger_ctx);
+            }
+            anim_update_state_result_t update{};
+            if (!atomic_load(&ctx._suspended)) {
+                if (anim_uses_replay_clock(*trigger_ctx._input)) {
+                    update = anim_replay_update_state(trigger_ctx, state, scheduled_tick_us > 0 && tick_start_us >= scheduled_tick_us);
+                } else {
+                    update = anim_update_state(trigger_ctx, state, anim_live_clock(), nullptr);
+                }
+            } else {
+                // parked while suspended, nothing gets rendered; drop key events that raced with the suspend
+                platform::input::key_event_t key_event;
+                while (platform::input::pop_key_event(trigger_ctx._input->shm->key_events, key_event)) {}
+                state.keys_down = 0;
+            }
+            const auto [frame_changed, next_deadline_ms] = update;
             if (frame_changed) {
                 uint64_t u = 1;
                 if (write(trigger_ctx.render_efd._fd, &u, sizeof(uint64_t)) >= 0) {
@@ -1117,46 +877,49 @@ namespace bongocat::animation {
                 }
             }
 
-            // Advance next frame time by exactly one frame
-            next_frame_time.tv_nsec += state.frame_time_ns;
-            while (next_frame_time.tv_nsec >= 1000000000L) {
-                next_frame_time.tv_nsec -= 1000000000L;
-                next_frame_time.tv_sec += 1;
+            // one-shot tick at the next possible state change, disarmed (zero) when only a key press can change the frame
+            itimerspec tick{};
+            if (next_deadline_ms != NO_DEADLINE_MS) {
+                tick.it_value.tv_sec = static_cast<time_t>(next_deadline_ms / 1000);
+                tick.it_value.tv_nsec = static_cast<long>((next_deadline_ms % 1000) * 1000000L);
+            }
+            const platform::time_us_t armed_us = platform::get_monotonic_time_us();
+            if (timerfd_settime(ctx._tick_tfd._fd, 0, &tick, nullptr) != 0) {
+                BONGOCAT_LOG_ERROR("Failed to arm animation tick timer: %s", strerror(errno));
             }
+            scheduled_tick_us = next_deadline_ms != NO_DEADLINE_MS ? armed_us + next_deadline_ms * 1000 : 0;
+            histogram_record(ctx._frame_timing.tick_duration_us, armed_us - tick_start_us);
 
-            timespec now{};
-            clock_gettime(CLOCK_MONOTONIC, &now);
-
-            // If we're already past the next frame time, catch up (skip missed frames)
-            if ((now.tv_sec > next_frame_time.tv_sec) ||
-                (now.tv_sec == next_frame_time.tv_sec && now.tv_nsec > next_frame_time.tv_nsec)) {
-                // Skip ahead until next_frame_time is >= now
-                do {
-                    next_frame_time.tv_nsec += state.frame_time_ns;
-                    while (next_frame_time.tv_nsec >= 1000000000L) {
-                        next_frame_time.tv_nsec -= 1000000000L;
-                        next_frame_time.tv_sec += 1;
-                    }
-                } while ((now.tv_sec > next_frame_time.tv_sec) ||
-                         (now.tv_sec == next_frame_time.tv_sec && now.tv_nsec > next_frame_time.tv_nsec));
+            // stop/update_config may have fired the tick before it got re-armed above
+            triggered = false;
+            if (!atomic_load(&ctx._animation_running)) {
+                break;
+            }
+            if (atomic_exchange(&ctx._wake_requested, false)) {
+                continue;
+            }
 
-                ctx.shm->animation_player_data.time_until_next_frame_ms = 0;
-                //BONGOCAT_LOG_VERBOSE("Animation skipped frame(s) to catch up");
-            } else {
-                // Sleep until the next frame using absolute time
-                long sec_diff  = next_frame_time.tv_sec  - now.tv_sec;
-                long nsec_diff = next_frame_time.tv_nsec - now.tv_nsec;
-                ctx.shm->animation_player_data.time_until_next_frame_ms =
-                    static_cast<platform::time_ms_t>(sec_diff * 1000L + (nsec_diff + 999999LL) / 1000000LL);
-
-                if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_frame_time, nullptr) != 0) {
-                    // Interrupted, just continue
+            const int poll_result = poll(fds, fds_count, -1);
+            if (poll_result < 0) {
+                if (errno == EINTR) continue;
+                BONGOCAT_LOG_ERROR("Animation poll error: %s", strerror(errno));
+                break;
+            }
+            if (fds[fds_tick_index].revents & POLLIN) {
+                uint64_t expirations;
+                if (read(ctx._tick_tfd._fd, &expirations, sizeof(uint64_t)) != sizeof(uint64_t) && errno != EAGAIN) {
+                    BONGOCAT_LOG_ERROR("Error reading animation tick timer: %s", strerror(errno));
+                }
+                // tickless: a late wake up doesn't replay missed ticks, count the frame intervals it slipped instead
+                if (scheduled_tick_us > 0) {
+                    const platform::time_us_t lateness_us = platform::get_monotonic_time_us() - scheduled_tick_us;
+                    histogram_record(ctx._frame_timing.tick_lateness_us, lateness_us);
+                    if (state.frame_time_ns > 0) {
+                        histogram_record(ctx._frame_timing.skipped_frames, lateness_us * 1000 / state.frame_time_ns);
+                    }
                 }
             }
-
-            // Update variables from config in case FPS changed
-            state.frame_time_ns = 1000000000LL / current_config.fps;
-            state.frame_time_ms = state.frame_time_ns / 1000000LL;
+            triggered = (fds[fds_animation_trigger_index].revents & POLLIN) != 0;
         }
 
         BONGOCAT_LOG_INFO("Animation thread main loop exited");
@@ -1193,11 +956,49 @@ namespace bongocat::animation {
         }
     }
 
+    void wake(animation_context_t& ctx) {
+        if (ctx._tick_tfd._fd < 0) {
+            return;
+        }
+        atomic_store(&ctx._wake_requested, true);
+        // expire the tick timer right away (a zero it_value would disarm it)
+        itimerspec tick{};
+        tick.it_value.tv_nsec = 1;
+        if (timerfd_settime(ctx._tick_tfd._fd, 0, &tick, nullptr) != 0) {
+            BONGOCAT_LOG_ERROR("Failed to wake animation thread: %s", strerror(errno));
+        }
+    }
+
+    void print_frame_timing_stats(const animation_context_t& ctx) {
+        BONGOCAT_LOG_INFO("Animation frame timing:");
+        histogram_print("tick duration", "us", ctx._frame_timing.tick_duration_us);
+        histogram_print("tick lateness", "us", ctx._frame_timing.tick_lateness_us);
+        histogram_print("skipped frames per tick", "", ctx._frame_timing.skipped_frames);
+        histogram_print("anim_update_state (anim_lock held)", "us", ctx._frame_timing.update_locked_us);
+    }
+
+    void set_suspended(animation_context_t& ctx, bool suspended) {
+        if (atomic_exchange(&ctx._suspended, suspended) == suspended) {
+            return;
+        }
+        BONGOCAT_LOG_DEBUG("Animation %s", suspended ? "suspended" : "resumed");
+        // suspend: disarm the tick timer; resume: catch up on the elapsed time and publish the current frame
+        wake(ctx);
+    }
+
     void update_config(animation_context_t& ctx, const config::config_t& config) {
         assert(ctx._local_copy_config != nullptr);
         assert(ctx.shm != nullptr);
 
 
+        // pre-scaled frames depend on size, padding and color of the sprite sheet
+        const config::config_t& old_config = *ctx._local_copy_config;
+        if (old_config.cat_height != config.cat_height ||
+            old_config.padding_x != config.padding_x || old_config.padding_y != config.padding_y ||
+            old_config.invert_color != config.invert_color) {
+            atomic_store(&ctx._frame_cache.invalidated, true);
+        }
+
         /// @TODO: make updating config thrad-safe (animation thread)
         *ctx._local_copy_config = config;
 
@@ -1235,5 +1036,8 @@ namespace bongocat::animation {
                 ctx.shm->anim_index = assets::MS_PETS_ANIMATIONS_COUNT > 0 ? config.animation_index % static_cast<int>(assets::MS_PETS_ANIMATIONS_COUNT) : 0;
                 break;
         }
+
+        // timings may have changed, recompute the next deadline
+        wake(ctx);
     }
 }
@@ -10,6 +10,7 @@
 #include <sys/stat.h>
 #include <cassert>
 #include <sys/eventfd.h>
+#include <sys/timerfd.h>
 
 #include "load_images.cpp.inl"
 
@@ -45,6 +46,9 @@ namespace bongocat::animation {
         BONGOCAT_LOG_INFO("Initializing animation system");
         animation_session_t ret;
 
+        blit_select_kernel();
+        BONGOCAT_LOG_DEBUG("Using %s blit kernel", blit_get_kernel_name());
+
         // Initialize shared memory
         ret.anim.shm = platform::make_allocated_mmap<animation_shared_memory_t>();
         if (ret.anim.shm == nullptr) {
@@ -76,6 +80,12 @@ namespace bongocat::animation {
             return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
         }
 
+        ret.anim._tick_tfd = platform::FileDescriptor(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+        if (ret.anim._tick_tfd._fd < 0) {
+            BONGOCAT_LOG_ERROR("Failed to create animation tick timer: %s", strerror(errno));
+            return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+        }
+
         // Initialize embedded images data
         /// @TODO: async assets load
 
@@ -151,6 +161,8 @@ namespace bongocat::animation {
 
     void stop(animation_context_t& ctx) {
         atomic_store(&ctx._animation_running, false);
+        // thread may be blocked until the next deadline
+        wake(ctx);
         if (ctx._anim_thread) {
             BONGOCAT_LOG_DEBUG("Stopping animation thread");
             // Wait for thread to finish gracefully
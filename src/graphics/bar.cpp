@@ -6,6 +6,8 @@
 #include "graphics/animation.h"
 #include <wayland-client.h>
 #include <cassert>
+#include <cstring>
+#include <ctime>
 
 namespace bongocat::animation {
     static void frame_done(void *data, wl_callback *cb, [[maybe_unused]] uint32_t time) {
@@ -42,8 +44,11 @@ namespace bongocat::animation {
 
                 atomic_store(&wayland_ctx._frame_pending, false);
                 const platform::timestamp_ms_t now = platform::get_current_time_ms();
-                assert(current_config.fps > 0);
-                if (const platform::time_ms_t frame_interval_ms = 1000 / current_config.fps; wayland_ctx._last_frame_timestamp_ms <= 0 || (now - wayland_ctx._last_frame_timestamp_ms) >= frame_interval_ms) {
+                // throttle by the governed frame rate of the animation thread (fps before it started)
+                const int governed_fps = atomic_load(&trigger_ctx.anim._governed_fps);
+                const int fps = governed_fps > 0 ? governed_fps : current_config.fps;
+                assert(fps > 0);
+                if (const platform::time_ms_t frame_interval_ms = 1000 / fps; wayland_ctx._last_frame_timestamp_ms <= 0 || (now - wayland_ctx._last_frame_timestamp_ms) >= frame_interval_ms) {
                     wayland_ctx._last_frame_timestamp_ms = now;
 
                     if (atomic_exchange(&wayland_ctx._redraw_after_frame, false)) {
@@ -66,6 +71,114 @@ namespace bongocat::animation {
         .done = frame_done
     };
 
+    // =============================================================================
+    // LATENCY STATISTICS
+    // =============================================================================
+
+    static platform::timestamp_us_t get_clock_time_us(clockid_t clock_id) {
+        timespec ts{};
+        if (clock_gettime(clock_id, &ts) != 0) {
+            return 0;
+        }
+        return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+    }
+
+    static void release_presentation_feedback(platform::wayland::presentation_feedback_slot_t& slot, struct wp_presentation_feedback *feedback) {
+        if (slot.feedback != feedback) {
+            BONGOCAT_LOG_VERBOSE("wp_presentation_feedback: feedback is not matching");
+        }
+        wp_presentation_feedback_destroy(feedback);
+        slot = {};
+    }
+
+    static void presentation_feedback_sync_output([[maybe_unused]] void *data, [[maybe_unused]] struct wp_presentation_feedback *feedback, [[maybe_unused]] wl_output *output) {
+    }
+
+    static void presentation_feedback_presented(void *data, struct wp_presentation_feedback *feedback,
+                                                uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+                                                [[maybe_unused]] uint32_t refresh,
+                                                [[maybe_unused]] uint32_t seq_hi, [[maybe_unused]] uint32_t seq_lo,
+                                                [[maybe_unused]] uint32_t flags) {
+        if (!data) {
+            BONGOCAT_LOG_WARNING("Handler called with null data (ignored)");
+            wp_presentation_feedback_destroy(feedback);
+            return;
+        }
+        auto& slot = *static_cast<platform::wayland::presentation_feedback_slot_t *>(data);
+
+        const auto tv_sec = static_cast<int64_t>((static_cast<uint64_t>(tv_sec_hi) << 32u) | tv_sec_lo);
+        const platform::timestamp_us_t presented_us = tv_sec * 1000000LL + tv_nsec / 1000;
+        if (slot._stats) {
+            histogram_record(slot._stats->commit_to_presented, presented_us - slot.committed_us);
+            if (slot.input_timestamp_us > 0) {
+                // evdev timestamps are CLOCK_REALTIME, move the presentation time over to that clock
+                const platform::time_us_t presented_ago_us = get_clock_time_us(slot.clock_id) - presented_us;
+                histogram_record(slot._stats->input_to_presented, platform::get_current_time_us() - presented_ago_us - slot.input_timestamp_us);
+            }
+        }
+        BONGOCAT_LOG_VERBOSE("wp_presentation_feedback.presented: %lldus after commit", static_cast<long long>(presented_us - slot.committed_us));
+        release_presentation_feedback(slot, feedback);
+    }
+
+    static void presentation_feedback_discarded(void *data, struct wp_presentation_feedback *feedback) {
+        if (!data) {
+            BONGOCAT_LOG_WARNING("Handler called with null data (ignored)");
+            wp_presentation_feedback_destroy(feedback);
+            return;
+        }
+        auto& slot = *static_cast<platform::wayland::presentation_feedback_slot_t *>(data);
+
+        if (slot._stats) {
+            atomic_fetch_add(&slot._stats->discarded, 1);
+        }
+        BONGOCAT_LOG_VERBOSE("wp_presentation_feedback.discarded");
+        release_presentation_feedback(slot, feedback);
+    }
+
+    /// @NOTE: presentation_feedback_listeners MUST pass data as presentation_feedback_slot_t, see wp_presentation_feedback_add_listener
+    static constexpr wp_presentation_feedback_listener presentation_feedback_listener = {
+        .sync_output = presentation_feedback_sync_output,
+        .presented = presentation_feedback_presented,
+        .discarded = presentation_feedback_discarded,
+    };
+
+    /// measure the next commit of surface, once per new animation frame (enable_debug only)
+    static void request_frame_latency(platform::wayland::wayland_session_t& ctx, wl_surface *surface, const animation_frame_snapshot_t& frame) {
+        platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+
+        assert(wayland_ctx._local_copy_config != nullptr);
+        if (!wayland_ctx._local_copy_config->enable_debug) {
+            return;
+        }
+        if (frame.changed_timestamp_us <= 0 || frame.changed_timestamp_us == wayland_ctx._last_latency_frame_us) {
+            return;
+        }
+        wayland_ctx._last_latency_frame_us = frame.changed_timestamp_us;
+
+        platform::wayland::frame_latency_stats_t& stats = wayland_ctx.ctx_shm->latency;
+        if (frame.input_timestamp_us > 0) {
+            histogram_record(stats.input_to_animation, frame.changed_timestamp_us - frame.input_timestamp_us);
+        }
+        histogram_record(stats.animation_to_commit, platform::get_current_time_us() - frame.changed_timestamp_us);
+
+        if (!wayland_ctx.presentation) {
+            return;
+        }
+        for (size_t i = 0; i < platform::wayland::MAX_PRESENTATION_FEEDBACKS; i++) {
+            platform::wayland::presentation_feedback_slot_t& slot = wayland_ctx._presentation_feedbacks[i];
+            if (slot.feedback == nullptr) {
+                slot.clock_id = wayland_ctx._presentation_clock_id;
+                slot.committed_us = get_clock_time_us(slot.clock_id);
+                slot.input_timestamp_us = frame.input_timestamp_us;
+                slot._stats = &stats;
+                slot.feedback = wp_presentation_feedback(wayland_ctx.presentation, surface);
+                wp_presentation_feedback_add_listener(slot.feedback, &presentation_feedback_listener, &slot);
+                return;
+            }
+        }
+        BONGOCAT_LOG_VERBOSE("All presentation feedbacks in flight, frame not measured");
+    }
+
     // =============================================================================
     // DRAWING MANAGEMENT
     // =============================================================================
@@ -124,81 +237,483 @@ namespace bongocat::animation {
         return { .x = cat_x, .y = cat_y, .width = cat_width, .height = cat_height };
     }
 
-    void draw_sprite(platform::wayland::wayland_session_t& ctx, const generic_sprite_sheet_animation_t& sheet) {
-        if (sheet.frame_width <= 0 || sheet.frame_height <= 0) {
+    static cat_rect_t clip_rect(const cat_rect_t& rect, int width, int height) {
+        const int x0 = rect.x < 0 ? 0 : rect.x;
+        const int y0 = rect.y < 0 ? 0 : rect.y;
+        const int x1 = rect.x + rect.width > width ? width : rect.x + rect.width;
+        const int y1 = rect.y + rect.height > height ? height : rect.y + rect.height;
+        if (x1 <= x0 || y1 <= y0) {
+            return { .x = 0, .y = 0, .width = 0, .height = 0 };
+        }
+        return { .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0 };
+    }
+    static cat_rect_t union_rect(const cat_rect_t& a, const cat_rect_t& b) {
+        if (a.width <= 0 || a.height <= 0) return b;
+        if (b.width <= 0 || b.height <= 0) return a;
+        const int x0 = a.x < b.x ? a.x : b.x;
+        const int y0 = a.y < b.y ? a.y : b.y;
+        const int x1 = a.x + a.width > b.x + b.width ? a.x + a.width : b.x + b.width;
+        const int y1 = a.y + a.height > b.y + b.height ? a.y + a.height : b.y + b.height;
+        return { .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0 };
+    }
+    static void clear_rect(uint8_t *pixels, int buffer_width, const cat_rect_t& rect, uint32_t fill) {
+        assert(rect.x >= 0 && rect.y >= 0);
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            auto *row = reinterpret_cast<uint32_t *>(pixels) + static_cast<size_t>(y) * static_cast<size_t>(buffer_width) + rect.x;
+            for (int x = 0; x < rect.width; x++) {
+                row[x] = fill;
+            }
+        }
+    }
+
+    // =============================================================================
+    // FRAME CACHE
+    // =============================================================================
+
+    static frame_cache_t& frame_cache_prepare(animation_context_t& anim, config::config_animation_type_t anim_type, int anim_index,
+                                              int frame_width, int frame_height, size_t slots_count) {
+        frame_cache_t& cache = anim._frame_cache;
+        const bool invalidated = atomic_exchange(&cache.invalidated, false);
+        if (invalidated || !cache.slots || cache.slots.count != slots_count ||
+            cache.anim_type != anim_type || cache.anim_index != anim_index ||
+            cache.frame_width != frame_width || cache.frame_height != frame_height) {
+            cleanup_frame_cache(cache);
+            cache.slots = make_allocated_array<AllocatedArray<uint8_t>>(slots_count);
+            cache.anim_type = anim_type;
+            cache.anim_index = anim_index;
+            cache.frame_width = frame_width;
+            cache.frame_height = frame_height;
+            BONGOCAT_LOG_VERBOSE("Frame cache reset: %dx%d, %zu slots", frame_width, frame_height, slots_count);
+        }
+        return cache;
+    }
+
+    static const uint8_t* frame_cache_get(frame_cache_t& cache, size_t slot,
+                                          const uint8_t *sheet_pixels, size_t sheet_pixels_size, int sheet_width, int sheet_height, int sheet_channels,
+                                          const sprite_sheet_spans_t& sheet_spans, const sprite_sheet_palette_t *sheet_palette,
+                                          int src_x, int src_y, int src_frame_width, int src_frame_height) {
+        if (slot >= cache.slots.count || cache.frame_width <= 0 || cache.frame_height <= 0) {
+            return nullptr;
+        }
+
+        AllocatedArray<uint8_t>& frame = cache.slots[slot];
+        if (!frame) {
+            // transparent background, scaled + swizzled sprite frame on top
+            frame = make_allocated_array<uint8_t>(static_cast<size_t>(cache.frame_width) * static_cast<size_t>(cache.frame_height) * BGRA_CHANNELS);
+            if (!frame) {
+                return nullptr;
+            }
+            blit_image_scaled(frame.data, frame._size_bytes,
+                              cache.frame_width, cache.frame_height, BGRA_CHANNELS,
+                              sheet_pixels, sheet_pixels_size, sheet_width, sheet_height, sheet_channels,
+                              src_x, src_y,
+                              src_frame_width, src_frame_height,
+                              0, 0, cache.frame_width, cache.frame_height,
+                              drawing_color_order_t::COLOR_ORDER_BGRA, drawing_color_order_t::COLOR_ORDER_RGBA,
+                              &sheet_spans, sheet_palette);
+            cache._size_bytes += frame._size_bytes;
+#ifndef BONGOCAT_DISABLE_MEMORY_STATISTICS
+            memory_set_frame_cache_size(cache._size_bytes);
+#endif
+        }
+
+        return frame.data;
+    }
+
+    // copy cached frame into buffer, skip transparent pixels (alpha is either 0 or above THRESHOLD_ALPHA)
+    static void draw_cached_frame(uint8_t *pixels, size_t pixels_size, int buffer_width, int buffer_height,
+                                  const uint8_t *frame, const cat_rect_t& rect) {
+        const cat_rect_t clipped = clip_rect(rect, buffer_width, buffer_height);
+        if (clipped.width <= 0 || clipped.height <= 0) {
+            return;
+        }
+        if (static_cast<size_t>(buffer_width) * static_cast<size_t>(buffer_height) * BGRA_CHANNELS > pixels_size) {
             return;
         }
 
-        platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+        const int frame_x = clipped.x - rect.x;
+        const int frame_y = clipped.y - rect.y;
+        for (int y = 0; y < clipped.height; y++) {
+            auto *dest_row = reinterpret_cast<uint32_t *>(pixels) + static_cast<size_t>(clipped.y + y) * static_cast<size_t>(buffer_width) + clipped.x;
+            const auto *src_row = reinterpret_cast<const uint32_t *>(frame) + static_cast<size_t>(frame_y + y) * static_cast<size_t>(rect.width) + frame_x;
+            for (int x = 0; x < clipped.width; x++) {
+                const uint32_t px = src_row[x];
+                dest_row[x] = (px & 0x80000000u) ? px : dest_row[x];
+            }
+        }
+    }
+
+    struct draw_target_t {
+        uint8_t *pixels{nullptr};
+        size_t pixels_size{0};
+        int width{0};
+        int height{0};
+    };
+
+    /// sprite sheet and frame that is shown right now, rect is in layer surface coordinates
+    struct sprite_frame_t {
+        const generic_sprite_sheet_animation_t *sheet{nullptr};
+        const ms_pet_sprite_sheet_t *ms_pet_sheet{nullptr};
+        animation_frame_snapshot_t frame{};
+        int frame_width{0};     // unscaled frame size in sprite sheet
+        int frame_height{0};
+        cat_rect_t rect{};
+    };
+
+    cat_rect_t draw_sprite(platform::wayland::wayland_session_t& ctx, const draw_target_t& target, const cat_rect_t& rect, const generic_sprite_sheet_animation_t& sheet,
+                           const animation_frame_snapshot_t& frame_state) {
+        if (sheet.frame_width <= 0 || sheet.frame_height <= 0) {
+            return {};
+        }
+
         animation_context_t& anim = ctx.animation_trigger_context->anim;
         //animation_trigger_context_t *trigger_ctx = ctx.animation_trigger_context;
-        platform::wayland::wayland_shared_memory_t *wayland_ctx_shm = wayland_ctx.ctx_shm.ptr;
+
+        const int frame_index = frame_state.animation_player_data.frame_index;
+        const sprite_sheet_animation_region_t* region = frame_index >= 0 && static_cast<size_t>(frame_index) < MAX_NUM_FRAMES && sheet.frames[frame_index].valid
+                    ? &sheet.frames[frame_index]
+                    : nullptr;
+
+        if (region) {
+            frame_cache_t& cache = frame_cache_prepare(anim, frame_state.anim_type, frame_state.anim_index, rect.width, rect.height, MAX_NUM_FRAMES);
+            const uint8_t *frame = frame_cache_get(cache, static_cast<size_t>(frame_index),
+                                                   sheet.pixels.data, sheet.pixels._size_bytes, sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
+                                                   sheet.spans, &sheet.palette,
+                                                   region->col * sheet.frame_width, region->row * sheet.frame_height,
+                                                   sheet.frame_width, sheet.frame_height);
+            if (frame) {
+                draw_cached_frame(target.pixels, target.pixels_size, target.width, target.height, frame, rect);
+            } else {
+                // fallback: scale directly into buffer
+                blit_image_scaled(target.pixels, target.pixels_size,
+                                  target.width, target.height, BGRA_CHANNELS,
+                                  sheet.pixels.data, sheet.pixels._size_bytes,  sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
+                                  region->col * sheet.frame_width, region->row * sheet.frame_height,
+                                  sheet.frame_width, sheet.frame_height,
+                                  rect.x, rect.y, rect.width, rect.height,
+                                  drawing_color_order_t::COLOR_ORDER_BGRA, drawing_color_order_t::COLOR_ORDER_RGBA,
+                                  &sheet.spans, &sheet.palette);
+            }
+            return rect;
+        }
+
+        return {};
+    }
+
+#ifndef FEATURE_INCLUDE_ONLY_BONGOCAT_EMBEDDED_ASSETS
+    cat_rect_t draw_sprite(platform::wayland::wayland_session_t& ctx, const draw_target_t& target, const cat_rect_t& rect, const ms_pet_sprite_sheet_t& sheet,
+                           const animation_frame_snapshot_t& frame_state) {
+        if (sheet.frame_width <= 0 || sheet.frame_height <= 0) {
+            return {};
+        }
+
+        animation_context_t& anim = ctx.animation_trigger_context->anim;
+        //animation_trigger_context_t *trigger_ctx = ctx.animation_trigger_context;
+
+        const int col = frame_state.animation_player_data.frame_index;
+        const int row = frame_state.animation_player_data.sprite_sheet_row;
+        const uint8_t *frame = nullptr;
+        if (sheet.frame_columns > 0 && sheet.frame_rows > 0 && col >= 0 && row >= 0 && col < sheet.frame_columns && row < sheet.frame_rows) {
+            frame_cache_t& cache = frame_cache_prepare(anim, frame_state.anim_type, frame_state.anim_index, rect.width, rect.height,
+                                                       static_cast<size_t>(sheet.frame_columns) * static_cast<size_t>(sheet.frame_rows));
+            frame = frame_cache_get(cache, static_cast<size_t>(row) * static_cast<size_t>(sheet.frame_columns) + static_cast<size_t>(col),
+                                    sheet.pixels.data, sheet.pixels._size_bytes, sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
+                                    sheet.spans, nullptr,
+                                    col * sheet.frame_width, row * sheet.frame_height,
+                                    sheet.frame_width, sheet.frame_height);
+        }
+        if (frame) {
+            draw_cached_frame(target.pixels, target.pixels_size, target.width, target.height, frame, rect);
+        } else {
+            // fallback: scale directly into buffer
+            blit_image_scaled(target.pixels, target.pixels_size,
+                              target.width, target.height, BGRA_CHANNELS,
+                              sheet.pixels.data, sheet.pixels._size_bytes,  sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
+                              col * sheet.frame_width, row * sheet.frame_height,
+                              sheet.frame_width, sheet.frame_height,
+                              rect.x, rect.y, rect.width, rect.height,
+                              drawing_color_order_t::COLOR_ORDER_BGRA, drawing_color_order_t::COLOR_ORDER_RGBA,
+                              &sheet.spans);
+        }
+        return rect;
+    }
+#endif
+
+    /// frame state is read from the published snapshot (no anim_lock), sprite sheets are immutable after loading
+    static sprite_frame_t get_current_sprite(const platform::wayland::wayland_session_t& ctx) {
+        const platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+        const animation_context_t& anim = ctx.animation_trigger_context->anim;
 
         assert(wayland_ctx._local_copy_config != nullptr);
         assert(anim.shm != nullptr);
         const config::config_t& current_config = *wayland_ctx._local_copy_config.ptr;
         const animation_shared_memory_t& anim_shm = *anim.shm;
 
-        assert(wayland_ctx_shm->current_buffer_index >= 0);
-        assert(platform::wayland::WAYLAND_NUM_BUFFERS <= INT_MAX);
-        const int next_buffer_index = (wayland_ctx_shm->current_buffer_index + 1) % static_cast<int>(platform::wayland::WAYLAND_NUM_BUFFERS);
-        platform::wayland::wayland_shm_buffer_t *shm_buffer = &wayland_ctx_shm->buffers[next_buffer_index];
+        sprite_frame_t ret;
+        ret.frame = read_animation_frame(anim._published_frame);
+        const int anim_index = ret.frame.anim_index;
+        switch (ret.frame.anim_type) {
+            case config::config_animation_type_t::None:
+                break;
+            case config::config_animation_type_t::Bongocat: {
+#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
+                const animation_t& cat_anim = anim_shm.bongocat_anims[anim_index];
+                const generic_sprite_sheet_animation_t& sheet = cat_anim.sprite_sheet;
+                if (sheet.frame_width > 0 && sheet.frame_height > 0) {
+                    ret.sheet = &sheet;
+                    ret.frame_width = sheet.frame_width;
+                    ret.frame_height = sheet.frame_height;
+                    ret.rect = get_position(wayland_ctx, sheet, current_config);
+                }
+#endif
+            }break;
+            case config::config_animation_type_t::Digimon: {
+#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
+                const animation_t& dm_anim = anim_shm.dm_anims[anim_index];
+                const generic_sprite_sheet_animation_t& sheet = dm_anim.sprite_sheet;
+                if (sheet.frame_width > 0 && sheet.frame_height > 0) {
+                    ret.sheet = &sheet;
+                    ret.frame_width = sheet.frame_width;
+                    ret.frame_height = sheet.frame_height;
+                    ret.rect = get_position(wayland_ctx, sheet, current_config);
+                }
+#endif
+            }break;
+            case config::config_animation_type_t::MsPet:{
+#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
+                const ms_pet_sprite_sheet_t& sheet = anim_shm.ms_anims[anim_index];
+                if (sheet.frame_width > 0 && sheet.frame_height > 0) {
+                    ret.ms_pet_sheet = &sheet;
+                    ret.frame_width = sheet.frame_width;
+                    ret.frame_height = sheet.frame_height;
+                    ret.rect = get_position(wayland_ctx, sheet, current_config);
+                }
+#endif
+            }break;
+        }
+        return ret;
+    }
 
-        uint8_t *pixels = shm_buffer->pixels.data;
-        const size_t pixels_size = shm_buffer->pixels._size_bytes;
+    /// @NOTE: rect is in target coordinates
+    static cat_rect_t draw_current_sprite(platform::wayland::wayland_session_t& ctx, const draw_target_t& target, const sprite_frame_t& sprite, const cat_rect_t& rect) {
+        if (sprite.sheet) {
+            return draw_sprite(ctx, target, rect, *sprite.sheet, sprite.frame);
+        }
+#ifndef FEATURE_INCLUDE_ONLY_BONGOCAT_EMBEDDED_ASSETS
+        if (sprite.ms_pet_sheet) {
+            return draw_sprite(ctx, target, rect, *sprite.ms_pet_sheet, sprite.frame);
+        }
+#endif
+        return {};
+    }
 
-        const sprite_sheet_animation_region_t* region = sheet.frames[anim_shm.animation_player_data.frame_index].valid
-                    ? &sheet.frames[anim_shm.animation_player_data.frame_index]
-                    : nullptr;
+    static platform::wayland::frame_key_t get_frame_key(const platform::wayland::wayland_session_t& ctx, const sprite_frame_t& sprite) {
+        const platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
 
-        auto [cat_x, cat_y, cat_width, cat_height] = get_position(wayland_ctx, sheet, current_config);
+        assert(wayland_ctx._local_copy_config != nullptr);
+        const config::config_t& current_config = *wayland_ctx._local_copy_config.ptr;
 
-        if (region) {
-            blit_image_scaled(pixels, pixels_size,
-                              wayland_ctx._screen_width, wayland_ctx._bar_height, BGRA_CHANNELS,
-                              sheet.pixels.data, sheet.pixels._size_bytes,  sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
-                              region->col * sheet.frame_width, region->row * sheet.frame_height,
-                              sheet.frame_width, sheet.frame_height,
-                              cat_x, cat_y, cat_width, cat_height,
-                              drawing_color_order_t::COLOR_ORDER_BGRA, drawing_color_order_t::COLOR_ORDER_RGBA);
+        platform::wayland::frame_key_t ret;
+        ret.fullscreen = wayland_ctx._fullscreen_detected;
+        ret.opacity = wayland_ctx._fullscreen_detected ? 0 : current_config.overlay_opacity;
+        ret.valid = true;
+        // sprite is hidden while fullscreen, animation state doesn't matter
+        if (!wayland_ctx._fullscreen_detected) {
+            ret.anim_type = sprite.frame.anim_type;
+            ret.anim_index = sprite.frame.anim_index;
+            ret.sprite_sheet_row = sprite.frame.animation_player_data.sprite_sheet_row;
+            ret.frame_index = sprite.frame.animation_player_data.frame_index;
+            ret.x = sprite.rect.x;
+            ret.y = sprite.rect.y;
+            ret.width = sprite.rect.width;
+            ret.height = sprite.rect.height;
         }
+        return ret;
     }
 
-#ifndef FEATURE_INCLUDE_ONLY_BONGOCAT_EMBEDDED_ASSETS
-    void draw_sprite(platform::wayland::wayland_session_t& ctx, const ms_pet_sprite_sheet_t& sheet, int col, int row) {
-        if (sheet.frame_width <= 0 || sheet.frame_height <= 0) {
-            return;
+    /// frame.done for the next commit of surface
+    static void request_frame_callback(platform::wayland::wayland_session_t& ctx, wl_surface *surface) {
+        platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+
+        platform::LockGuard guard (wayland_ctx._frame_cb_lock);
+        if (!atomic_load(&wayland_ctx._frame_pending) && !wayland_ctx._frame_cb) {
+            wayland_ctx._frame_cb = wl_surface_frame(surface);
+            wl_callback_add_listener(wayland_ctx._frame_cb, &frame_listener, &ctx);
+            atomic_store(&wayland_ctx._frame_pending, true);
+            BONGOCAT_LOG_VERBOSE("Set frame pending");
         }
+    }
+
+    /// every buffer is held by the compositor, re-render as soon as the first one comes back
+    static void drop_frame(platform::wayland::wayland_shared_memory_t& wayland_ctx_shm, platform::wayland::wayland_shm_buffer_t (&buffers)[platform::wayland::WAYLAND_NUM_BUFFERS]) {
+        [[maybe_unused]] const size_t dropped_frames = atomic_fetch_add(&wayland_ctx_shm.dropped_frames, 1) + 1;
+        if (platform::wayland::wayland_shm_buffer_t *oldest = platform::wayland::find_oldest_busy_buffer(buffers)) {
+            atomic_store(&oldest->pending, true);
+        }
+        BONGOCAT_LOG_VERBOSE("All buffers busy, skip drawing (dropped frames: %zu)", dropped_frames);
+    }
 
+    // sprite is drawn into its own (sprite sized) wl_subsurface, the layer surface only holds the background
+    static bool draw_bar_subsurface(platform::wayland::wayland_session_t& ctx) {
         platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
-        //animation_context_t& anim = ctx.animation_trigger_context->anim;
-        //animation_trigger_context_t *trigger_ctx = ctx.animation_trigger_context;
         platform::wayland::wayland_shared_memory_t *wayland_ctx_shm = wayland_ctx.ctx_shm.ptr;
 
+        // read-only
         assert(wayland_ctx._local_copy_config != nullptr);
-        //assert(anim.shm != nullptr);
         const config::config_t& current_config = *wayland_ctx._local_copy_config.ptr;
-        //const animation_shared_memory_t& anim_shm = *anim.shm;
 
+        assert(wayland_ctx.sprite_surface != nullptr);
+        assert(wayland_ctx.sprite_subsurface != nullptr);
         assert(wayland_ctx_shm->current_buffer_index >= 0);
-        assert(platform::wayland::WAYLAND_NUM_BUFFERS <= INT_MAX);
-        const int next_buffer_index = (wayland_ctx_shm->current_buffer_index + 1) % static_cast<int>(platform::wayland::WAYLAND_NUM_BUFFERS);
-        platform::wayland::wayland_shm_buffer_t *shm_buffer = &wayland_ctx_shm->buffers[next_buffer_index];
+        assert(static_cast<size_t>(wayland_ctx_shm->current_buffer_index) < platform::wayland::WAYLAND_NUM_BUFFERS);
 
-        uint8_t *pixels = shm_buffer->pixels.data;
-        const size_t pixels_size = shm_buffer->pixels._size_bytes;
+        bool commit_parent = false;
+        bool committed = false;
+
+        // background, only repainted after configure/opacity/fullscreen change (and config reload)
+        const bool full_redraw = atomic_load(&wayland_ctx_shm->buffers[wayland_ctx_shm->current_buffer_index].needs_full_redraw);
+        if (full_redraw) {
+            platform::wayland::wayland_shm_buffer_t *shm_buffer = platform::wayland::find_free_buffer(wayland_ctx_shm->buffers);
+            if (shm_buffer == nullptr) {
+                drop_frame(*wayland_ctx_shm, wayland_ctx_shm->buffers);
+                return false;
+            }
+
+            const int effective_opacity = wayland_ctx._fullscreen_detected ? 0 : current_config.overlay_opacity;
+            assert(effective_opacity >= 0);
+            const uint32_t fill = (static_cast<unsigned>(effective_opacity) << 24u); // RGBA, little-endian
+            const size_t total_pixels = static_cast<size_t>(wayland_ctx._screen_width) * static_cast<size_t>(wayland_ctx._bar_height);
+            if (total_pixels * sizeof(uint32_t) > shm_buffer->pixels._size_bytes) {
+                BONGOCAT_LOG_VERBOSE("draw_bar: pixel write would overflow buffer (expected %zu bytes, have %zu). Aborting draw.",
+                                     total_pixels * sizeof(uint32_t), shm_buffer->pixels._size_bytes);
+                return false;
+            }
+            auto *p = reinterpret_cast<uint32_t *>(shm_buffer->pixels.data);
+            for (size_t i = 0; i < total_pixels; i++) {
+                p[i] = fill;
+            }
+            atomic_store(&shm_buffer->needs_full_redraw, false);
+            shm_buffer->last_sprite_rect = {};
+
+            assert(shm_buffer->buffer);
+            assert(shm_buffer->index <= INT_MAX);
+            atomic_store(&shm_buffer->busy, true);
+            shm_buffer->committed_timestamp_us = platform::get_current_time_us();
+            wl_surface_attach(wayland_ctx.surface, shm_buffer->buffer, 0, 0);
+            wl_surface_damage_buffer(wayland_ctx.surface, 0, 0, wayland_ctx._screen_width, wayland_ctx._bar_height);
+            wayland_ctx_shm->current_buffer_index = static_cast<int>(shm_buffer->index);
+            commit_parent = true;
+        }
+
+        // sprite
+        const bool use_viewport = wayland_ctx.sprite_viewport != nullptr;
+        platform::wayland::wayland_shm_buffer_t *sprite_buffer = nullptr;
+        cat_rect_t sprite_rect{};
+        cat_rect_t sprite_buffer_rect{};
+        animation_frame_snapshot_t sprite_frame{};
+        platform::wayland::frame_key_t frame_key;
+        bool sprite_unchanged = false;
+        bool sprite_dropped = false;
+        bool sprite_failed = false;
+        do {
+            const sprite_frame_t sprite = !wayland_ctx._fullscreen_detected ? get_current_sprite(ctx) : sprite_frame_t{};
+            frame_key = get_frame_key(ctx, sprite);
+            // same frame is already presented, unless a full redraw is pending (settings outside the key changed)
+            if (!full_redraw && frame_key == wayland_ctx._last_frame_key) {
+                sprite_unchanged = true;
+                break;
+            }
+            if (wayland_ctx._fullscreen_detected) {
+                BONGOCAT_LOG_VERBOSE("fullscreen detected, skip drawing, hide sprite");
+                break;
+            }
+            if (sprite.rect.width <= 0 || sprite.rect.height <= 0) {
+                break;
+            }
+
+            // with wp_viewporter the buffer keeps the unscaled frame, the compositor scales it to the sprite rect
+            const int buffer_width = use_viewport ? sprite.frame_width : sprite.rect.width;
+            const int buffer_height = use_viewport ? sprite.frame_height : sprite.rect.height;
+            if (buffer_width != wayland_ctx_shm->sprite_buffer_width || buffer_height != wayland_ctx_shm->sprite_buffer_height) {
+                if (platform::wayland::setup_sprite_buffers(wayland_ctx, *ctx.animation_trigger_context, buffer_width, buffer_height) != bongocat_error_t::BONGOCAT_SUCCESS) {
+                    sprite_failed = true;
+                    break;
+                }
+            }
+            sprite_buffer = platform::wayland::find_free_buffer(wayland_ctx_shm->sprite_buffers);
+            if (sprite_buffer == nullptr) {
+                sprite_dropped = true;
+                break;
+            }
+
+            // sprite buffer is tiny, always redraw all of it
+            memset(sprite_buffer->pixels.data, 0, sprite_buffer->pixels._size_bytes);
+            const draw_target_t target = { .pixels = sprite_buffer->pixels.data, .pixels_size = sprite_buffer->pixels._size_bytes,
+                                           .width = buffer_width, .height = buffer_height };
+            draw_current_sprite(ctx, target, sprite, { .x = 0, .y = 0, .width = buffer_width, .height = buffer_height });
+            sprite_rect = sprite.rect;
+            sprite_buffer_rect = { .x = 0, .y = 0, .width = buffer_width, .height = buffer_height };
+            sprite_frame = sprite.frame;
+        } while (false);
 
-        auto [cat_x, cat_y, cat_width, cat_height] = get_position(wayland_ctx, sheet, current_config);
+        if (sprite_unchanged) {
+            // same frame is already on the sprite surface
+        } else if (sprite_dropped) {
+            drop_frame(*wayland_ctx_shm, wayland_ctx_shm->sprite_buffers);
+        } else if (sprite_buffer != nullptr) {
+            if (!wayland_ctx._sprite_visible || sprite_rect.x != wayland_ctx._sprite_x || sprite_rect.y != wayland_ctx._sprite_y) {
+                // subsurface position is state of the parent, gets applied with the next parent commit
+                wl_subsurface_set_position(wayland_ctx.sprite_subsurface, sprite_rect.x, sprite_rect.y);
+                wayland_ctx._sprite_x = sprite_rect.x;
+                wayland_ctx._sprite_y = sprite_rect.y;
+                commit_parent = true;
+            }
 
-        blit_image_scaled(pixels, pixels_size,
-                          wayland_ctx._screen_width, wayland_ctx._bar_height, BGRA_CHANNELS,
-                          sheet.pixels.data, sheet.pixels._size_bytes,  sheet.sprite_sheet_width, sheet.sprite_sheet_height, sheet.channels,
-                          col * sheet.frame_width, row * sheet.frame_height,
-                          sheet.frame_width, sheet.frame_height,
-                          cat_x, cat_y, cat_width, cat_height,
-                          drawing_color_order_t::COLOR_ORDER_BGRA, drawing_color_order_t::COLOR_ORDER_RGBA);
+            assert(sprite_buffer->buffer);
+            atomic_store(&sprite_buffer->busy, true);
+            sprite_buffer->committed_timestamp_us = platform::get_current_time_us();
+            if (use_viewport && (sprite_rect.width != wayland_ctx._sprite_viewport_width || sprite_rect.height != wayland_ctx._sprite_viewport_height)) {
+                // surface state, gets applied with the sprite commit below
+                wp_viewport_set_destination(wayland_ctx.sprite_viewport, sprite_rect.width, sprite_rect.height);
+                wayland_ctx._sprite_viewport_width = sprite_rect.width;
+                wayland_ctx._sprite_viewport_height = sprite_rect.height;
+            }
+            wl_surface_attach(wayland_ctx.sprite_surface, sprite_buffer->buffer, 0, 0);
+            wl_surface_damage_buffer(wayland_ctx.sprite_surface, 0, 0, sprite_buffer_rect.width, sprite_buffer_rect.height);
+            request_frame_callback(ctx, wayland_ctx.sprite_surface);
+            request_frame_latency(ctx, wayland_ctx.sprite_surface, sprite_frame);
+            wl_surface_commit(wayland_ctx.sprite_surface);
+            wayland_ctx._sprite_visible = true;
+            wayland_ctx._last_frame_key = frame_key;
+            committed = true;
+        } else {
+            if (wayland_ctx._sprite_visible) {
+                // nothing to show (fullscreen, no animation), unmap sprite surface
+                wl_surface_attach(wayland_ctx.sprite_surface, nullptr, 0, 0);
+                wl_surface_commit(wayland_ctx.sprite_surface);
+                wayland_ctx._sprite_visible = false;
+                committed = true;
+            }
+            // retry next frame when the sprite buffers couldn't be created
+            wayland_ctx._last_frame_key = sprite_failed ? platform::wayland::frame_key_t{} : frame_key;
+        }
+
+        if (commit_parent) {
+            // pipeline is suspended while fullscreen, the empty frame doesn't need a frame callback
+            if (!wayland_ctx._fullscreen_detected) {
+                request_frame_callback(ctx, wayland_ctx.surface);
+            }
+            wl_surface_commit(wayland_ctx.surface);
+            committed = true;
+        }
+
+        if (!committed && sprite_unchanged) {
+            atomic_fetch_add(&wayland_ctx_shm->skipped_commits, 1);
+            BONGOCAT_LOG_VERBOSE("Frame unchanged, skip commit");
+        }
+
+        return committed;
     }
-#endif
 
     bool draw_bar(platform::wayland::wayland_session_t& ctx) {
         platform::wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
@@ -210,24 +725,38 @@ namespace bongocat::animation {
         assert(wayland_ctx._local_copy_config != nullptr);
         assert(anim.shm != nullptr);
         const config::config_t& current_config = *wayland_ctx._local_copy_config.ptr;
-        const animation_shared_memory_t& anim_shm = *anim.shm;
 
         if (!atomic_load(&wayland_ctx_shm->configured)) {
             BONGOCAT_LOG_VERBOSE("Surface not configured yet, skipping draw");
             return false;
         }
 
+        if (wayland_ctx.sprite_subsurface != nullptr) {
+            return draw_bar_subsurface(ctx);
+        }
+
         assert(wayland_ctx_shm->current_buffer_index >= 0);
         assert(platform::wayland::WAYLAND_NUM_BUFFERS <= INT_MAX);
-        const int next_buffer_index = (wayland_ctx_shm->current_buffer_index + 1) % static_cast<int>(platform::wayland::WAYLAND_NUM_BUFFERS);
-        platform::wayland::wayland_shm_buffer_t *shm_buffer = &wayland_ctx_shm->buffers[next_buffer_index];
+        assert(static_cast<size_t>(wayland_ctx_shm->current_buffer_index) < platform::wayland::WAYLAND_NUM_BUFFERS);
+        const platform::wayland::wayland_shm_buffer_t& front_buffer = wayland_ctx_shm->buffers[wayland_ctx_shm->current_buffer_index];
+
+        // same frame is already presented, skip clear, blit and commit
+        if (!atomic_load(&front_buffer.needs_full_redraw)) {
+            const sprite_frame_t sprite = !wayland_ctx._fullscreen_detected ? get_current_sprite(ctx) : sprite_frame_t{};
+            if (get_frame_key(ctx, sprite) == wayland_ctx._last_frame_key) {
+                atomic_fetch_add(&wayland_ctx_shm->skipped_commits, 1);
+                BONGOCAT_LOG_VERBOSE("Frame unchanged, skip commit");
+                return false;
+            }
+        }
 
-        if (atomic_load(&shm_buffer->busy)) {
-            BONGOCAT_LOG_VERBOSE("Buffer still busy, skip drawing: buffer: %i", next_buffer_index);
-            atomic_store(&shm_buffer->pending, true);
+        platform::wayland::wayland_shm_buffer_t *shm_buffer = platform::wayland::find_free_buffer(wayland_ctx_shm->buffers);
+        if (shm_buffer == nullptr) {
+            drop_frame(*wayland_ctx_shm, wayland_ctx_shm->buffers);
             return false;
         }
-
+        assert(shm_buffer->index <= INT_MAX);
+        const int next_buffer_index = static_cast<int>(shm_buffer->index);
 
         uint8_t *pixels = shm_buffer->pixels.data;
         const size_t pixels_size = shm_buffer->pixels._size_bytes;
@@ -238,9 +767,7 @@ namespace bongocat::animation {
         assert(wayland_ctx._bar_height >= 0);
         assert(effective_opacity >= 0);
 
-        // Fast clear with 32-bit fill
         const uint32_t fill = (static_cast<unsigned>(effective_opacity) << 24u); // RGBA, little-endian
-        auto *p = reinterpret_cast<uint32_t *>(pixels);
         const size_t total_pixels = static_cast<size_t>(wayland_ctx._screen_width) * static_cast<size_t>(wayland_ctx._bar_height);
         if (current_config.enable_debug) {
             if (const size_t expected_bytes = total_pixels * sizeof(uint32_t); expected_bytes > pixels_size) {
@@ -249,63 +776,73 @@ namespace bongocat::animation {
                 return false;
             }
         }
-        for (size_t i = 0; i < total_pixels; i++) {
-            p[i] = fill;
+
+        // Damage tracking: only the last sprite area of this buffer differs from the background,
+        // clear that area (or everything after configure/opacity/fullscreen change) and damage old + new sprite area.
+        // A reused buffer can be a few frames behind the front buffer, the background is one solid fill,
+        // so bringing it forward is the same as clearing its own stale sprite area; the front buffer's sprite area is damaged too
+        const bool full_redraw = atomic_exchange(&shm_buffer->needs_full_redraw, false);
+        const cat_rect_t full_rect = { .x = 0, .y = 0, .width = wayland_ctx._screen_width, .height = wayland_ctx._bar_height };
+        const cat_rect_t old_rect = full_redraw
+            ? full_rect
+            : clip_rect({ .x = shm_buffer->last_sprite_rect.x, .y = shm_buffer->last_sprite_rect.y, .width = shm_buffer->last_sprite_rect.width, .height = shm_buffer->last_sprite_rect.height },
+                        wayland_ctx._screen_width, wayland_ctx._bar_height);
+        if (full_redraw) {
+            // Fast clear with 32-bit fill
+            auto *p = reinterpret_cast<uint32_t *>(pixels);
+            for (size_t i = 0; i < total_pixels; i++) {
+                p[i] = fill;
+            }
+        } else {
+            clear_rect(pixels, wayland_ctx._screen_width, old_rect, fill);
         }
 
+        cat_rect_t sprite_rect{};
+        animation_frame_snapshot_t sprite_frame{};
         do {
-            platform::LockGuard guard (anim.anim_lock);
-
+            // animation may have moved on since the check above, key what actually gets drawn
+            const sprite_frame_t sprite = !wayland_ctx._fullscreen_detected ? get_current_sprite(ctx) : sprite_frame_t{};
+            wayland_ctx._last_frame_key = get_frame_key(ctx, sprite);
+            sprite_frame = sprite.frame;
             if (!wayland_ctx._fullscreen_detected) {
-                switch (anim_shm.anim_type) {
-                    case config::config_animation_type_t::None:
-                        break;
-                    case config::config_animation_type_t::Bongocat: {
-#ifdef FEATURE_BONGOCAT_EMBEDDED_ASSETS
-                        const animation_t& cat_anim = anim_shm.bongocat_anims[anim_shm.anim_index];
-                        const generic_sprite_sheet_animation_t& sheet = cat_anim.sprite_sheet;
-                        draw_sprite(ctx, sheet);
-#endif
-                    }break;
-                    case config::config_animation_type_t::Digimon: {
-#ifdef FEATURE_DIGIMON_EMBEDDED_ASSETS
-                        const animation_t& dm_anim = anim_shm.dm_anims[anim_shm.anim_index];
-                        const generic_sprite_sheet_animation_t& sheet = dm_anim.sprite_sheet;
-                        draw_sprite(ctx, sheet);
-#endif
-                    }break;
-                    case config::config_animation_type_t::MsPet:{
-#ifdef FEATURE_CLIPPY_EMBEDDED_ASSETS
-                        const ms_pet_sprite_sheet_t& sheet = anim_shm.ms_anims[anim_shm.anim_index];
-                        const int col = anim_shm.animation_player_data.frame_index;
-                        const int row = anim_shm.animation_player_data.sprite_sheet_row;
-                        draw_sprite(ctx, sheet, col, row);
-#endif
-                    }break;
-                }
+                const draw_target_t target = { .pixels = pixels, .pixels_size = pixels_size,
+                                               .width = wayland_ctx._screen_width, .height = wayland_ctx._bar_height };
+                sprite_rect = draw_current_sprite(ctx, target, sprite, sprite.rect);
             } else {
                 BONGOCAT_LOG_VERBOSE("fullscreen detected, skip drawing, keep buffer clean");
             }
         } while (false);
 
+        sprite_rect = clip_rect(sprite_rect, wayland_ctx._screen_width, wayland_ctx._bar_height);
+        const cat_rect_t front_rect = clip_rect({ .x = front_buffer.last_sprite_rect.x, .y = front_buffer.last_sprite_rect.y, .width = front_buffer.last_sprite_rect.width, .height = front_buffer.last_sprite_rect.height },
+                                                wayland_ctx._screen_width, wayland_ctx._bar_height);
+        const cat_rect_t damage_rect = union_rect(union_rect(old_rect, front_rect), sprite_rect);
+        shm_buffer->last_sprite_rect = { .x = sprite_rect.x, .y = sprite_rect.y, .width = sprite_rect.width, .height = sprite_rect.height };
+
+        if (wayland_ctx._headless) {
+            // offscreen, nothing holds the buffer after drawing (frame dump reads the front buffer, see headless::run)
+            shm_buffer->committed_timestamp_us = platform::get_current_time_us();
+            shm_buffer->released_timestamp_us = shm_buffer->committed_timestamp_us;
+            wayland_ctx_shm->current_buffer_index = next_buffer_index;
+            return true;
+        }
+
         assert(shm_buffer->buffer);
 
         atomic_store(&shm_buffer->busy, true);
+        shm_buffer->committed_timestamp_us = platform::get_current_time_us();
         wl_surface_attach(wayland_ctx.surface, shm_buffer->buffer, 0, 0);
-        wl_surface_damage_buffer(wayland_ctx.surface, 0, 0, wayland_ctx._screen_width, wayland_ctx._bar_height);
+        if (damage_rect.width > 0 && damage_rect.height > 0) {
+            wl_surface_damage_buffer(wayland_ctx.surface, damage_rect.x, damage_rect.y, damage_rect.width, damage_rect.height);
+        }
+        // pipeline is suspended while fullscreen, the empty frame doesn't need a frame callback
+        if (!wayland_ctx._fullscreen_detected) {
+            request_frame_callback(ctx, wayland_ctx.surface);
+        }
+        request_frame_latency(ctx, wayland_ctx.surface, sprite_frame);
         wl_surface_commit(wayland_ctx.surface);
         wayland_ctx_shm->current_buffer_index = next_buffer_index;
 
-        do {
-            platform::LockGuard guard (wayland_ctx._frame_cb_lock);
-            if (!atomic_load(&wayland_ctx._frame_pending) && !wayland_ctx._frame_cb) {
-                wayland_ctx._frame_cb = wl_surface_frame(wayland_ctx.surface);
-                wl_callback_add_listener(wayland_ctx._frame_cb, &frame_listener, &ctx);
-                atomic_store(&wayland_ctx._frame_pending, true);
-                BONGOCAT_LOG_VERBOSE("Set frame pending");
-            }
-        } while (false);
-
         return true;
     }
 }
\ No newline at end of file
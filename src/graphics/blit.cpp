@@ -0,0 +1,156 @@
+#include "blit.h"
+#include <cstring>
+#include <cstddef>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace bongocat::animation {
+    // SIMD kernels test the alpha threshold with the sign bit of the pixel (alpha >= 128)
+    static_assert(THRESHOLD_ALPHA == 127);
+
+    // =============================================================================
+    // SCALAR KERNEL
+    // =============================================================================
+
+    static void blit_row_rgba_to_bgra_scalar(uint8_t *dest, const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x, int count) {
+        for (int i = 0; i < count; i++) {
+            const uint8_t *src_pixel = src_row + static_cast<size_t>(sx_fixed >> FIXED_SHIFT) * 4;
+            if (src_pixel[3] > THRESHOLD_ALPHA) {
+                dest[0] = src_pixel[2];
+                dest[1] = src_pixel[1];
+                dest[2] = src_pixel[0];
+                dest[3] = src_pixel[3];
+            }
+            dest += 4;
+            sx_fixed += inc_x;
+        }
+    }
+
+    // =============================================================================
+    // X86 KERNELS
+    // =============================================================================
+
+#if defined(__x86_64__)
+    // SSE2 is baseline for x86_64, no gather/pshufb: load lanes one by one, swap R/B with shifts
+    static inline __m128i blit_load4_sse2(const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x) {
+        uint32_t p[4];
+        for (int l = 0; l < 4; l++) {
+            memcpy(&p[l], src_row + static_cast<size_t>((sx_fixed + l * inc_x) >> FIXED_SHIFT) * 4, sizeof(uint32_t));
+        }
+        return _mm_setr_epi32(static_cast<int>(p[0]), static_cast<int>(p[1]), static_cast<int>(p[2]), static_cast<int>(p[3]));
+    }
+    static inline void blit_store4_sse2(uint8_t *dest, __m128i px) {
+        const __m128i mask_ag = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+        const __m128i mask_lo = _mm_set1_epi32(0x000000FF);
+        const __m128i r = _mm_and_si128(px, mask_lo);
+        const __m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), mask_lo);
+        const __m128i bgra = _mm_or_si128(_mm_and_si128(px, mask_ag), _mm_or_si128(_mm_slli_epi32(r, 16), b));
+        const __m128i mask = _mm_srai_epi32(px, 31);
+
+        auto *d = reinterpret_cast<__m128i *>(dest);
+        const __m128i old = _mm_loadu_si128(d);
+        _mm_storeu_si128(d, _mm_or_si128(_mm_and_si128(mask, bgra), _mm_andnot_si128(mask, old)));
+    }
+    static void blit_row_rgba_to_bgra_sse2(uint8_t *dest, const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x, int count) {
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m128i lo = blit_load4_sse2(src_row, sx_fixed, inc_x);
+            const __m128i hi = blit_load4_sse2(src_row, sx_fixed + 4 * inc_x, inc_x);
+            blit_store4_sse2(dest + static_cast<size_t>(i) * 4, lo);
+            blit_store4_sse2(dest + static_cast<size_t>(i + 4) * 4, hi);
+            sx_fixed += 8 * inc_x;
+        }
+        blit_row_rgba_to_bgra_scalar(dest + static_cast<size_t>(i) * 4, src_row, sx_fixed, inc_x, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    static void blit_row_rgba_to_bgra_avx2(uint8_t *dest, const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x, int count) {
+        const __m256i swizzle = _mm256_setr_epi8(2, 1, 0, 3,  6, 5, 4, 7,  10, 9, 8, 11,  14, 13, 12, 15,
+                                                 2, 1, 0, 3,  6, 5, 4, 7,  10, 9, 8, 11,  14, 13, 12, 15);
+        const __m256i step = _mm256_set1_epi32(8 * inc_x);
+        __m256i sx = _mm256_add_epi32(_mm256_set1_epi32(sx_fixed),
+                                      _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(inc_x)));
+        const auto *src32 = reinterpret_cast<const int *>(src_row);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            const __m256i px = _mm256_i32gather_epi32(src32, _mm256_srli_epi32(sx, FIXED_SHIFT), 4);
+            const __m256i bgra = _mm256_shuffle_epi8(px, swizzle);
+            const __m256i mask = _mm256_srai_epi32(px, 31);
+
+            auto *d = reinterpret_cast<__m256i *>(dest + static_cast<size_t>(i) * 4);
+            const __m256i old = _mm256_loadu_si256(d);
+            _mm256_storeu_si256(d, _mm256_blendv_epi8(old, bgra, mask));
+            sx = _mm256_add_epi32(sx, step);
+        }
+        blit_row_rgba_to_bgra_scalar(dest + static_cast<size_t>(i) * 4, src_row, sx_fixed + i * inc_x, inc_x, count - i);
+    }
+#endif
+
+    // =============================================================================
+    // ARM KERNELS
+    // =============================================================================
+
+#if defined(__aarch64__)
+    // NEON is baseline for aarch64, no gather: load lanes one by one, swap R/B with a table lookup
+    static void blit_row_rgba_to_bgra_neon(uint8_t *dest, const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x, int count) {
+        static constexpr uint8_t SWIZZLE[16] = { 2, 1, 0, 3,  6, 5, 4, 7,  10, 9, 8, 11,  14, 13, 12, 15 };
+        const uint8x16_t swizzle = vld1q_u8(SWIZZLE);
+
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            uint32_t p[8];
+            for (int l = 0; l < 8; l++) {
+                memcpy(&p[l], src_row + static_cast<size_t>((sx_fixed + l * inc_x) >> FIXED_SHIFT) * 4, sizeof(uint32_t));
+            }
+            for (int h = 0; h < 2; h++) {
+                const uint32x4_t px = vld1q_u32(p + h * 4);
+                const uint32x4_t bgra = vreinterpretq_u32_u8(vqtbl1q_u8(vreinterpretq_u8_u32(px), swizzle));
+                const uint32x4_t mask = vcltzq_s32(vreinterpretq_s32_u32(px));
+
+                auto *d = reinterpret_cast<uint32_t *>(dest + static_cast<size_t>(i + h * 4) * 4);
+                vst1q_u32(d, vbslq_u32(mask, bgra, vld1q_u32(d)));
+            }
+            sx_fixed += 8 * inc_x;
+        }
+        blit_row_rgba_to_bgra_scalar(dest + static_cast<size_t>(i) * 4, src_row, sx_fixed, inc_x, count - i);
+    }
+#endif
+
+    // =============================================================================
+    // CPU DISPATCH
+    // =============================================================================
+
+    static blit_row_rgba_to_bgra_func_t g_blit_row_rgba_to_bgra = blit_row_rgba_to_bgra_scalar;
+    static const char *g_blit_kernel_name = "scalar";
+
+    void blit_select_kernel() {
+#if defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            g_blit_row_rgba_to_bgra = blit_row_rgba_to_bgra_avx2;
+            g_blit_kernel_name = "avx2";
+        } else {
+            g_blit_row_rgba_to_bgra = blit_row_rgba_to_bgra_sse2;
+            g_blit_kernel_name = "sse2";
+        }
+#elif defined(__aarch64__)
+        g_blit_row_rgba_to_bgra = blit_row_rgba_to_bgra_neon;
+        g_blit_kernel_name = "neon";
+#else
+        g_blit_row_rgba_to_bgra = blit_row_rgba_to_bgra_scalar;
+        g_blit_kernel_name = "scalar";
+#endif
+    }
+
+    blit_row_rgba_to_bgra_func_t blit_get_row_rgba_to_bgra() {
+        return g_blit_row_rgba_to_bgra;
+    }
+
+    const char* blit_get_kernel_name() {
+        return g_blit_kernel_name;
+    }
+}
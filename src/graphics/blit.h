@@ -0,0 +1,24 @@
+#ifndef BONGOCAT_ANIMATION_BLIT_H
+#define BONGOCAT_ANIMATION_BLIT_H
+
+#include <cstdint>
+
+namespace bongocat::animation {
+    inline static constexpr uint8_t THRESHOLD_ALPHA = 127;
+
+    inline static constexpr unsigned int FIXED_SHIFT = 16;
+    inline static constexpr unsigned int FIXED_ONE   = (1u << FIXED_SHIFT);
+
+    /// nearest-neighbour row kernel:
+    /// sample `count` RGBA pixels from src_row (16.16 fixed point, starting at sx_fixed, stepping inc_x),
+    /// swizzle into BGRA (WL_SHM_FORMAT_ARGB8888) and store every pixel with alpha > THRESHOLD_ALPHA into dest.
+    /// @NOTE: caller must make sure every sampled pixel is inside src_row
+    using blit_row_rgba_to_bgra_func_t = void (*)(uint8_t *dest, const uint8_t *src_row, int32_t sx_fixed, int32_t inc_x, int count);
+
+    /// pick the best row kernel for the running CPU (call once at startup, before any drawing thread is started)
+    void blit_select_kernel();
+    blit_row_rgba_to_bgra_func_t blit_get_row_rgba_to_bgra();
+    const char* blit_get_kernel_name();
+}
+
+#endif // BONGOCAT_ANIMATION_BLIT_H
@@ -5,6 +5,7 @@
 #include "graphics/animation_context.h"
 #include "graphics/animation.h"
 #include "utils/memory.h"
+#include "blit.h"
 #include <pthread.h>
 #include <cassert>
 
@@ -30,12 +31,6 @@
 #endif
 
 namespace bongocat::animation {
-    // =============================================================================
-    // GLOBAL STATE AND CONFIGURATION
-    // =============================================================================
-
-    static inline constexpr uint8_t THRESHOLD_ALPHA = 127;
-
     // =============================================================================
     // DRAWING OPERATIONS MODULE
     // =============================================================================
@@ -50,51 +45,223 @@ namespace bongocat::animation {
         return v ^ (invert ? 0xFF : 0x00); // branchless invert
     }
 
-    static void drawing_copy_pixel(uint8_t *dest, int dest_channels, int dest_idx,
-                                   const unsigned char *src, int src_channels, int src_idx,
-                                   drawing_copy_pixel_color_option_t option,
-                                   drawing_color_order_t dest_order,
-                                   drawing_color_order_t src_order)
-    {
-        const bool invert = option == drawing_copy_pixel_color_option_t::COPY_PIXEL_OPTION_INVERT;
+    // copy one pixel, formats are template parameters: no per-pixel format branches (see dispatch in copy_sprite_frame/select_blit_rows)
+    template <int DestChannels, int SrcChannels, drawing_color_order_t DestOrder, drawing_color_order_t SrcOrder, bool Invert>
+    static inline void drawing_copy_pixel(uint8_t *dest, const uint8_t *src) {
+        static_assert(DestChannels >= 1 && DestChannels <= 4);
+        static_assert(SrcChannels >= 1 && SrcChannels <= 4);
 
         // Map source channel indices for RGB
-        const int sr = (src_order == drawing_color_order_t::COLOR_ORDER_RGBA) ? 0 : 2;
-        const int sg = 1;
-        const int sb = (src_order == drawing_color_order_t::COLOR_ORDER_RGBA) ? 2 : 0;
+        constexpr int sr = (SrcOrder == drawing_color_order_t::COLOR_ORDER_RGBA) ? 0 : 2;
+        constexpr int sg = 1;
+        constexpr int sb = (SrcOrder == drawing_color_order_t::COLOR_ORDER_RGBA) ? 2 : 0;
 
-        // Load into RGBA without branches
         uint8_t r, g, b, a;
-        if (src_channels == 1) {
+        if constexpr (SrcChannels == 1) {
             // 1-channel grayscale -> fill all channels with 0/255
-            uint8_t v = src[src_idx] ? 255 : 0;
-            v = apply_invert(v, invert);
+            const uint8_t v = apply_invert(src[0] ? 255 : 0, Invert);
             r = g = b = a = v;
-        }
-        else if (src_channels == 2) {
+        } else if constexpr (SrcChannels == 2) {
             // 2-channel grayscale + alpha (alpha ignored in original)
-            const uint8_t gray = apply_invert(src[src_idx], invert);
+            const uint8_t gray = apply_invert(src[0], Invert);
             r = g = b = gray;
             a = 255;
-        }
-        else {
+        } else {
             // RGB / RGBA
-            r = apply_invert(src[src_idx + sr], invert);
-            g = apply_invert(src[src_idx + sg], invert);
-            b = apply_invert(src[src_idx + sb], invert);
-            a = (src_channels >= 4) ? src[src_idx + 3] : 255; // Alpha not inverted
+            r = apply_invert(src[sr], Invert);
+            g = apply_invert(src[sg], Invert);
+            b = apply_invert(src[sb], Invert);
+            if constexpr (SrcChannels >= 4) {
+                a = src[3]; // Alpha not inverted
+            } else {
+                a = 255;
+            }
         }
 
         // Map destination channel indices
-        const int dr = (dest_order == drawing_color_order_t::COLOR_ORDER_RGBA) ? 0 : 2;
+        constexpr int dr = (DestOrder == drawing_color_order_t::COLOR_ORDER_RGBA) ? 0 : 2;
         constexpr int dg = 1;
-        const int db = (dest_order == drawing_color_order_t::COLOR_ORDER_RGBA) ? 2 : 0;
+        constexpr int db = (DestOrder == drawing_color_order_t::COLOR_ORDER_RGBA) ? 2 : 0;
+
+        if constexpr (DestChannels >= 1) dest[dr] = r;
+        if constexpr (DestChannels >= 2) dest[dg] = g;
+        if constexpr (DestChannels >= 3) dest[db] = b;
+        if constexpr (DestChannels >= 4) dest[3]  = a;
+    }
+
+    // copy one sprite sheet frame (RGBA) into the (padded) destination sheet, returns true when any pixel was copied
+    template <bool Invert>
+    static bool copy_sprite_frame(uint8_t *dest_pixels, size_t dest_pixels_size, int dest_pixels_width, int dst_x, int dst_y,
+                                  const uint8_t *src_pixels, size_t src_pixels_size, int src_pixels_width, int src_x, int src_y,
+                                  int frame_width, int frame_height) {
+        constexpr int channels = RGBA_CHANNELS;
+        bool copied = false;
+        for (int fy = 0; fy < frame_height; fy++) {
+            for (int fx = 0; fx < frame_width; fx++) {
+                const auto src_px_idx = ((src_y + fy) * src_pixels_width + (src_x + fx)) * channels;
+                const auto dst_px_idx = ((dst_y + fy) * dest_pixels_width + (dst_x + fx)) * channels;
+
+                if (src_px_idx >= 0 && dst_px_idx >= 0 &&
+                    static_cast<size_t>(src_px_idx) < src_pixels_size &&
+                    static_cast<size_t>(dst_px_idx) < dest_pixels_size) {
+                    drawing_copy_pixel<channels, channels, drawing_color_order_t::COLOR_ORDER_RGBA, drawing_color_order_t::COLOR_ORDER_RGBA, Invert>(
+                        dest_pixels + dst_px_idx, src_pixels + src_px_idx);
+                    copied = true;
+                }
+            }
+        }
+        return copied;
+    }
+    static bool copy_sprite_frame(drawing_copy_pixel_color_option_t option,
+                                  uint8_t *dest_pixels, size_t dest_pixels_size, int dest_pixels_width, int dst_x, int dst_y,
+                                  const uint8_t *src_pixels, size_t src_pixels_size, int src_pixels_width, int src_x, int src_y,
+                                  int frame_width, int frame_height) {
+        if (option == drawing_copy_pixel_color_option_t::COPY_PIXEL_OPTION_INVERT) {
+            return copy_sprite_frame<true>(dest_pixels, dest_pixels_size, dest_pixels_width, dst_x, dst_y,
+                                           src_pixels, src_pixels_size, src_pixels_width, src_x, src_y, frame_width, frame_height);
+        }
+        return copy_sprite_frame<false>(dest_pixels, dest_pixels_size, dest_pixels_width, dst_x, dst_y,
+                                        src_pixels, src_pixels_size, src_pixels_width, src_x, src_y, frame_width, frame_height);
+    }
+
+    // build opaque runs (alpha > THRESHOLD_ALPHA) per row of an RGBA sprite sheet, blit_image_scaled only samples inside these runs
+    static bongocat_error_t build_sprite_sheet_spans(sprite_sheet_spans_t& out_spans, const uint8_t *pixels, size_t pixels_size, int width, int height, int channels) {
+        cleanup_sprite_sheet_spans(out_spans);
+        if (!pixels || width <= 0 || height <= 0 || channels != RGBA_CHANNELS) {
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+        const size_t row_bytes = static_cast<size_t>(width) * RGBA_CHANNELS;
+        if (row_bytes * static_cast<size_t>(height) > pixels_size) {
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+
+        // first pass: count runs
+        size_t spans_count = 0;
+        for (int y = 0; y < height; y++) {
+            const uint8_t *row = pixels + static_cast<size_t>(y) * row_bytes;
+            bool opaque = false;
+            for (int x = 0; x < width; x++) {
+                const bool px_opaque = row[static_cast<size_t>(x) * RGBA_CHANNELS + 3] > THRESHOLD_ALPHA;
+                if (px_opaque && !opaque) {
+                    spans_count++;
+                }
+                opaque = px_opaque;
+            }
+        }
+        if (spans_count > UINT32_MAX) {
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+
+        out_spans.row_offsets = make_allocated_array<uint32_t>(static_cast<size_t>(height) + 1);
+        if (!out_spans.row_offsets) {
+            return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+        }
+        if (spans_count > 0) {
+            out_spans.spans = make_allocated_array<sprite_sheet_span_t>(spans_count);
+            if (!out_spans.spans) {
+                cleanup_sprite_sheet_spans(out_spans);
+                return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+            }
+        }
+
+        // second pass: fill runs
+        uint32_t span_index = 0;
+        for (int y = 0; y < height; y++) {
+            const uint8_t *row = pixels + static_cast<size_t>(y) * row_bytes;
+            out_spans.row_offsets[static_cast<size_t>(y)] = span_index;
+            int x = 0;
+            while (x < width) {
+                while (x < width && row[static_cast<size_t>(x) * RGBA_CHANNELS + 3] <= THRESHOLD_ALPHA) x++;
+                const int start = x;
+                while (x < width && row[static_cast<size_t>(x) * RGBA_CHANNELS + 3] > THRESHOLD_ALPHA) x++;
+                if (x > start) {
+                    out_spans.spans[span_index] = { .start = start, .length = x - start };
+                    span_index++;
+                }
+            }
+        }
+        out_spans.row_offsets[static_cast<size_t>(height)] = span_index;
+        assert(span_index == spans_count);
+
+        BONGOCAT_LOG_VERBOSE("Sprite sheet spans: %zu runs in %dx%d", spans_count, width, height);
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    // bytes per row of a sprite sheet, indexed (palette.bits_per_pixel > 0) or `channels` bytes per pixel
+    static size_t sprite_sheet_row_bytes(int width, int channels, const sprite_sheet_palette_t *palette) {
+        if (palette && palette->bits_per_pixel > 0) {
+            return (static_cast<size_t>(width) * static_cast<size_t>(palette->bits_per_pixel) + 7) / 8;
+        }
+        return static_cast<size_t>(width) * static_cast<size_t>(channels);
+    }
+
+    // monochrome LCD sprite sheets (Digimon) use only a few colors: store 1, 2 or 4 bit palette indices instead of RGBA,
+    // the blit expands them directly into the BGRA buffer. Keeps RGBA when the sheet has more than SPRITE_SHEET_MAX_PALETTE_SIZE-1 colors
+    static bool pack_indexed_sprite_sheet(AllocatedArray<uint8_t>& pixels, sprite_sheet_palette_t& out_palette, int width, int height, int& channels) {
+        if (!pixels || width <= 0 || height <= 0 || channels != RGBA_CHANNELS) {
+            return false;
+        }
+        const size_t pixels_count = static_cast<size_t>(width) * static_cast<size_t>(height);
+        if (pixels_count * RGBA_CHANNELS > pixels._size_bytes) {
+            return false;
+        }
+
+        // index 0: transparent
+        uint32_t colors_rgba[SPRITE_SHEET_MAX_PALETTE_SIZE]{};
+        size_t colors_count = 1;
+        auto find_color = [&](uint32_t rgba) -> size_t {
+            for (size_t c = 1; c < colors_count; c++) {
+                if (colors_rgba[c] == rgba) return c;
+            }
+            return 0;
+        };
+        for (size_t i = 0; i < pixels_count; i++) {
+            const uint8_t *px = pixels.data + i * RGBA_CHANNELS;
+            if (px[3] <= THRESHOLD_ALPHA) continue;
+            uint32_t rgba;
+            memcpy(&rgba, px, sizeof(rgba));
+            if (find_color(rgba) == 0) {
+                if (colors_count >= SPRITE_SHEET_MAX_PALETTE_SIZE) {
+                    return false;
+                }
+                colors_rgba[colors_count++] = rgba;
+            }
+        }
+
+        const int bits_per_pixel = colors_count <= 2 ? 1 : colors_count <= 4 ? 2 : 4;
+        sprite_sheet_palette_t palette;
+        palette.bits_per_pixel = bits_per_pixel;
+        const size_t row_bytes = sprite_sheet_row_bytes(width, RGBA_CHANNELS, &palette);
+        auto packed = make_allocated_array<uint8_t>(row_bytes * static_cast<size_t>(height));
+        if (!packed) {
+            return false;
+        }
+        for (int y = 0; y < height; y++) {
+            uint8_t *dest_row = packed.data + static_cast<size_t>(y) * row_bytes;
+            for (int x = 0; x < width; x++) {
+                const uint8_t *px = pixels.data + (static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)) * RGBA_CHANNELS;
+                if (px[3] <= THRESHOLD_ALPHA) continue;
+                uint32_t rgba;
+                memcpy(&rgba, px, sizeof(rgba));
+                const size_t bit = static_cast<size_t>(x) * static_cast<size_t>(bits_per_pixel);
+                dest_row[bit >> 3] = static_cast<uint8_t>(dest_row[bit >> 3] | (find_color(rgba) << (bit & 7u)));
+            }
+        }
 
-        // Store without branching
-        if (dest_channels >= 1) dest[dest_idx + dr] = r;
-        if (dest_channels >= 2) dest[dest_idx + dg] = g;
-        if (dest_channels >= 3) dest[dest_idx + db] = b;
-        if (dest_channels >= 4) dest[dest_idx + 3]  = a;
+        palette.colors_count = static_cast<int>(colors_count);
+        for (size_t c = 1; c < colors_count; c++) {
+            uint8_t rgba[RGBA_CHANNELS];
+            memcpy(rgba, &colors_rgba[c], sizeof(rgba));
+            const uint8_t bgra[BGRA_CHANNELS] = { rgba[2], rgba[1], rgba[0], rgba[3] };
+            memcpy(&palette.colors_bgra[c], bgra, sizeof(bgra));
+        }
+
+        BONGOCAT_LOG_DEBUG("Packed %dx%d sprite sheet: %zu colors, %d bpp (%zu -> %zu bytes)",
+                           width, height, colors_count, bits_per_pixel, pixels._size_bytes, packed._size_bytes);
+        pixels = move(packed);
+        out_palette = palette;
+        channels = SPRITE_SHEET_INDEXED_CHANNELS;
+        return true;
     }
 
     [[maybe_unused]] static bongocat_error_t load_sprite_sheet_from_memory(generic_sprite_sheet_animation_t& out_frames,
@@ -171,24 +338,10 @@ namespace bongocat::animation {
                 assert(src_idx >= 0);
                 assert(dst_idx >= 0);
 
-                bool set_frames = false;
-                for (int fy = 0; fy < src_frame_height; fy++) {
-                    for (int fx = 0; fx < src_frame_width; fx++) {
-                        const auto src_px_idx = ((src_y + fy) * src_pixels_width + (src_x + fx)) * channels;
-                        const auto dst_px_idx = ((dst_y + fy) * dest_pixels_width + (dst_x + fx)) * channels;
-
-                        if (src_px_idx >= 0 && dst_px_idx >= 0 &&
-                            static_cast<size_t>(src_px_idx) < src_pixels_size &&
-                            static_cast<size_t>(dst_px_idx) < dest_pixels_size) {
-                            drawing_copy_pixel(dest_pixels.data, channels, dst_px_idx,
-                                               sprite_sheet_pixels, channels, src_px_idx,
-                                               drawing_option, drawing_color_order_t::COLOR_ORDER_RGBA, drawing_color_order_t::COLOR_ORDER_RGBA);
-                            if (!set_frames && frame_index < MAX_NUM_FRAMES) {
-                                set_frames = true;
-                            }
-                        }
-                    }
-                }
+                const bool set_frames = copy_sprite_frame(drawing_option,
+                                                          dest_pixels.data, dest_pixels_size, dest_pixels_width, dst_x, dst_y,
+                                                          sprite_sheet_pixels, src_pixels_size, src_pixels_width, src_x, src_y,
+                                                          src_frame_width, src_frame_height) && frame_index < MAX_NUM_FRAMES;
                 if (frame_index < MAX_NUM_FRAMES) {
                     if (set_frames) {
                         out_frames.frames[frame_index] = { .valid = true, .col = col, .row = row };
@@ -213,6 +366,13 @@ namespace bongocat::animation {
         out_frames.frame_width = dest_frame_width;
         out_frames.frame_height = dest_frame_height;
         out_frames.total_frames = total_frames;
+        if (build_sprite_sheet_spans(out_frames.spans, out_frames.pixels.data, out_frames.pixels._size_bytes, out_frames.sprite_sheet_width, out_frames.sprite_sheet_height, out_frames.channels) != bongocat_error_t::BONGOCAT_SUCCESS) {
+            // optional, blit falls back to per-pixel alpha test
+            BONGOCAT_LOG_WARNING("Failed to build sprite sheet spans");
+        }
+        // spans are built from RGBA, pack afterward
+        out_frames.palette = {};
+        pack_indexed_sprite_sheet(out_frames.pixels, out_frames.palette, out_frames.sprite_sheet_width, out_frames.sprite_sheet_height, out_frames.channels);
 
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
@@ -228,15 +388,143 @@ namespace bongocat::animation {
     */
 
 
-    static inline constexpr unsigned int FIXED_SHIFT = 16;
-    static inline constexpr unsigned int FIXED_ONE   = (1u << FIXED_SHIFT);
+    // first target x (relative to the first sample) whose source x (16.16) is >= src_x_fixed
+    static int64_t first_sample_at(int64_t src_x_fixed, int64_t sx_fixed_start, int32_t inc_x) {
+        const int64_t distance = src_x_fixed - sx_fixed_start;
+        return distance <= 0 ? 0 : (distance + inc_x - 1) / inc_x;
+    }
+
+    // call row_func(first_sample, sx_fixed, count) for every opaque run of source row sy inside [src_x, frame_right),
+    // samples are relative to sx_fixed_start, transparent pixels are never sampled
+    template <typename RowFunc>
+    static void for_each_opaque_run(const sprite_sheet_spans_t& spans, int sy, int src_x, int frame_right,
+                                    int32_t sx_fixed_start, int32_t inc_x, int samples_count, RowFunc&& row_func) {
+        const uint32_t spans_begin = spans.row_offsets[static_cast<size_t>(sy)];
+        const uint32_t spans_end = spans.row_offsets[static_cast<size_t>(sy) + 1];
+        for (uint32_t si = spans_begin; si < spans_end; si++) {
+            const sprite_sheet_span_t& span = spans.spans[si];
+            if (span.start >= frame_right) break;
+            const int s0 = span.start > src_x ? span.start : src_x;
+            const int s1 = span.start + span.length < frame_right ? span.start + span.length : frame_right;
+            if (s1 <= s0) continue;
+
+            const int64_t i0 = first_sample_at(static_cast<int64_t>(s0) << FIXED_SHIFT, sx_fixed_start, inc_x);
+            int64_t i1 = first_sample_at(static_cast<int64_t>(s1) << FIXED_SHIFT, sx_fixed_start, inc_x);
+            if (i1 > samples_count) i1 = samples_count;
+            if (i0 >= i1) continue;
+
+            row_func(static_cast<int>(i0), sx_fixed_start + static_cast<int32_t>(i0 * inc_x), static_cast<int>(i1 - i0));
+        }
+    }
+
+    // nearest-neighbour row of an indexed sprite sheet into BGRA, index 0 is transparent
+    static void blit_row_indexed_to_bgra(uint8_t *dest, const uint8_t *src_row, const sprite_sheet_palette_t& palette,
+                                         int32_t sx_fixed, int32_t inc_x, int count) {
+        const auto bits_per_pixel = static_cast<unsigned>(palette.bits_per_pixel);
+        const unsigned mask = (1u << bits_per_pixel) - 1u;
+        auto *d = reinterpret_cast<uint32_t *>(dest);
+        for (int i = 0; i < count; i++) {
+            const size_t bit = static_cast<size_t>(sx_fixed >> FIXED_SHIFT) * bits_per_pixel;
+            const unsigned index = (static_cast<unsigned>(src_row[bit >> 3]) >> (bit & 7u)) & mask;
+            if (index != 0) {
+                d[i] = palette.colors_bgra[index];
+            }
+            sx_fixed += inc_x;
+        }
+    }
+
+    struct blit_rows_params_t {
+        uint8_t *dest{nullptr};
+        size_t dest_row_bytes{0};
+        const uint8_t *src{nullptr};
+        size_t src_row_bytes{0};
+        int src_w{0};
+        int src_h{0};
+        // clipped range in target coordinates
+        int x0{0};
+        int x1{0};
+        int y0{0};
+        int y1{0};
+        int offset_x{0};
+        int offset_y{0};
+        // 16.16 fixed point
+        int32_t src_x_start{0};
+        int32_t src_y_start{0};
+        int32_t inc_x{0};
+        int32_t inc_y{0};
+    };
+    using blit_rows_func_t = void (*)(const blit_rows_params_t&);
+
+    // nearest-neighbour scaling for any channel count/color order, skip transparent pixels (alpha <= THRESHOLD_ALPHA)
+    template <int DestChannels, int SrcChannels, drawing_color_order_t DestOrder, drawing_color_order_t SrcOrder>
+    static void blit_rows(const blit_rows_params_t& params) {
+        for (int ty = params.y0; ty < params.y1; ++ty) {
+            const auto dy = params.offset_y + ty;  // dest y
+            // fixed-point source y for this target y
+            const int32_t sy_fixed = params.src_y_start + static_cast<int32_t>(static_cast<int64_t>(ty) * params.inc_y);
+            const int sy = sy_fixed >> FIXED_SHIFT;
+            if (static_cast<unsigned>(sy) >= static_cast<unsigned>(params.src_h)) continue; // out of source bounds (shouldn't happen with clipping but safe)
+
+            uint8_t *dest_ptr = params.dest + static_cast<size_t>(dy) * params.dest_row_bytes + static_cast<size_t>(params.offset_x + params.x0) * DestChannels;
+            const uint8_t *src_row = params.src + static_cast<size_t>(sy) * params.src_row_bytes;
+            int32_t sx_fixed = params.src_x_start + static_cast<int32_t>(static_cast<int64_t>(params.x0) * params.inc_x);
+            for (int tx = params.x0; tx < params.x1; ++tx) {
+                // If sampled source pixel is outside source bounds, skip (safeguard)
+                if (const int sx = sx_fixed >> FIXED_SHIFT; static_cast<unsigned>(sx) < static_cast<unsigned>(params.src_w)) {
+                    const uint8_t *src_pixel = src_row + static_cast<size_t>(sx) * SrcChannels;
+                    // If source has alpha channel and is transparent (<= threshold), skip.
+                    if constexpr (SrcChannels >= 4) {
+                        if (src_pixel[3] > THRESHOLD_ALPHA) {
+                            drawing_copy_pixel<DestChannels, SrcChannels, DestOrder, SrcOrder, false>(dest_ptr, src_pixel);
+                        }
+                    } else {
+                        drawing_copy_pixel<DestChannels, SrcChannels, DestOrder, SrcOrder, false>(dest_ptr, src_pixel);
+                    }
+                }
+                sx_fixed += params.inc_x;
+                dest_ptr += DestChannels;
+            }
+        }
+    }
+
+    template <int DestChannels, int SrcChannels>
+    static blit_rows_func_t select_blit_rows(drawing_color_order_t dest_order, drawing_color_order_t src_order) {
+        using enum drawing_color_order_t;
+        if (dest_order == COLOR_ORDER_BGRA) {
+            return src_order == COLOR_ORDER_RGBA ? blit_rows<DestChannels, SrcChannels, COLOR_ORDER_BGRA, COLOR_ORDER_RGBA>
+                                                 : blit_rows<DestChannels, SrcChannels, COLOR_ORDER_BGRA, COLOR_ORDER_BGRA>;
+        }
+        return src_order == COLOR_ORDER_RGBA ? blit_rows<DestChannels, SrcChannels, COLOR_ORDER_RGBA, COLOR_ORDER_RGBA>
+                                             : blit_rows<DestChannels, SrcChannels, COLOR_ORDER_RGBA, COLOR_ORDER_BGRA>;
+    }
+    template <int DestChannels>
+    static blit_rows_func_t select_blit_rows(int src_channels, drawing_color_order_t dest_order, drawing_color_order_t src_order) {
+        switch (src_channels) {
+            case 1: return select_blit_rows<DestChannels, 1>(dest_order, src_order);
+            case 2: return select_blit_rows<DestChannels, 2>(dest_order, src_order);
+            case 3: return select_blit_rows<DestChannels, 3>(dest_order, src_order);
+            case 4: return select_blit_rows<DestChannels, 4>(dest_order, src_order);
+            default: return nullptr;
+        }
+    }
+    // only color destinations (RGB, RGBA/BGRA) are supported
+    static blit_rows_func_t select_blit_rows(int dest_channels, int src_channels, drawing_color_order_t dest_order, drawing_color_order_t src_order) {
+        switch (dest_channels) {
+            case 3: return select_blit_rows<3>(src_channels, dest_order, src_order);
+            case 4: return select_blit_rows<4>(src_channels, dest_order, src_order);
+            default: return nullptr;
+        }
+    }
+
     void blit_image_scaled(uint8_t *dest, size_t dest_size, int dest_w, int dest_h, int dest_channels,
                            const unsigned char *src, size_t src_size, int src_w, int src_h, int src_channels,
                            int src_x, int src_y,
                            int frame_w, int frame_h,
                            int offset_x, int offset_y, int target_w, int target_h,
                            drawing_color_order_t dest_order,
-                           drawing_color_order_t src_order)
+                           drawing_color_order_t src_order,
+                           const sprite_sheet_spans_t *src_spans,
+                           const sprite_sheet_palette_t *src_palette)
     {
         if (!dest || !src) return;
         if (dest_w <= 0 || dest_h <= 0 || src_w <= 0 || src_h <= 0) return;
@@ -252,7 +540,9 @@ namespace bongocat::animation {
         assert(src_h >= 0);
         assert(src_channels >= 0);
         const size_t needed_dest = static_cast<size_t>(dest_w) * static_cast<size_t>(dest_h) * static_cast<size_t>(dest_channels);
-        const size_t needed_src  = static_cast<size_t>(src_w)  * static_cast<size_t>(src_h)  * static_cast<size_t>(src_channels);
+        const bool src_indexed = src_palette && src_palette->bits_per_pixel > 0;
+        assert(!src_indexed || src_channels == SPRITE_SHEET_INDEXED_CHANNELS);
+        const size_t needed_src  = sprite_sheet_row_bytes(src_w, src_channels, src_palette) * static_cast<size_t>(src_h);
         if (dest_size < needed_dest || src_size < needed_src) {
             return;
         }
@@ -285,62 +575,68 @@ namespace bongocat::animation {
         const int32_t src_y_start = src_y << FIXED_SHIFT;
 
         // Precompute some constants for row indexing
-        const size_t src_row_bytes  = static_cast<size_t>(src_w) * static_cast<size_t>(src_channels);
+        const size_t src_row_bytes  = sprite_sheet_row_bytes(src_w, src_channels, src_palette);
         const size_t dest_row_bytes = static_cast<size_t>(dest_w) * static_cast<size_t>(dest_channels);
 
-        // Loop over clipped target Y
-        for (int ty = y0; ty < y1; ++ty) {
-            const auto dy = offset_y + ty;  // dest y
-            assert(dy < dest_h);
-            // fixed-point source y for this target y
-            const int32_t sy_fixed = src_y_start + static_cast<int32_t>(static_cast<int64_t>(ty) * inc_y);
-            const int sy = sy_fixed >> FIXED_SHIFT;
-            if (static_cast<unsigned>(sy) >= static_cast<unsigned>(src_h)) continue; // out of source bounds (shouldn't happen with clipping but safe)
-
-            // Pointers to the start of the rows
-            const uint8_t *dest_row = dest + static_cast<size_t>(dy) * dest_row_bytes;
-            const uint8_t *src_row = src + static_cast<size_t>(sy) * src_row_bytes;
-
-            // Start x in target coords and compute corresponding initial sx_fixed for x0
-            int32_t sx_fixed = src_x_start + static_cast<int32_t>(static_cast<int64_t>(x0) * inc_x);
-
-            // Destination x start and destination pointer
-            const auto dx = offset_x + x0;
-            assert(dest_channels >= 0);
-            const unsigned char *dest_ptr = dest_row + static_cast<size_t>(dx) * static_cast<size_t>(dest_channels);
-
-            // For each x in clipped horizontal range
-            for (int tx = x0; tx < x1; ++tx) {
-                // If sampled source pixel is outside source bounds, skip (safeguard)
-                if (int sx = sx_fixed >> FIXED_SHIFT; static_cast<unsigned>(sx) < static_cast<unsigned>(src_w)) {
-                    assert(src_channels >= 0);
-                    const uint8_t *src_pixel = src_row + static_cast<size_t>(sx) * static_cast<size_t>(src_channels);
-                    if (dest_ptr >= dest && src_pixel >= src) {
-                        const int dest_idx = static_cast<int>(dest_ptr - dest); // index in bytes from dest base
-                        const int src_idx  = static_cast<int>(src_pixel - src); // index in bytes from src base
-
-                        // If source has alpha channel and is transparent (<= threshold), skip.
-                        if (src_channels >= 4) {
-                            if (src_pixel[3] > THRESHOLD_ALPHA) {
-                                // compute indices for drawing_copy_pixel (byte offsets)
-                                drawing_copy_pixel(dest, dest_channels, dest_idx,
-                                                   src, src_channels, src_idx,
-                                                   drawing_copy_pixel_color_option_t::COPY_PIXEL_OPTION_NORMAL, dest_order, src_order);
-                            }
-                        } else {
-                            // opaque source (no alpha), just copy
-                            drawing_copy_pixel(dest, dest_channels, dest_idx,
-                                               src, src_channels, src_idx,
-                                               drawing_copy_pixel_color_option_t::COPY_PIXEL_OPTION_NORMAL, dest_order, src_order);
-                        }
+        // Fast path (used by draw_bar): RGBA or indexed sprite sheet into BGRA shm buffer, SIMD row kernel (see blit_select_kernel)
+        if (dest_channels == BGRA_CHANNELS && (src_indexed || src_channels == RGBA_CHANNELS) &&
+            dest_order == drawing_color_order_t::COLOR_ORDER_BGRA && src_order == drawing_color_order_t::COLOR_ORDER_RGBA &&
+            src_x >= 0 && inc_x > 0) {
+            // sx is monotonic, only sample [x0, x_end) where sx stays inside of the source row
+            const int32_t sx_fixed_x0 = src_x_start + static_cast<int32_t>(static_cast<int64_t>(x0) * inc_x);
+            const int64_t max_samples = ((static_cast<int64_t>(src_w) << FIXED_SHIFT) - sx_fixed_x0 + inc_x - 1) / inc_x;
+            const int x_end = max_samples < static_cast<int64_t>(x1 - x0) ? x0 + static_cast<int>(max_samples) : x1;
+            if (x_end <= x0) return;
+
+            const blit_row_rgba_to_bgra_func_t blit_row = blit_get_row_rgba_to_bgra();
+            const bool use_spans = src_spans && src_spans->row_offsets.count == static_cast<size_t>(src_h) + 1;
+            const int frame_right = src_x + frame_w < src_w ? src_x + frame_w : src_w;   // exclusive
+            for (int ty = y0; ty < y1; ++ty) {
+                const auto dy = offset_y + ty;  // dest y
+                assert(dy < dest_h);
+                const int32_t sy_fixed = src_y_start + static_cast<int32_t>(static_cast<int64_t>(ty) * inc_y);
+                const int sy = sy_fixed >> FIXED_SHIFT;
+                if (static_cast<unsigned>(sy) >= static_cast<unsigned>(src_h)) continue;
+
+                uint8_t *dest_ptr = dest + static_cast<size_t>(dy) * dest_row_bytes + static_cast<size_t>(offset_x + x0) * static_cast<size_t>(dest_channels);
+                const uint8_t *src_row = src + static_cast<size_t>(sy) * src_row_bytes;
+                auto draw_run = [&](int first_sample, int32_t sx_fixed, int count) {
+                    uint8_t *run_dest = dest_ptr + static_cast<size_t>(first_sample) * static_cast<size_t>(dest_channels);
+                    if (src_indexed) {
+                        blit_row_indexed_to_bgra(run_dest, src_row, *src_palette, sx_fixed, inc_x, count);
+                    } else {
+                        blit_row(run_dest, src_row, sx_fixed, inc_x, count);
                     }
+                };
+                if (use_spans) {
+                    for_each_opaque_run(*src_spans, sy, src_x, frame_right, sx_fixed_x0, inc_x, x_end - x0, draw_run);
+                } else {
+                    draw_run(0, sx_fixed_x0, x_end - x0);
                 }
-
-                // advance fixed x and destination pointer
-                sx_fixed += inc_x;
-                dest_ptr += dest_channels;
             }
+            return;
+        }
+        // indexed sprite sheets are only drawn into BGRA buffers, the generic row loops read `src_channels` bytes per pixel
+        assert(!src_indexed);
+        if (src_indexed) {
+            return;
+        }
+
+        // generic path: one dispatch to the format specialised row loop
+        const blit_rows_func_t blit_rows = select_blit_rows(dest_channels, src_channels, dest_order, src_order);
+        if (!blit_rows) {
+            BONGOCAT_LOG_VERBOSE("blit_image_scaled: unsupported format (dest channels: %d, src channels: %d)", dest_channels, src_channels);
+            return;
         }
+        const blit_rows_params_t params = {
+            .dest = dest, .dest_row_bytes = dest_row_bytes,
+            .src = src, .src_row_bytes = src_row_bytes, .src_w = src_w, .src_h = src_h,
+            .x0 = x0, .x1 = x1, .y0 = y0, .y1 = y1,
+            .offset_x = offset_x, .offset_y = offset_y,
+            .src_x_start = src_x_start, .src_y_start = src_y_start,
+            .inc_x = inc_x, .inc_y = inc_y,
+        };
+        blit_rows(params);
     }
 
     // =============================================================================
@@ -471,6 +767,10 @@ namespace bongocat::animation {
             if (loaded_images[i].pixels) stbi_image_free(loaded_images[i].pixels);
             loaded_images[i].pixels = nullptr;
         }
+        if (build_sprite_sheet_spans(anim.spans, anim.pixels.data, anim.pixels._size_bytes, anim.sprite_sheet_width, anim.sprite_sheet_height, anim.channels) != bongocat_error_t::BONGOCAT_SUCCESS) {
+            // optional, blit falls back to per-pixel alpha test
+            BONGOCAT_LOG_WARNING("Failed to build sprite sheet spans");
+        }
         return total_frames;
     }
 
@@ -575,24 +875,10 @@ namespace bongocat::animation {
                 assert(src_idx >= 0);
                 assert(dst_idx >= 0);
 
-                bool set_frames = false;
-                for (int fy = 0; fy < src_frame_height; fy++) {
-                    for (int fx = 0; fx < src_frame_width; fx++) {
-                        const auto src_px_idx = ((src_y + fy) * src_pixels_width + (src_x + fx)) * channels;
-                        const auto dst_px_idx = ((dst_y + fy) * dest_pixels_width + (dst_x + fx)) * channels;
-
-                        if (src_px_idx >= 0 && dst_px_idx >= 0 &&
-                            static_cast<size_t>(src_px_idx) < src_pixels_size &&
-                            static_cast<size_t>(dst_px_idx) < dest_pixels_size) {
-                            drawing_copy_pixel(dest_pixels.data, channels, dst_px_idx,
-                                               sprite_sheet_pixels, channels, src_px_idx,
-                                               drawing_option, drawing_color_order_t::COLOR_ORDER_RGBA, drawing_color_order_t::COLOR_ORDER_RGBA);
-                            if (!set_frames && frame_index < MAX_NUM_FRAMES) {
-                                set_frames = true;
-                            }
-                        }
-                    }
-                }
+                copy_sprite_frame(drawing_option,
+                                  dest_pixels.data, dest_pixels_size, dest_pixels_width, dst_x, dst_y,
+                                  sprite_sheet_pixels, src_pixels_size, src_pixels_width, src_x, src_y,
+                                  src_frame_width, src_frame_height);
                 frame_index++;
             }
         }
@@ -608,6 +894,12 @@ namespace bongocat::animation {
         dest_pixels = nullptr;
         out_frames.frame_width = dest_frame_width;
         out_frames.frame_height = dest_frame_height;
+        out_frames.frame_columns = frame_columns;
+        out_frames.frame_rows = frame_rows;
+        if (build_sprite_sheet_spans(out_frames.spans, out_frames.pixels.data, out_frames.pixels._size_bytes, out_frames.sprite_sheet_width, out_frames.sprite_sheet_height, out_frames.channels) != bongocat_error_t::BONGOCAT_SUCCESS) {
+            // optional, blit falls back to per-pixel alpha test
+            BONGOCAT_LOG_WARNING("Failed to build sprite sheet spans");
+        }
 
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
@@ -0,0 +1,289 @@
+#include "platform/headless.h"
+#include "platform/wayland.h"
+#include "graphics/animation.h"
+#include "utils/histogram.h"
+#include "../graphics/bar.h"
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+
+namespace bongocat::platform::headless {
+    static inline constexpr int MAX_ATTEMPTS = 2048;
+    static inline constexpr size_t DUMP_PATH_SIZE = 4096;
+    static inline constexpr size_t DUMP_CHUNK_PIXELS = 1024;
+
+    // =============================================================================
+    // OFFSCREEN BUFFERS
+    // =============================================================================
+
+    static bongocat_error_t create_offscreen_buffers(wayland::wayland_shm_buffer_t (&buffers)[wayland::WAYLAND_NUM_BUFFERS],
+                                                     int32_t buffer_width, int32_t buffer_height, animation::animation_session_t& anim) {
+        const int32_t buffer_size = buffer_width * buffer_height * RGBA_CHANNELS;
+        if (buffer_width <= 0 || buffer_height <= 0 || buffer_size <= 0) {
+            BONGOCAT_LOG_ERROR("Invalid buffer size: %d", buffer_size);
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+        // same layout as the wl_shm pool, one page aligned mapping per buffer
+        const long page_size = sysconf(_SC_PAGESIZE);
+        assert(page_size > 0 && page_size <= INT32_MAX);
+        const int32_t buffer_stride = ((buffer_size + static_cast<int32_t>(page_size) - 1) / static_cast<int32_t>(page_size)) * static_cast<int32_t>(page_size);
+        if (buffer_stride > INT32_MAX / static_cast<int32_t>(wayland::WAYLAND_NUM_BUFFERS)) {
+            BONGOCAT_LOG_ERROR("Invalid buffer size: %d", buffer_size);
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+        const int32_t total_size = buffer_stride * static_cast<int32_t>(wayland::WAYLAND_NUM_BUFFERS);
+
+        FileDescriptor fd = wayland::create_shm(total_size);
+        if (fd._fd < 0) {
+            return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+        }
+
+        for (size_t i = 0; i < wayland::WAYLAND_NUM_BUFFERS; i++) {
+            buffers[i].pixels = make_allocated_mmap_file_buffer_value<uint8_t>(0, static_cast<size_t>(buffer_size), fd._fd, static_cast<off_t>(i) * buffer_stride);
+            if (buffers[i].pixels == nullptr) {
+                BONGOCAT_LOG_ERROR("Failed to map offscreen buffer: %s", strerror(errno));
+                for (size_t j = 0; j < i; j++) {
+                    wayland::cleanup_shm_buffer(buffers[j]);
+                }
+                return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+            }
+
+            buffers[i].buffer = nullptr;
+            buffers[i].index = i;
+            buffers[i].released_timestamp_us = 0;
+            buffers[i].committed_timestamp_us = 0;
+            atomic_store(&buffers[i].busy, false);
+            atomic_store(&buffers[i].pending, false);
+            buffers[i].last_sprite_rect = {};
+            atomic_store(&buffers[i].needs_full_redraw, true);
+            buffers[i]._animation_trigger_context = &anim;
+        }
+
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    // =============================================================================
+    // FRAME DUMP
+    // =============================================================================
+
+    static bool write_all(int fd, const void *data, size_t size) {
+        const auto *p = static_cast<const uint8_t *>(data);
+        while (size > 0) {
+            const ssize_t written = write(fd, p, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    /// PPM (P6, RGB, alpha dropped; pixels are premultiplied so this is the frame over black) or raw BGRA
+    static bool dump_frame(const char *dir, size_t frame, const wayland::wayland_shm_buffer_t& buffer, int width, int height, bool raw) {
+        char path[DUMP_PATH_SIZE];
+        const int path_len = snprintf(path, sizeof(path), "%s/frame_%06zu.%s", dir, frame, raw ? "bgra" : "ppm");
+        if (path_len < 0 || static_cast<size_t>(path_len) >= sizeof(path)) {
+            BONGOCAT_LOG_ERROR("Frame dump path too long: %s", dir);
+            return false;
+        }
+
+        const size_t total_pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+        if (total_pixels * RGBA_CHANNELS > buffer.pixels._size_bytes) {
+            BONGOCAT_LOG_ERROR("Frame dump: buffer too small (%zu bytes)", buffer.pixels._size_bytes);
+            return false;
+        }
+
+        FileDescriptor fd(open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+        if (fd._fd < 0) {
+            BONGOCAT_LOG_ERROR("Failed to open %s: %s", path, strerror(errno));
+            return false;
+        }
+
+        bool ok = true;
+        if (raw) {
+            ok = write_all(fd._fd, buffer.pixels.data, total_pixels * RGBA_CHANNELS);
+        } else {
+            char header[64];
+            const int header_len = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+            assert(header_len > 0);
+            ok = write_all(fd._fd, header, static_cast<size_t>(header_len));
+
+            // ARGB8888 little-endian: B, G, R, A
+            uint8_t rgb[DUMP_CHUNK_PIXELS * 3];
+            const uint8_t *src = buffer.pixels.data;
+            for (size_t offset = 0; ok && offset < total_pixels; offset += DUMP_CHUNK_PIXELS) {
+                const size_t count = total_pixels - offset < DUMP_CHUNK_PIXELS ? total_pixels - offset : DUMP_CHUNK_PIXELS;
+                for (size_t i = 0; i < count; i++) {
+                    const uint8_t *px = src + (offset + i) * RGBA_CHANNELS;
+                    rgb[i * 3 + 0] = px[2];
+                    rgb[i * 3 + 1] = px[1];
+                    rgb[i * 3 + 2] = px[0];
+                }
+                ok = write_all(fd._fd, rgb, count * 3);
+            }
+        }
+        if (!ok) {
+            BONGOCAT_LOG_ERROR("Failed to write %s: %s", path, strerror(errno));
+        }
+
+        return ok;
+    }
+
+    // =============================================================================
+    // PUBLIC API IMPLEMENTATION
+    // =============================================================================
+
+    bongocat_error_t setup(wayland::wayland_session_t& ctx, animation::animation_session_t& anim, const headless_options_t& options) {
+        ctx.animation_trigger_context = &anim;
+        wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+
+        if (wayland_ctx.ctx_shm == nullptr) {
+            BONGOCAT_LOG_ERROR("Failed to create shared memory for animation system: %s", strerror(errno));
+            return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+        }
+        if (wayland_ctx._local_copy_config == nullptr) {
+            BONGOCAT_LOG_ERROR("Failed to create shared memory for animation system: %s", strerror(errno));
+            return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+        }
+        if (options.screen_width <= 0) {
+            BONGOCAT_LOG_ERROR("Invalid headless screen width: %d", options.screen_width);
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+
+        BONGOCAT_LOG_INFO("Initializing headless rendering (no Wayland display)");
+
+        wayland_ctx._headless = true;
+        wayland_ctx._screen_width = options.screen_width;
+        ctx.screen_info.screen_width = options.screen_width;
+        ctx.screen_info.screen_height = wayland_ctx._bar_height;
+
+        const bongocat_error_t result = create_offscreen_buffers(wayland_ctx.ctx_shm->buffers, wayland_ctx._screen_width, wayland_ctx._bar_height, anim);
+        if (result != bongocat_error_t::BONGOCAT_SUCCESS) {
+            return result;
+        }
+        wayland_ctx.ctx_shm->current_buffer_index = 0;
+
+        // there is no configure event, the buffers are ready to draw
+        atomic_store(&wayland_ctx.ctx_shm->configured, true);
+        atomic_store(&ctx.ready, true);
+
+        BONGOCAT_LOG_INFO("Headless initialization complete (%dx%d buffer)", wayland_ctx._screen_width, wayland_ctx._bar_height);
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    bongocat_error_t run(wayland::wayland_session_t& ctx, volatile sig_atomic_t& running, int signal_fd, input::input_context_t& input, const headless_options_t& options) {
+        BONGOCAT_CHECK_NULL(ctx.animation_trigger_context, bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM);
+
+        // setup references
+        wayland::wayland_context_t& wayland_ctx = ctx.wayland_context;
+        animation::animation_session_t& trigger_ctx = *ctx.animation_trigger_context;
+        trigger_ctx._input = &input;
+        assert(wayland_ctx.ctx_shm != nullptr);
+        wayland::wayland_shared_memory_t& wayland_ctx_shm = *wayland_ctx.ctx_shm;
+
+        BONGOCAT_LOG_INFO("Starting headless render loop");
+
+        histogram_t draw_time_us;
+        size_t drawn_frames = 0;
+        const time_us_t start_us = get_monotonic_time_us();
+
+        running = 1;
+        while (running) {
+            constexpr size_t fds_signals_index = 0;
+            constexpr size_t fds_animation_render_index = 1;
+            constexpr nfds_t fds_count = 2;
+            pollfd fds[fds_count] = {
+                { .fd = signal_fd, .events = POLLIN, .revents = 0 },
+                { .fd = trigger_ctx.render_efd._fd, .events = POLLIN, .revents = 0 },
+            };
+            static_assert(fds_count == LEN_ARRAY(fds));
+
+            const int poll_result = poll(fds, fds_count, -1);
+            if (poll_result < 0) {
+                if (errno == EINTR) continue;
+                BONGOCAT_LOG_ERROR("Poll error: %s", strerror(errno));
+                running = 0;
+                return bongocat_error_t::BONGOCAT_ERROR_THREAD;
+            }
+
+            // signal events
+            if (fds[fds_signals_index].revents & POLLIN) {
+                signalfd_siginfo fdsi{};
+                if (read(fds[fds_signals_index].fd, &fdsi, sizeof(fdsi)) != sizeof(fdsi)) {
+                    BONGOCAT_LOG_ERROR("Failed to read signal fd");
+                } else {
+                    switch (fdsi.ssi_signo) {
+                        case SIGINT:
+                        case SIGTERM:
+                            BONGOCAT_LOG_INFO("Received signal %d, shutting down gracefully", fdsi.ssi_signo);
+                            running = 0;
+                            break;
+                        case SIGCHLD:
+                            while (waitpid(-1, nullptr, WNOHANG) > 0){}
+                            break;
+                        case SIGUSR1:
+                            BONGOCAT_LOG_INFO("Received SIGUSR1, dumping frame statistics");
+                            animation::print_frame_timing_stats(trigger_ctx.anim);
+                            histogram_print("draw_bar", "us", draw_time_us);
+                            break;
+                        case SIGUSR2:
+                            BONGOCAT_LOG_WARNING("Received SIGUSR2, config reload is not supported in headless mode");
+                            break;
+                        default:
+                            BONGOCAT_LOG_WARNING("Received unexpected signal %d", fdsi.ssi_signo);
+                            break;
+                    }
+                }
+            }
+            if (!running) {
+                break;
+            }
+
+            // render event
+            if (fds[fds_animation_render_index].revents & POLLIN) {
+                int attempts = 0;
+                uint64_t u;
+                while (read(trigger_ctx.render_efd._fd, &u, sizeof(uint64_t)) == sizeof(uint64_t) && attempts < MAX_ATTEMPTS) {
+                    attempts++;
+                }
+
+                const time_us_t draw_start_us = get_monotonic_time_us();
+                if (animation::draw_bar(ctx)) {
+                    histogram_record(draw_time_us, get_monotonic_time_us() - draw_start_us);
+                    if (options.dump_dir) {
+                        assert(wayland_ctx_shm.current_buffer_index >= 0);
+                        assert(static_cast<size_t>(wayland_ctx_shm.current_buffer_index) < wayland::WAYLAND_NUM_BUFFERS);
+                        const wayland::wayland_shm_buffer_t& front_buffer = wayland_ctx_shm.buffers[wayland_ctx_shm.current_buffer_index];
+                        if (!dump_frame(options.dump_dir, drawn_frames, front_buffer, wayland_ctx._screen_width, wayland_ctx._bar_height, options.dump_raw)) {
+                            running = 0;
+                            return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+                        }
+                    }
+                    drawn_frames++;
+                    if (options.max_frames > 0 && drawn_frames >= options.max_frames) {
+                        BONGOCAT_LOG_INFO("Drew %zu frames, stopping", drawn_frames);
+                        running = 0;
+                    }
+                }
+            }
+        }
+        running = 0;
+
+        [[maybe_unused]] const time_us_t elapsed_us = get_monotonic_time_us() - start_us;
+        BONGOCAT_LOG_INFO("Headless: %zu frames in %lldms (%.1f fps)", drawn_frames, static_cast<long long>(elapsed_us / 1000),
+                          elapsed_us > 0 ? static_cast<double>(drawn_frames) * 1000000.0 / static_cast<double>(elapsed_us) : 0.0);
+        histogram_print("draw_bar", "us", draw_time_us);
+        BONGOCAT_LOG_INFO("  skipped commits (frame unchanged): %zu", atomic_load(&wayland_ctx_shm.skipped_commits));
+        BONGOCAT_LOG_INFO("Headless render loop exited");
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+}
@@ -12,12 +12,34 @@
 #include <cassert>
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <climits>
+#include <cstring>
+#include <ctime>
 
 namespace bongocat::platform::input {
     static inline constexpr size_t INPUT_EVENT_BUF = 128;
-    static inline constexpr size_t MAX_POLL_FDS = 256;
+    static inline constexpr int MAX_EPOLL_EVENTS = 32;
+    // epoll_data.u64 of the eventfds, devices carry their index in _devices
+    static inline constexpr uint64_t EPOLL_UPDATE_TAG = UINT64_MAX;
+    static inline constexpr uint64_t EPOLL_SHUTDOWN_TAG = UINT64_MAX - 1;
+    static inline constexpr uint64_t EPOLL_HOTPLUG_TAG = UINT64_MAX - 2;
+    // io_uring user_data: (generation << 32) | device index, the control poll and cancels use reserved tags
+    static inline constexpr uint64_t URING_CONTROL_TAG = UINT64_MAX;
+    static inline constexpr uint64_t URING_CANCEL_TAG = UINT64_MAX - 1;
+
+    static inline constexpr uint32_t HOTPLUG_EVENT_MASK = IN_CREATE | IN_DELETE | IN_ATTRIB;
+    static inline constexpr auto HOTPLUG_BY_ID_DIR = "by-id";
+    static inline constexpr size_t HOTPLUG_EVENT_BUF = 4096;
 
     static inline constexpr auto INPUT_POOL_TIMEOUT_MS = 10;
+    // nothing is drawn while suspended (fullscreen), only device checks depend on the timeout
+    static inline constexpr auto INPUT_SUSPENDED_POOL_TIMEOUT_MS = 100;
+    // --replay-fast waits for the animation thread to drain the key event ring
+    static inline constexpr time_us_t REPLAY_RING_FULL_WAIT_US = 200;
 
     static inline constexpr time_sec_t START_ADAPTIVE_CHECK_INTERVAL_SEC = 5;
     static inline constexpr time_sec_t MID_ADAPTIVE_CHECK_INTERVAL_SEC   = 15;
@@ -34,11 +56,11 @@ namespace bongocat::platform::input {
     }
 
     static void cleanup_input_thread_context(input_context_t& input) {
+        // no read may complete into a released buffer
+        release_input_uring(input._uring);
         cleanup_input_devices_paths(input, input._device_paths.count);
         release_allocated_array(input._device_paths);
-        release_allocated_array(input._unique_paths_indices);
-        input._unique_paths_indices_capacity = 0;
-        release_allocated_array(input._unique_devices);
+        release_input_device_registry(input._devices);
     }
 
     static void cleanup_input_thread(void* arg) {
@@ -55,13 +77,749 @@ namespace bongocat::platform::input {
         BONGOCAT_LOG_INFO("Input thread cleanup completed (via pthread_cancel)");
     }
 
+    // FIFOs carry the same input_event stream, they stand in for evdev nodes in a --input-dir test directory
     inline static bool is_device_valid(const char* path) {
         struct stat fd_st{};
-        return stat(path, &fd_st) == 0 && (S_ISCHR(fd_st.st_mode) && !S_ISLNK(fd_st.st_mode));
+        return stat(path, &fd_st) == 0 && ((S_ISCHR(fd_st.st_mode) || S_ISFIFO(fd_st.st_mode)) && !S_ISLNK(fd_st.st_mode));
     }
     inline static bool is_open_device_valid(int fd) {
         struct stat fd_st{};
-        return fd >= 0 && fstat(fd, &fd_st) == 0 && (S_ISCHR(fd_st.st_mode) && !S_ISLNK(fd_st.st_mode));
+        return fd >= 0 && fstat(fd, &fd_st) == 0 && ((S_ISCHR(fd_st.st_mode) || S_ISFIFO(fd_st.st_mode)) && !S_ISLNK(fd_st.st_mode));
+    }
+
+    // =============================================================================
+    // EVENT LOOP (epoll)
+    // =============================================================================
+
+    static void drain_eventfd(const FileDescriptor& efd) {
+        if (efd._fd < 0) {
+            return;
+        }
+        uint64_t u;
+        if (read(efd._fd, &u, sizeof(u)) != sizeof(u) && errno != EAGAIN) {
+            BONGOCAT_LOG_ERROR("Error reading input eventfd: %s", strerror(errno));
+        }
+    }
+
+    static void notify_eventfd(const FileDescriptor& efd) {
+        if (efd._fd < 0) {
+            return;
+        }
+        constexpr uint64_t u = 1;
+        if (write(efd._fd, &u, sizeof(u)) != sizeof(u)) {
+            BONGOCAT_LOG_WARNING("Failed to write input eventfd: %s", strerror(errno));
+        }
+    }
+
+    /// epoll instance and its update/shutdown eventfds, created once and kept over restarts
+    static bongocat_error_t create_event_loop(input_context_t& input) {
+        if (input._epoll_fd._fd >= 0) {
+            return bongocat_error_t::BONGOCAT_SUCCESS;
+        }
+        input._epoll_fd = FileDescriptor(epoll_create1(EPOLL_CLOEXEC));
+        input._update_efd = FileDescriptor(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        input._shutdown_efd = FileDescriptor(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        if (input._epoll_fd._fd < 0 || input._update_efd._fd < 0 || input._shutdown_efd._fd < 0) {
+            BONGOCAT_LOG_ERROR("Failed to create input event loop: %s", strerror(errno));
+            close_fd(input._epoll_fd);
+            close_fd(input._update_efd);
+            close_fd(input._shutdown_efd);
+            return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+        }
+
+        epoll_event update_ev{ .events = EPOLLIN, .data = { .u64 = EPOLL_UPDATE_TAG } };
+        epoll_event shutdown_ev{ .events = EPOLLIN, .data = { .u64 = EPOLL_SHUTDOWN_TAG } };
+        if (epoll_ctl(input._epoll_fd._fd, EPOLL_CTL_ADD, input._update_efd._fd, &update_ev) < 0 ||
+            epoll_ctl(input._epoll_fd._fd, EPOLL_CTL_ADD, input._shutdown_efd._fd, &shutdown_ev) < 0) {
+            BONGOCAT_LOG_ERROR("Failed to register input eventfds: %s", strerror(errno));
+            close_fd(input._epoll_fd);
+            close_fd(input._update_efd);
+            close_fd(input._shutdown_efd);
+            return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+        }
+
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    // =============================================================================
+    // IO_URING BACKEND
+    // =============================================================================
+
+    static bool uring_active(const input_context_t& input) {
+        return input._uring.ring.ring_fd._fd >= 0;
+    }
+
+    static uint64_t uring_device_tag(const input_uring_t& uring, size_t index) {
+        return (static_cast<uint64_t>(uring.generations[index]) << 32) | index;
+    }
+
+    /// single-shot poll on the device fd, completes with the revents of the next wake-up; the events are read in the loop
+    static bool uring_arm_poll(input_context_t& input, size_t index) {
+        input_uring_t& uring = input._uring;
+        io_uring_sqe *sqe = uring_get_sqe(uring.ring);
+        if (sqe == nullptr) {
+            BONGOCAT_LOG_WARNING("io_uring submission queue full, can't watch %s", input._devices.devices[index].path);
+            return false;
+        }
+        uring_prep_poll(sqe, input._devices.devices[index].fd._fd, uring_device_tag(uring, index));
+        uring.poll_armed[index] = 1;
+        return true;
+    }
+
+    /// eventfds and inotify stay in the epoll set, one poll on the epoll fd reports them all
+    static void uring_arm_control(input_context_t& input) {
+        input_uring_t& uring = input._uring;
+        if (uring.control_armed) {
+            return;
+        }
+        if (io_uring_sqe *sqe = uring_get_sqe(uring.ring); sqe != nullptr) {
+            uring_prep_poll(sqe, input._epoll_fd._fd, URING_CONTROL_TAG);
+            uring.control_armed = true;
+        }
+    }
+
+    // =============================================================================
+    // DEVICES
+    // =============================================================================
+
+    /// open the device and add it to the epoll set (epoll_data: index in _devices), or arm its first io_uring poll
+    static bool attach_device(input_context_t& input, size_t index) {
+        assert(index < input._devices.count);
+        assert(index < MAX_INPUT_DEVICES);
+        input_device_t& device = input._devices.devices[index];
+        assert(device.path[0] != '\0');
+        assert(device.fd._fd < 0);
+
+        FileDescriptor fd(open(device.path, O_RDONLY | O_NONBLOCK | O_CLOEXEC));
+        if (fd._fd < 0) {
+            return false;
+        }
+        if (!is_open_device_valid(fd._fd)) {
+            // Not a valid char device
+            BONGOCAT_LOG_VERBOSE("File opened but not a char device: %s", device.path);
+            return false;
+        }
+        // node can be new (hotplug), one fd per physical device
+        registry_refresh_device(device, fd._fd);
+        if (registry_is_duplicate(input._devices, index)) {
+            BONGOCAT_LOG_DEBUG("Input device %s is already open by another path", device.path);
+            return false;
+        }
+        // only key events wake the input thread; without EVIOCSMASK process_input_events drops the rest
+        device.event_mask = set_key_event_mask(fd._fd);
+        if (!device.event_mask) {
+            BONGOCAT_LOG_DEBUG("No kernel event filter for %s, filtering in user space: %s", device.path, strerror(errno));
+        }
+        if (uring_active(input)) {
+            // fd stays O_NONBLOCK, it is only read after its poll completed
+            device.fd = bongocat::move(fd);
+            if (!uring_arm_poll(input, index)) {
+                close_fd(device.fd);
+                return false;
+            }
+            return true;
+        }
+        epoll_event device_ev{ .events = EPOLLIN, .data = { .u64 = index } };
+        if (epoll_ctl(input._epoll_fd._fd, EPOLL_CTL_ADD, fd._fd, &device_ev) < 0) {
+            BONGOCAT_LOG_WARNING("Failed to watch input device %s: %s", device.path, strerror(errno));
+            return false;
+        }
+        device.fd = bongocat::move(fd);
+
+        return true;
+    }
+
+    static void detach_device(input_context_t& input, size_t index) {
+        assert(index < input._devices.count);
+        input_device_t& device = input._devices.devices[index];
+        if (device.fd._fd >= 0) {
+            if (uring_active(input)) {
+                input_uring_t& uring = input._uring;
+                if (uring.poll_armed[index]) {
+                    if (io_uring_sqe *sqe = uring_get_sqe(uring.ring); sqe != nullptr) {
+                        uring_prep_cancel(sqe, uring_device_tag(uring, index), URING_CANCEL_TAG);
+                    }
+                    uring.poll_armed[index] = 0;
+                }
+                // completions of the old fd are dropped
+                uring.generations[index]++;
+            } else {
+                epoll_ctl(input._epoll_fd._fd, EPOLL_CTL_DEL, device.fd._fd, nullptr);
+            }
+            close_fd(device.fd);
+            // releases of keys still held on this device never arrive
+            atomic_fetch_add(&input.shm->key_events.resets, 1u);
+        }
+    }
+
+    // =============================================================================
+    // HOTPLUG (inotify)
+    // =============================================================================
+
+    static const char* hotplug_dir(const input_context_t& input) {
+        return input._source.device_dir != nullptr ? input._source.device_dir : DEFAULT_INPUT_DEVICE_DIR;
+    }
+
+    static void watch_by_id_dir(input_context_t& input) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", hotplug_dir(input), HOTPLUG_BY_ID_DIR);
+        // by-id only exists while a device is plugged in, its creation is reported by the device dir watch
+        input._hotplug_by_id_wd = inotify_add_watch(input._hotplug_fd._fd, path, HOTPLUG_EVENT_MASK | IN_ONLYDIR);
+    }
+
+    /// inotify watch on the device directory (and by-id) in the epoll set, without it the input thread falls back to periodic device checks
+    static void create_hotplug_watch(input_context_t& input) {
+        if (input._hotplug_fd._fd >= 0) {
+            return;
+        }
+        const char *dir = hotplug_dir(input);
+        input._hotplug_fd = FileDescriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+        if (input._hotplug_fd._fd < 0) {
+            BONGOCAT_LOG_WARNING("Failed to create inotify instance, fall back to periodic device checks: %s", strerror(errno));
+            return;
+        }
+        input._hotplug_wd = inotify_add_watch(input._hotplug_fd._fd, dir, HOTPLUG_EVENT_MASK | IN_ONLYDIR);
+        if (input._hotplug_wd < 0) {
+            BONGOCAT_LOG_WARNING("Failed to watch %s, fall back to periodic device checks: %s", dir, strerror(errno));
+            close_fd(input._hotplug_fd);
+            return;
+        }
+        watch_by_id_dir(input);
+
+        epoll_event hotplug_ev{ .events = EPOLLIN, .data = { .u64 = EPOLL_HOTPLUG_TAG } };
+        if (epoll_ctl(input._epoll_fd._fd, EPOLL_CTL_ADD, input._hotplug_fd._fd, &hotplug_ev) < 0) {
+            BONGOCAT_LOG_WARNING("Failed to register inotify, fall back to periodic device checks: %s", strerror(errno));
+            close_fd(input._hotplug_fd);
+            input._hotplug_wd = -1;
+            input._hotplug_by_id_wd = -1;
+            return;
+        }
+        BONGOCAT_LOG_DEBUG("Watching %s for input device hotplug", dir);
+    }
+
+    static void hotplug_device(input_context_t& input, size_t index, uint32_t mask, size_t& valid_devices) {
+        input_device_t& device = input._devices.devices[index];
+        // IN_CREATE on an open device: node was replaced
+        if ((mask & (IN_DELETE | IN_CREATE)) && device.fd._fd >= 0) {
+            detach_device(input, index);
+            valid_devices--;
+            BONGOCAT_LOG_INFO("Input device removed: %s", device.path);
+        }
+        // matched by a glob/auto/name selector: the node name can come back as another device, select it again
+        if ((mask & IN_DELETE) && !device.pinned) {
+            registry_remove_device(input._devices, index);
+            return;
+        }
+        // IN_ATTRIB: udev sets the permissions after creating the node, opening may only work now
+        if ((mask & (IN_CREATE | IN_ATTRIB)) && device.fd._fd < 0) {
+            if (attach_device(input, index)) {
+                valid_devices++;
+                BONGOCAT_LOG_INFO("New input device detected and opened: %s (fd=%d)", device.path, device.fd._fd);
+            } else {
+                BONGOCAT_LOG_VERBOSE("Failed to open input device: %s (%s)", device.path, strerror(errno));
+            }
+        }
+    }
+
+    static void hotplug_rescan(input_context_t& input, size_t& valid_devices) {
+        for (size_t i = 0; i < input._devices.count; i++) {
+            if (input._devices.devices[i].path[0] != '\0') {
+                hotplug_device(input, i, IN_ATTRIB, valid_devices);
+            }
+        }
+    }
+
+    /// attach/detach the configured devices named by pending inotify events
+    static void handle_hotplug_events(input_context_t& input, size_t& valid_devices) {
+        alignas(inotify_event) char buf[HOTPLUG_EVENT_BUF];
+        const char *dir = hotplug_dir(input);
+        while (true) {
+            const ssize_t len = read(input._hotplug_fd._fd, buf, sizeof(buf));
+            if (len < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN) {
+                    BONGOCAT_LOG_ERROR("Error reading inotify: %s", strerror(errno));
+                }
+                break;
+            }
+            if (len == 0) {
+                break;
+            }
+
+            for (const char *p = buf; p < buf + len; ) {
+                const auto *event = reinterpret_cast<const inotify_event *>(p);
+                p += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    BONGOCAT_LOG_DEBUG("inotify queue overflow, rescan input devices");
+                    hotplug_rescan(input, valid_devices);
+                    continue;
+                }
+                if (event->mask & IN_IGNORED) {
+                    if (event->wd == input._hotplug_by_id_wd) {
+                        input._hotplug_by_id_wd = -1;
+                    }
+                    continue;
+                }
+                if (event->len == 0) {
+                    continue;
+                }
+                if (event->mask & IN_ISDIR) {
+                    if (event->wd == input._hotplug_wd && (event->mask & IN_CREATE) &&
+                        input._hotplug_by_id_wd < 0 && strcmp(event->name, HOTPLUG_BY_ID_DIR) == 0) {
+                        watch_by_id_dir(input);
+                        // links can be created before the watch is set
+                        hotplug_rescan(input, valid_devices);
+                    }
+                    continue;
+                }
+
+                char path[PATH_MAX];
+                if (event->wd == input._hotplug_by_id_wd) {
+                    snprintf(path, sizeof(path), "%s/%s/%s", dir, HOTPLUG_BY_ID_DIR, event->name);
+                } else {
+                    snprintf(path, sizeof(path), "%s/%s", dir, event->name);
+                }
+                // known device, or a new node picked up by a glob/auto/name selector
+                if (const ssize_t index = (event->mask & IN_DELETE) ? -1 : registry_lookup_or_add(input._devices, path); index >= 0) {
+                    hotplug_device(input, static_cast<size_t>(index), event->mask, valid_devices);
+                } else if (event->mask & IN_DELETE) {
+                    for (size_t i = 0; i < input._devices.count; i++) {
+                        if (strcmp(input._devices.devices[i].path, path) == 0) {
+                            hotplug_device(input, i, event->mask, valid_devices);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    static bool write_all(int fd, const void *data, size_t size) {
+        const auto *p = static_cast<const uint8_t *>(data);
+        while (size > 0) {
+            const ssize_t written = write(fd, p, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    static bool is_key_event(const input_event& ev) {
+        // value: 0 = release, 1 = press, 2 = autorepeat (ignored)
+        // other types only arrive without the kernel filter (EVIOCSMASK) or from a replay
+        return ev.type == EV_KEY && (ev.value == 0 || ev.value == 1);
+    }
+
+    static timestamp_us_t event_time_us(const input_event& ev) {
+        return static_cast<timestamp_us_t>(ev.time.tv_sec) * 1000000LL + ev.time.tv_usec;
+    }
+
+    /// keep the KPM bookkeeping and push key presses/releases into the key event ring, shared by all input sources
+    static void process_input_events(input_context_t& input, animation::animation_session_t& trigger_ctx,
+                                     const input_event *events, size_t num_events, uint8_t device_index,
+                                     bool suspended, int timeout) {
+        // read-only config
+        assert(input._local_copy_config != nullptr);
+        const config::config_t& current_config = *input._local_copy_config;
+        [[maybe_unused]] const bool enable_debug = current_config.enable_debug;
+        assert(num_events > 0);
+
+        bool key_pressed = false;
+        for (size_t j = 0; j < num_events; j++) {
+            if (is_key_event(events[j]) && events[j].value == 1) {
+                key_pressed = true;
+                break;
+            }
+        }
+
+        // event time (CLOCK_REALTIME like get_current_time_ms), a replay gets the KPM of the recording
+        const timestamp_ms_t now = event_time_us(events[num_events - 1]) / 1000;
+        if (key_pressed) {
+            const time_ms_t duration_ms = now - input._latest_kpm_update_ms;
+            time_ms_t min_key_press_check_time_ms = timeout*2;
+            if (current_config.input_fps > 0) {
+                min_key_press_check_time_ms = 2000 / current_config.input_fps;
+            } else if (current_config.fps > 0) {
+                min_key_press_check_time_ms = 2000 / current_config.fps;
+            }
+            if (duration_ms >= min_key_press_check_time_ms) {
+                const int input_kpm_counter = atomic_load(&input._input_kpm_counter);
+                if (input_kpm_counter > 0) {
+                    if (duration_ms > 0) {
+                        const double duration_min = static_cast<double>(duration_ms) / 60000.0;
+                        assert(duration_min > 0.0);
+                        input.shm->kpm = static_cast<int>(static_cast<double>(input_kpm_counter) / duration_min);
+                    } else {
+                        input.shm->kpm = 0;
+                    }
+                    atomic_store(&input._input_kpm_counter, 0);
+                    input._latest_kpm_update_ms = now;
+                }
+            }
+            input.shm->last_key_pressed_timestamp = now;
+            atomic_fetch_add(&input.shm->input_counter, 1);
+            atomic_fetch_add(&input._input_kpm_counter, 1);
+        } else {
+            if (input.shm->kpm > 0 && now - input._latest_kpm_update_ms >= RESET_KPM_TIMEOUT_MS) {
+                input.shm->kpm = 0;
+                atomic_store(&input._input_kpm_counter, 0);
+                input._latest_kpm_update_ms = now;
+            }
+        }
+
+        // animation is parked while suspended, only keep the KPM bookkeeping
+        if (suspended) {
+            return;
+        }
+        // the animation thread may lag behind the producer, each event carries the KPM it was read with
+        const auto kpm = static_cast<uint16_t>(input.shm->kpm < UINT16_MAX ? input.shm->kpm : UINT16_MAX);
+        bool wake_animation = false;
+        for (size_t j = 0; j < num_events; j++) {
+            if (!is_key_event(events[j])) {
+                continue;
+            }
+            if (events[j].value == 1 && enable_debug) {
+                BONGOCAT_LOG_VERBOSE("Key event: device=%u, code=%d, time=%lld.%06lld",
+                                     device_index, events[j].code,
+                                     events[j].time.tv_sec, events[j].time.tv_usec);
+            }
+            const key_event_t key_event = {
+                .timestamp_us = event_time_us(events[j]),
+                .code = events[j].code,
+                .type = events[j].value == 1 ? key_event_type_t::Press : key_event_type_t::Release,
+                .device_index = device_index,
+                .kpm = kpm,
+            };
+            // only the empty -> non-empty transition needs a wake-up
+            wake_animation |= push_key_event(input.shm->key_events, key_event);
+        }
+        if (wake_animation) {
+            trigger(trigger_ctx);
+        }
+    }
+
+    // =============================================================================
+    // CAPTURE LOOP
+    // =============================================================================
+
+    struct input_loop_stats_t {
+        size_t events{0};
+        size_t syscalls{0};         // epoll_wait/read, io_uring_enter
+    };
+
+    static time_us_t timeval_us(const timeval& tv) {
+        return static_cast<time_us_t>(tv.tv_sec) * 1000000LL + tv.tv_usec;
+    }
+
+    static int input_wait_timeout(const config::config_t& current_config, bool suspended) {
+        if (suspended) {
+            return INPUT_SUSPENDED_POOL_TIMEOUT_MS;
+        }
+        if (current_config.input_fps > 0) {
+            return 1000 / current_config.input_fps;
+        }
+        if (current_config.fps > 0) {
+            return 1000 / current_config.fps / 2;
+        }
+        return INPUT_POOL_TIMEOUT_MS;
+    }
+
+    /// eventfds and inotify, false for device tags
+    static bool handle_control_event(input_context_t& input, uint64_t tag, size_t& valid_devices) {
+        if (tag == EPOLL_SHUTDOWN_TAG) {
+            // loop condition sees _capture_input_running
+            drain_eventfd(input._shutdown_efd);
+            return true;
+        }
+        if (tag == EPOLL_HOTPLUG_TAG) {
+            handle_hotplug_events(input, valid_devices);
+            return true;
+        }
+        if (tag == EPOLL_UPDATE_TAG) {
+            // new config (timeouts) is picked up with the next wait
+            drain_eventfd(input._update_efd);
+            return true;
+        }
+        return false;
+    }
+
+    /// record and process the result of one device read (rd < 0: read_errno), false when the device has to be re-opened
+    static bool handle_device_read(input_context_t& input, animation::animation_session_t& trigger_ctx, size_t index,
+                                   const input_event *ev, ssize_t rd, int read_errno,
+                                   bool suspended, int timeout, input_loop_stats_t& stats) {
+        [[maybe_unused]] const int fd = input._devices.devices[index].fd._fd;
+        if (rd < 0) {
+            if (read_errno != EAGAIN) {
+                BONGOCAT_LOG_WARNING("Read error on fd=%d: %s", fd, strerror(read_errno));
+                return false;
+            }
+            return true;
+        }
+        if (rd == 0 || static_cast<size_t>(rd) % sizeof(input_event) != 0) {
+            BONGOCAT_LOG_WARNING("EOF or partial read on fd=%d", fd);
+            return false;
+        }
+
+        if (input._record_fd._fd >= 0 && !write_all(input._record_fd._fd, ev, static_cast<size_t>(rd))) {
+            BONGOCAT_LOG_WARNING("Failed to record input events, stop recording: %s", strerror(errno));
+            close_fd(input._record_fd);
+        }
+
+        assert(sizeof(input_event) > 0);
+        const size_t num_events = static_cast<size_t>(rd) / sizeof(input_event);
+        stats.events += num_events;
+        process_input_events(input, trigger_ctx, ev, num_events, static_cast<uint8_t>(index), suspended, timeout);
+        return true;
+    }
+
+    /// the animation thread only resyncs its held keys when woken, a detach alone doesn't push anything into the ring
+    static void wake_animation_on_key_reset(input_context_t& input, animation::animation_session_t& trigger_ctx, unsigned int& seen_resets) {
+        const unsigned int resets = atomic_load(&input.shm->key_events.resets);
+        if (resets != seen_resets) {
+            seen_resets = resets;
+            trigger(trigger_ctx);
+        }
+    }
+
+    static void reopen_device(input_context_t& input, size_t index, size_t& valid_devices) {
+        // incremental: only this device leaves (and maybe re-enters) the epoll set/io_uring
+        detach_device(input, index);
+        if (attach_device(input, index)) {
+            BONGOCAT_LOG_VERBOSE("Re-opened input device: %s (fd=%d)", input._devices.devices[index].path, input._devices.devices[index].fd._fd);
+        } else {
+            valid_devices--;
+            BONGOCAT_LOG_VERBOSE("Failed to re-open %s: %s", input._devices.devices[index].path, strerror(errno));
+        }
+    }
+
+    /// wait timed out: adaptive device checking, only without inotify
+    static void check_devices_on_timeout(input_context_t& input, int& check_counter, time_sec_t& adaptive_check_interval_sec, size_t& valid_devices) {
+        // inotify reports hotplug, no filesystem probing needed
+        if (input._hotplug_fd._fd >= 0) {
+            return;
+        }
+        check_counter++;
+        if (check_counter < (adaptive_check_interval_sec * (1000 / 100))) {
+            return;
+        }
+        check_counter = 0;
+        bool found_new_device = false;
+        for (size_t i = 0; i < input._devices.count; i++) {
+            const char* device_path = input._devices.devices[i].path;
+            if (device_path[0] == '\0') {
+                continue;
+            }
+            bool need_reopen = false;
+            // If an fd is already open, check if it is still valid
+            if (input._devices.devices[i].fd._fd >= 0) {
+                if (!is_open_device_valid(input._devices.devices[i].fd._fd)) {
+                    // fd no longer valid
+                    need_reopen = true;
+                } else {
+                    // check if device node changed
+                    struct stat old_st{};
+                    struct stat new_st{};
+                    if (fstat(input._devices.devices[i].fd._fd, &old_st) == 0 &&
+                        stat(device_path, &new_st) == 0 &&
+                        old_st.st_rdev != new_st.st_rdev) {
+                        need_reopen = true;
+                    }
+                }
+            } else {
+                // FD never opened
+                need_reopen = true;
+            }
+
+            if (need_reopen) {
+                if (input._devices.devices[i].fd._fd >= 0) {
+                    detach_device(input, i);
+                    valid_devices--;
+                }
+                if (attach_device(input, i)) {
+                    valid_devices++;
+                    found_new_device = true;
+                    BONGOCAT_LOG_INFO("New input device detected and opened: %s (fd=%d)", device_path, input._devices.devices[i].fd._fd);
+                } else {
+                    BONGOCAT_LOG_VERBOSE("Failed to open input device: %s (%s)", device_path, strerror(errno));
+                }
+            }
+        }
+
+        if (!found_new_device && adaptive_check_interval_sec < MAX_ADAPTIVE_CHECK_INTERVAL_SEC) {
+            adaptive_check_interval_sec =
+                (adaptive_check_interval_sec < MID_ADAPTIVE_CHECK_INTERVAL_SEC)
+                    ? MID_ADAPTIVE_CHECK_INTERVAL_SEC
+                    : MAX_ADAPTIVE_CHECK_INTERVAL_SEC;
+            BONGOCAT_LOG_DEBUG("Increased device check interval to %d seconds", adaptive_check_interval_sec);
+        } else if (found_new_device && adaptive_check_interval_sec > START_ADAPTIVE_CHECK_INTERVAL_SEC) {
+            adaptive_check_interval_sec = START_ADAPTIVE_CHECK_INTERVAL_SEC;
+            BONGOCAT_LOG_DEBUG("Reset device check interval to %d seconds", START_ADAPTIVE_CHECK_INTERVAL_SEC);
+        }
+    }
+
+    /// epoll_wait, then one read() per ready device
+    static void run_epoll_loop(input_context_t& input, animation::animation_session_t& trigger_ctx, size_t& valid_devices, input_loop_stats_t& stats) {
+        // read-only config
+        assert(input._local_copy_config != nullptr);
+        const config::config_t& current_config = *input._local_copy_config;
+
+        int check_counter = 0;  // check is done periodically
+        time_sec_t adaptive_check_interval_sec = START_ADAPTIVE_CHECK_INTERVAL_SEC;
+        epoll_event events[MAX_EPOLL_EVENTS];
+        input_event ev[INPUT_EVENT_BUF];
+        unsigned int seen_resets = atomic_load(&input.shm->key_events.resets);
+
+        while (atomic_load(&input._capture_input_running)) {
+            pthread_testcancel();  // optional, but makes cancellation more responsive
+
+            // with a hotplug watch keep waiting for the devices to come back
+            if (valid_devices == 0 && input._hotplug_fd._fd < 0) {
+                BONGOCAT_LOG_ERROR("All input devices became unavailable");
+                break;
+            }
+            wake_animation_on_key_reset(input, trigger_ctx, seen_resets);
+
+            const bool suspended = atomic_load(&trigger_ctx.anim._suspended);
+            const int timeout = input_wait_timeout(current_config, suspended);
+            const int num_ready = epoll_wait(input._epoll_fd._fd, events, MAX_EPOLL_EVENTS, timeout);
+            stats.syscalls++;
+            if (num_ready < 0) {
+                if (errno == EINTR) continue; // Interrupted by signal
+                BONGOCAT_LOG_ERROR("Poll error: %s", strerror(errno));
+                break;
+            }
+
+            if (num_ready == 0) {
+                check_devices_on_timeout(input, check_counter, adaptive_check_interval_sec, valid_devices);
+                continue;
+            }
+
+            // Handle ready devices
+            for (int e = 0; e < num_ready; e++) {
+                const uint64_t tag = events[e].data.u64;
+                if (handle_control_event(input, tag, valid_devices)) {
+                    continue;
+                }
+                assert(tag < input._devices.count);
+                const auto i = static_cast<size_t>(tag);
+                const int fd = input._devices.devices[i].fd._fd;
+                if (fd < 0) {
+                    continue;
+                }
+
+                bool broken = (events[e].events & (EPOLLERR | EPOLLHUP)) != 0;
+                if (events[e].events & EPOLLIN) {
+                    const ssize_t rd = read(fd, ev, sizeof(ev));
+                    stats.syscalls++;
+                    if (!handle_device_read(input, trigger_ctx, i, ev, rd, errno, suspended, timeout, stats)) {
+                        broken = true;
+                    }
+                }
+
+                if (broken) {
+                    reopen_device(input, i, valid_devices);
+                }
+            }
+        }
+    }
+
+    /// polls stay armed on every device, one io_uring_enter submits the re-armed polls and waits for the next batch of completions,
+    /// then one non-blocking read() per ready device
+    static void run_uring_loop(input_context_t& input, animation::animation_session_t& trigger_ctx, size_t& valid_devices, input_loop_stats_t& stats) {
+        // read-only config
+        assert(input._local_copy_config != nullptr);
+        const config::config_t& current_config = *input._local_copy_config;
+        input_uring_t& uring = input._uring;
+
+        int check_counter = 0;  // check is done periodically
+        time_sec_t adaptive_check_interval_sec = START_ADAPTIVE_CHECK_INTERVAL_SEC;
+        epoll_event events[MAX_EPOLL_EVENTS];
+        input_event ev[INPUT_EVENT_BUF];
+        unsigned int seen_resets = atomic_load(&input.shm->key_events.resets);
+
+        while (atomic_load(&input._capture_input_running)) {
+            pthread_testcancel();  // optional, but makes cancellation more responsive
+
+            // with a hotplug watch keep waiting for the devices to come back
+            if (valid_devices == 0 && input._hotplug_fd._fd < 0) {
+                BONGOCAT_LOG_ERROR("All input devices became unavailable");
+                break;
+            }
+            wake_animation_on_key_reset(input, trigger_ctx, seen_resets);
+
+            const bool suspended = atomic_load(&trigger_ctx.anim._suspended);
+            const int timeout = input_wait_timeout(current_config, suspended);
+            uring_arm_control(input);
+            const int result = uring_submit_and_wait(uring.ring, timeout);
+            stats.syscalls++;
+            // -ETIME: timeout, -EBUSY: completion queue full, harvest first
+            if (result < 0 && result != -ETIME && result != -EINTR && result != -EBUSY && result != -EAGAIN) {
+                BONGOCAT_LOG_ERROR("io_uring error: %s", strerror(-result));
+                break;
+            }
+
+            size_t num_completions = 0;
+            bool control_ready = false;
+            while (const io_uring_cqe *cqe = uring_peek_cqe(uring.ring)) {
+                const uint64_t user_data = uring_cqe_user_data(cqe);
+                const int32_t res = uring_cqe_res(cqe);
+                uring_cqe_seen(uring.ring);
+                num_completions++;
+
+                if (user_data == URING_CONTROL_TAG) {
+                    uring.control_armed = false;
+                    control_ready = true;
+                    continue;
+                }
+                if (user_data == URING_CANCEL_TAG) {
+                    continue;
+                }
+                const auto i = static_cast<size_t>(user_data & UINT32_MAX);
+                assert(i < input._devices.devices.count);
+                if (static_cast<uint32_t>(user_data >> 32) != uring.generations[i]) {
+                    // poll of a detached fd (cancelled or raced the cancel)
+                    continue;
+                }
+                uring.poll_armed[i] = 0;
+                const int fd = input._devices.devices[i].fd._fd;
+                if (fd < 0) {
+                    continue;
+                }
+
+                // res: revents or -errno of the poll
+                bool broken = res < 0 || (res & (POLLERR | POLLHUP)) != 0;
+                if (res > 0 && (res & POLLIN)) {
+                    const ssize_t rd = read(fd, ev, sizeof(ev));
+                    stats.syscalls++;
+                    if (!handle_device_read(input, trigger_ctx, i, ev, rd, errno, suspended, timeout, stats)) {
+                        broken = true;
+                    }
+                }
+                // the new poll goes out with the next wait
+                if (!broken && !uring_arm_poll(input, i)) {
+                    broken = true;
+                }
+                if (broken) {
+                    reopen_device(input, i, valid_devices);
+                }
+            }
+
+            if (control_ready) {
+                const int num_ready = epoll_wait(input._epoll_fd._fd, events, MAX_EPOLL_EVENTS, 0);
+                stats.syscalls++;
+                for (int e = 0; e < num_ready; e++) {
+                    handle_control_event(input, events[e].data.u64, valid_devices);
+                }
+            }
+
+            if (num_completions == 0) {
+                check_devices_on_timeout(input, check_counter, adaptive_check_interval_sec, valid_devices);
+            }
+        }
     }
 
     static void* capture_input_thread(void* arg) {
@@ -74,7 +832,6 @@ namespace bongocat::platform::input {
         // read-only config
         assert(input._local_copy_config != nullptr);
         const config::config_t& current_config = *input._local_copy_config;
-        const bool enable_debug = current_config.enable_debug;
 
         // keep local copies of device_paths
         do {
@@ -97,377 +854,238 @@ namespace bongocat::platform::input {
 
         BONGOCAT_LOG_DEBUG("Starting input capture on %d devices", input._device_paths.count);
 
-        // init unique devices
-        input._unique_paths_indices_capacity = input._device_paths.count;
-        input._unique_paths_indices = make_allocated_array_with_value<size_t>(input._unique_paths_indices_capacity, 0);
-        if (!input._unique_paths_indices) {
+        // expand keyboard_device selectors (paths, globs, auto, name:) into one entry per physical device
+        if (build_input_device_registry(input._devices, input._device_paths.data, input._device_paths.count, hotplug_dir(input)) != bongocat_error_t::BONGOCAT_SUCCESS) {
             atomic_store(&input._capture_input_running, false);
             cleanup_input_thread_context(input);
-            BONGOCAT_LOG_ERROR("Failed to allocate memory for file descriptors");
             return nullptr;
         }
-        size_t num_unique_devices = 0;
-        // First pass: deduplicate device paths
-        for (size_t i = 0; i < input._device_paths.count; i++) {
-            if (i >= input._unique_paths_indices.count) break;
-            bool is_duplicate = false;
-            for (size_t j = 0; j < input._device_paths.count; j++) {
-                if (j >= input._unique_paths_indices.count) break;
-                if (const char* device_path = input._device_paths[i]; strcmp(device_path, input._device_paths[input._unique_paths_indices[j]]) == 0) {
-                    is_duplicate = true;
-                    break;
-                }
-            }
 
-            if (!is_duplicate && num_unique_devices < input._unique_paths_indices.count) {
-                input._unique_paths_indices[num_unique_devices] = i;
-                num_unique_devices++;
+        // ring is set up before any device is attached, attach_device arms the reads
+        if (input._source.backend == input_backend_t::IoUring) {
+            if (setup_input_uring(input._uring, input._devices.devices.count) == bongocat_error_t::BONGOCAT_SUCCESS) {
+                BONGOCAT_LOG_INFO("Using io_uring input backend");
+            } else {
+                BONGOCAT_LOG_WARNING("io_uring is not available, fall back to epoll input backend");
             }
         }
-        assert(num_unique_devices <= input._device_paths.count);
-        // shrink size, @NOTE: don't do this with mmap array
-        input._unique_paths_indices.count = num_unique_devices;
-
-        BONGOCAT_LOG_DEBUG("Deduplicated %d devices to %d unique devices", input._device_paths.count, num_unique_devices);
 
         size_t track_valid_devices = 0;
-        // Open all unique devices
-        if (input._unique_paths_indices.count > 0) {
-            input._unique_devices = make_allocated_array<input_unique_file_t>(input._unique_paths_indices.count);
-            if (!input._unique_devices) {
-                atomic_store(&input._capture_input_running, false);
-                cleanup_input_thread_context(input);
-                BONGOCAT_LOG_ERROR("Failed to allocate memory for file descriptors");
-                return nullptr;
-            }
-            size_t valid_devices = 0;
-            for (size_t i = 0;i < input._unique_paths_indices.count; i++) {
-                input._unique_devices[i] = {};
-                if (i < input._unique_paths_indices.count) {
-                    if (input._unique_paths_indices[i] < input._device_paths.count) {
-                        const char* device_path = input._device_paths[input._unique_paths_indices[i]];
-
-                        if (!is_device_valid(device_path)) {
-                            // @TODO: better message why it's NOT valid
-                            BONGOCAT_LOG_WARNING("Invalid input device: %s", device_path);
-                            continue;
-                        }
-
-                        input._unique_devices[i].device_path = nullptr;
-                        input._unique_devices[i].fd = FileDescriptor(open(device_path, O_RDONLY | O_NONBLOCK));
-                        if (input._unique_devices[i].fd._fd < 0) {
-                            BONGOCAT_LOG_WARNING("Failed to open %s: %s", device_path, strerror(errno));
-                            continue;
-                        }
-                        input._unique_devices[i].device_path = device_path;
-                        valid_devices++;
-
-                        BONGOCAT_LOG_INFO("Input monitoring started on %s (fd=%d)", input._unique_devices[i].device_path, input._unique_devices[i].fd._fd);
-                    }
+        // Open all devices, registered once with the epoll instance (or the io_uring)
+        do {
+            for (size_t i = 0; i < input._devices.count; i++) {
+                // keep missing devices, hotplug (or the periodic check) attaches them later
+                const char* device_path = input._devices.devices[i].path;
+                if (!is_device_valid(device_path)) {
+                    // @TODO: better message why it's NOT valid
+                    BONGOCAT_LOG_WARNING("Invalid input device: %s", device_path);
+                    continue;
+                }
+                if (!attach_device(input, i)) {
+                    BONGOCAT_LOG_WARNING("Failed to open %s: %s", device_path, strerror(errno));
+                    continue;
                 }
+                track_valid_devices++;
+
+                BONGOCAT_LOG_INFO("Input monitoring started on %s '%s' (fd=%d, %s)", device_path, input._devices.devices[i].name, input._devices.devices[i].fd._fd,
+                                  input._devices.devices[i].event_mask ? "kernel event filter" : "user space filter");
             }
             // Update num_devices to reflect unique devices for the rest of the function
-            if (valid_devices == 0) {
+            if (track_valid_devices == 0 && input._hotplug_fd._fd >= 0) {
+                BONGOCAT_LOG_WARNING("No valid input devices found, waiting for hotplug in %s", hotplug_dir(input));
+            } else if (track_valid_devices == 0) {
                 atomic_store(&input._capture_input_running, false);
                 BONGOCAT_LOG_ERROR("No valid input devices found");
                 cleanup_input_thread_context(input);
                 return nullptr;
             }
 
-            track_valid_devices = valid_devices;
-            BONGOCAT_LOG_INFO("Successfully opened %d/%d input devices", valid_devices, input._device_paths.count);
-        }
+            BONGOCAT_LOG_INFO("Successfully opened %d/%d input devices", track_valid_devices, input._devices.count);
+        } while (false);
 
         // trigger initial render
         wayland::request_render(trigger_ctx);
 
         pthread_cleanup_push(cleanup_input_thread, arg);
 
-        int check_counter = 0;  // check is done periodically
-        time_sec_t adaptive_check_interval_sec = START_ADAPTIVE_CHECK_INTERVAL_SEC;
-        pollfd pfds[MAX_POLL_FDS];
-        input_event ev[INPUT_EVENT_BUF];
+        // wake-up left over from stopping the previous input thread (restart)
+        drain_eventfd(input._shutdown_efd);
+
+        input_loop_stats_t stats;
+        // both backends do all their work on this thread (io_uring only polls, no io-wq workers read on our behalf)
+        rusage usage_start{};
+        getrusage(RUSAGE_THREAD, &usage_start);
 
         atomic_store(&input._capture_input_running, true);
-        while (atomic_load(&input._capture_input_running)) {
-            pthread_testcancel();  // optional, but makes cancellation more responsive
+        if (uring_active(input)) {
+            run_uring_loop(input, trigger_ctx, track_valid_devices, stats);
+        } else {
+            run_epoll_loop(input, trigger_ctx, track_valid_devices, stats);
+        }
 
-            // only map valid fds into pfds
-            nfds_t nfds = 0;
-            for (size_t i = 0; i < input._unique_devices.count && i < MAX_POLL_FDS; i++) {
-                if (input._unique_devices[i].fd._fd >= 0) {
-                    pfds[nfds].fd = input._unique_devices[i].fd._fd;
-                    pfds[nfds].events = POLLIN;
-                    pfds[nfds].revents = 0;
-                    nfds++;
-                }
-            }
-            if (nfds == 0) {
-                BONGOCAT_LOG_ERROR("All input devices became unavailable");
-                break;
-            } else if (nfds > MAX_POLL_FDS) {
-                BONGOCAT_LOG_WARNING("Max input devices fds: %d/%d (%d)", nfds, MAX_POLL_FDS, input._unique_devices.count);
-                nfds = MAX_POLL_FDS;
-            }
+        rusage usage_end{};
+        getrusage(RUSAGE_THREAD, &usage_end);
+        [[maybe_unused]] const double cpu_ms = static_cast<double>(timeval_us(usage_end.ru_utime) - timeval_us(usage_start.ru_utime) +
+                                                                    timeval_us(usage_end.ru_stime) - timeval_us(usage_start.ru_stime)) / 1000.0;
+        [[maybe_unused]] const double per_10k = stats.events > 0 ? 10000.0 / static_cast<double>(stats.events) : 0.0;
+        BONGOCAT_LOG_DEBUG("Input loop (%s): %zu events, %zu wait/read syscalls, %.1f ms CPU; per 10k events: %.0f syscalls, %.1f ms CPU",
+                           uring_active(input) ? "io_uring" : "epoll", stats.events, stats.syscalls, cpu_ms,
+                           static_cast<double>(stats.syscalls) * per_10k, cpu_ms * per_10k);
+        atomic_store(&input._capture_input_running, false);
+        if (track_valid_devices == 0 && input._hotplug_fd._fd < 0) {
+            BONGOCAT_LOG_ERROR("All input devices are unavailable");
+        }
+        BONGOCAT_LOG_DEBUG("Dropped key events (ring full): %u", atomic_load(&input.shm->key_events.dropped));
 
-            int timeout = INPUT_POOL_TIMEOUT_MS;
-            if (current_config.input_fps > 0) {
-                timeout = 1000 / current_config.input_fps;
-            } else if (current_config.fps > 0) {
-                timeout = 1000 / current_config.fps / 2;
-            }
-            const int poll_result = poll(pfds, nfds, timeout);
-            if (poll_result < 0) {
-                if (errno == EINTR) continue; // Interrupted by signal
-                BONGOCAT_LOG_ERROR("Poll error: %s", strerror(errno));
-                break;
-            }
+        // Will run only on normal return
+        pthread_cleanup_pop(1);  // 1 = call cleanup even if not canceled
 
-            if (poll_result == 0) {
-                // Timeout — adaptive device checking
-                check_counter++;
-                if (check_counter >= (adaptive_check_interval_sec * (1000 / 100))) {
-                    check_counter = 0;
-                    bool found_new_device = false;
-                    for (size_t i = 0; i < input._unique_devices.count; i++) {
-                        const char* device_path = input._unique_devices[i].device_path;
-                        bool need_reopen = false;
-                        // If an fd is already open, check if it is still valid
-                        if (input._unique_devices[i].fd._fd >= 0) {
-                            if (!is_open_device_valid(input._unique_devices[i].fd._fd)) {
-                                // fd no longer valid
-                                need_reopen = true;
-                            } else {
-                                // check if device node changed
-                                struct stat old_st{};
-                                if (input._unique_devices[i].fd._fd >= 0 &&
-                                    fstat(input._unique_devices[i].fd._fd, &old_st) == 0) {
-                                    struct stat new_st{};
-                                    if (stat(device_path, &new_st) == 0) {
-                                        if (old_st.st_rdev != new_st.st_rdev) {
-                                            need_reopen = true;
-                                        }
-                                    }
-                                    }
-                            }
-                        } else {
-                            // FD never opened
-                            need_reopen = true;
-                        }
+        // done when callback cleanup_input_thread
+        //cleanup_input_thread_context(arg);
+        assert(!input._device_paths);
+        assert(!input._devices.devices);
 
-                        if (need_reopen) {
-                            // Close old FD if still open
-                            if (input._unique_devices[i].fd._fd >= 0) {
-                                close_fd(input._unique_devices[i].fd);
-                            }
-
-                            if (int new_fd = open(device_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC); new_fd >= 0) {
-                                if (is_open_device_valid(new_fd)) {
-                                    input._unique_devices[i].fd = FileDescriptor(new_fd);
-                                    new_fd = -1;
-                                    found_new_device = true;
-                                    BONGOCAT_LOG_INFO("New input device detected and opened: %s (fd=%d)", device_path, input._unique_devices[i].fd._fd);
-                                } else {
-                                    // Not a valid char device — close immediately
-                                    close(new_fd);
-                                    BONGOCAT_LOG_VERBOSE("File opened but not a char device: %s", device_path);
-                                }
-                            } else {
-                                BONGOCAT_LOG_VERBOSE("Failed to open input device: %s (%s)", device_path, strerror(errno));
-                            }
-                        }
-                    }
+        BONGOCAT_LOG_INFO("Input monitoring stopped");
 
-                    if (!found_new_device && adaptive_check_interval_sec < MAX_ADAPTIVE_CHECK_INTERVAL_SEC) {
-                        adaptive_check_interval_sec =
-                            (adaptive_check_interval_sec < MID_ADAPTIVE_CHECK_INTERVAL_SEC)
-                                ? MID_ADAPTIVE_CHECK_INTERVAL_SEC
-                                : MAX_ADAPTIVE_CHECK_INTERVAL_SEC;
-                        BONGOCAT_LOG_DEBUG("Increased device check interval to %d seconds", adaptive_check_interval_sec);
-                    } else if (found_new_device && adaptive_check_interval_sec > START_ADAPTIVE_CHECK_INTERVAL_SEC) {
-                        adaptive_check_interval_sec = START_ADAPTIVE_CHECK_INTERVAL_SEC;
-                        BONGOCAT_LOG_DEBUG("Reset device check interval to %d seconds", START_ADAPTIVE_CHECK_INTERVAL_SEC);
-                    }
-                }
-                continue;
-            }
+        return nullptr;
+    }
 
+    // =============================================================================
+    // INPUT REPLAY
+    // =============================================================================
 
-            // Handle ready devices
-            for (nfds_t p = 0; p < nfds; p++) {
-                if (pfds[p].revents & POLLIN) {
-                    const ssize_t rd = read(pfds[p].fd, ev, sizeof(ev));
-                    if (rd < 0) {
-                        if (errno == EAGAIN) continue;
-                        BONGOCAT_LOG_WARNING("Read error on fd=%d: %s", pfds[p].fd, strerror(errno));
-                        close(pfds[p].fd);
-                        // pfds[p].fd is only a reference, reset also the owner (unique_fd)
-                        for (size_t i = 0; i < input._unique_devices.count; i++) {
-                            if (input._unique_devices[i].fd._fd == pfds[p].fd) {
-                                input._unique_devices[i].fd._fd = -1;
-                                pfds[i].fd = -1;
-                                break;
-                            }
-                        }
-                        pfds[p].fd = -1;
-                        continue;
-                    }
-                    assert(rd >= 0);
-                    if (rd == 0 || static_cast<size_t>(rd) % sizeof(input_event) != 0) {
-                        BONGOCAT_LOG_WARNING("EOF or partial read on fd=%d", pfds[p].fd);
-                        close(pfds[p].fd);
-                        // pfds[p].fd is only a reference, reset also the owner (unique_fd)
-                        for (size_t i = 0; i < input._unique_devices.count; i++) {
-                            if (input._unique_devices[i].fd._fd == pfds[p].fd) {
-                                input._unique_devices[i].fd._fd = -1;
-                                pfds[i].fd = -1;
-                                break;
-                            }
-                        }
-                        pfds[p].fd = -1;
-                        continue;
-                    }
+    static void sleep_us(time_us_t us) {
+        timespec ts{ .tv_sec = static_cast<time_t>(us / 1000000), .tv_nsec = static_cast<long>((us % 1000000) * 1000) };
+        while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+    }
 
-                    assert(rd >= 0);
-                    assert(sizeof(input_event) > 0);
-                    const auto num_events =  static_cast<ssize_t>(static_cast<size_t>(rd) / sizeof(input_event));
-                    bool key_pressed = false;
-                    for (ssize_t j = 0; j < num_events; j++) {
-                        if (ev[j].type == EV_KEY && ev[j].value == 1) {
-                            key_pressed = true;
-                            if (enable_debug) {
-                                BONGOCAT_LOG_VERBOSE("Key event: fd=%d, code=%d, time=%lld.%06lld",
-                                                     pfds[p].fd, ev[j].code,
-                                                     ev[j].time.tv_sec, ev[j].time.tv_usec);
-                            } else {
-                                // break early, when no debug (no print needed for every key press)
-                                break;
-                            }
-                        }
-                    }
+    /// feed a recorded input_event stream (see input_source_t) through the same path as live devices,
+    /// one batch per SYN_REPORT, paced by the recorded timestamps or as fast as possible
+    static void* replay_input_thread(void* arg) {
+        assert(arg);
+        animation::animation_session_t& trigger_ctx = *static_cast<animation::animation_session_t *>(arg);
+        assert(trigger_ctx._input);
+        input_context_t& input = *trigger_ctx._input;
+        const input_source_t& source = input._source;
+        assert(source.replay_path != nullptr);
 
-                    const timestamp_ms_t now = get_current_time_ms();
-                    if (key_pressed) {
-                        const time_ms_t duration_ms = now - input._latest_kpm_update_ms;
-                        time_ms_t min_key_press_check_time_ms = timeout*2;
-                        if (current_config.input_fps > 0) {
-                            min_key_press_check_time_ms = 2000 / current_config.input_fps;
-                        } else if (current_config.fps > 0) {
-                            min_key_press_check_time_ms = 2000 / current_config.fps;
-                        }
-                        if (duration_ms >= min_key_press_check_time_ms) {
-                            const int input_kpm_counter = atomic_load(&input._input_kpm_counter);
-                            if (input_kpm_counter > 0) {
-                                if (duration_ms > 0) {
-                                    const double duration_min = static_cast<double>(duration_ms) / 60000.0;
-                                    assert(duration_min > 0.0);
-                                    input.shm->kpm = static_cast<int>(static_cast<double>(input_kpm_counter) / duration_min);
-                                } else {
-                                    input.shm->kpm = 0;
-                                }
-                                atomic_store(&input._input_kpm_counter, 0);
-                                input._latest_kpm_update_ms = now;
-                            }
-                        }
-                        input.shm->last_key_pressed_timestamp = now;
-                        atomic_fetch_add(&input.shm->input_counter, 1);
-                        atomic_fetch_add(&input._input_kpm_counter, 1);
-                        trigger(trigger_ctx);
-                    } else {
-                        if (input.shm->kpm > 0 && now - input._latest_kpm_update_ms >= RESET_KPM_TIMEOUT_MS) {
-                            input.shm->kpm = 0;
-                            atomic_store(&input._input_kpm_counter, 0);
-                            input._latest_kpm_update_ms = now;
-                        }
-                    }
-                }
+        FileDescriptor fd = strcmp(source.replay_path, "-") == 0
+            ? FileDescriptor(dup(STDIN_FILENO))
+            : FileDescriptor(open(source.replay_path, O_RDONLY | O_CLOEXEC));
+        if (fd._fd < 0) {
+            atomic_store(&input._capture_input_running, false);
+            BONGOCAT_LOG_ERROR("Failed to open input replay %s: %s", source.replay_path, strerror(errno));
+            return nullptr;
+        }
+        BONGOCAT_LOG_INFO("Replaying input events from %s (%s)", source.replay_path, source.replay_fast ? "as fast as possible" : "recorded timing");
 
-                if (pfds[p].revents & (POLLERR | POLLHUP | POLLNVAL)) {
-                    close(pfds[p].fd);
-                    // pfds[p].fd is only a reference, reset also the owner (unique_fd)
-                    for (size_t i = 0; i < input._unique_devices.count; i++) {
-                        if (input._unique_devices[i].fd._fd == pfds[p].fd) {
-                            input._unique_devices[i].fd._fd = -1;
-                            pfds[i].fd = -1;
-                            break;
-                        }
-                    }
-                    pfds[p].fd = -1;
-                }
+        // trigger initial render
+        wayland::request_render(trigger_ctx);
+
+        input_event ev[INPUT_EVENT_BUF];
+        size_t buffered_bytes = 0;              // pipes can return partial records
+        size_t replayed_events = 0;
+        timestamp_us_t first_event_us = -1;
+        const timestamp_us_t replay_start_us = get_current_time_us();
+        // KPM runs on the replayed timestamps from here
+        input._latest_kpm_update_ms = replay_start_us / 1000;
+
+        atomic_store(&input._capture_input_running, true);
+        while (atomic_load(&input._capture_input_running)) {
+            pollfd pfd = { .fd = fd._fd, .events = POLLIN, .revents = 0 };
+            const int poll_result = poll(&pfd, 1, INPUT_POOL_TIMEOUT_MS);
+            if (poll_result < 0) {
+                if (errno == EINTR) continue;
+                BONGOCAT_LOG_ERROR("Poll error: %s", strerror(errno));
+                break;
+            }
+            if (poll_result == 0) {
+                continue;
             }
 
-            // Revalidate valid devices
-            do {
-                size_t valid_devices = 0;
-                for (size_t i = 0; i < input._unique_devices.count; i++) {
-                    const char* device_path = input._unique_devices[i].device_path;
+            const ssize_t rd = read(fd._fd, reinterpret_cast<uint8_t *>(ev) + buffered_bytes, sizeof(ev) - buffered_bytes);
+            if (rd < 0) {
+                if (errno == EINTR || errno == EAGAIN) continue;
+                BONGOCAT_LOG_ERROR("Failed to read input replay: %s", strerror(errno));
+                break;
+            }
+            if (rd == 0) {
+                BONGOCAT_LOG_INFO("Input replay finished: %zu events", replayed_events);
+                break;
+            }
+            buffered_bytes += static_cast<size_t>(rd);
+            const size_t num_events = buffered_bytes / sizeof(input_event);
+
+            size_t frame_start = 0;
+            while (frame_start < num_events && atomic_load(&input._capture_input_running)) {
+                size_t frame_end = frame_start;
+                while (frame_end < num_events && !(ev[frame_end].type == EV_SYN && ev[frame_end].code == SYN_REPORT)) {
+                    frame_end++;
+                }
+                frame_end = frame_end < num_events ? frame_end + 1 : num_events;
 
-                    bool is_valid = false;
-                    // Check if existing fd is still valid
-                    if (input._unique_devices[i].fd._fd >= 0) {
-                        if (is_open_device_valid(input._unique_devices[i].fd._fd)) {
-                            is_valid = true;
-                        } else {
-                            close_fd(input._unique_devices[i].fd);
-                        }
+                const timestamp_us_t event_us = event_time_us(ev[frame_start]);
+                if (first_event_us < 0) {
+                    first_event_us = event_us;
+                }
+                // recorded timestamps are rebased onto the replay start, KPM and the animation read the event time
+                const timestamp_us_t replay_us = replay_start_us + (event_us - first_event_us);
+                if (source.replay_fast) {
+                    // the animation runs on the event timestamps, it has to see every event: wait for room instead of dropping
+                    size_t key_events = 0;
+                    for (size_t i = frame_start; i < frame_end; i++) {
+                        key_events += is_key_event(ev[i]) ? 1 : 0;
                     }
-
-                    if (!is_valid) {
-                        // reopen device
-                        if (int new_fd = open(device_path, O_RDONLY | O_NONBLOCK | O_CLOEXEC); new_fd >= 0) {
-                            if (is_open_device_valid(input._unique_devices[i].fd._fd)) {
-                                input._unique_devices[i].fd = FileDescriptor(new_fd);
-                                new_fd = -1;
-                                BONGOCAT_LOG_VERBOSE("Re-opened input device: %s (fd=%d)", device_path, input._unique_devices[i].fd._fd);
-                                is_valid = true;
-                            } else {
-                                close(new_fd);
-                                new_fd = -1;
-                                BONGOCAT_LOG_VERBOSE("Opened but invalid device: %s", device_path);
-                            }
-                        } else {
-                            BONGOCAT_LOG_VERBOSE("Failed to re-open %s: %s", device_path, strerror(errno));
-                        }
+                    key_events = key_events < KEY_EVENT_RING_SIZE ? key_events : KEY_EVENT_RING_SIZE;
+                    while (key_event_ring_free(input.shm->key_events) < key_events && atomic_load(&input._capture_input_running) &&
+                           !atomic_load(&trigger_ctx.anim._suspended)) {
+                        sleep_us(REPLAY_RING_FULL_WAIT_US);
                     }
-
-                    if (is_valid) {
-                        valid_devices++;
-                    } else {
-                        // reset to invalid
-                        close_fd(input._unique_devices[i].fd);
+                } else {
+                    // short slices, stay responsive to stop
+                    for (timestamp_us_t now_us = get_current_time_us(); now_us < replay_us && atomic_load(&input._capture_input_running);
+                         now_us = get_current_time_us()) {
+                        const time_us_t remaining_us = replay_us - now_us;
+                        sleep_us(remaining_us < INPUT_POOL_TIMEOUT_MS * 1000 ? remaining_us : INPUT_POOL_TIMEOUT_MS * 1000);
                     }
                 }
-
-                track_valid_devices = valid_devices;
-                if (valid_devices == 0) {
-                    BONGOCAT_LOG_VERBOSE("All input devices became unavailable");
+                for (size_t i = frame_start; i < frame_end; i++) {
+                    ev[i].time.tv_sec = static_cast<decltype(ev[i].time.tv_sec)>(replay_us / 1000000);
+                    ev[i].time.tv_usec = static_cast<decltype(ev[i].time.tv_usec)>(replay_us % 1000000);
                 }
-            } while (false);
-        }
-        atomic_store(&input._capture_input_running, false);
-        if (track_valid_devices == 0) {
-            BONGOCAT_LOG_ERROR("All input devices are unavailable");
-        }
 
-        // Will run only on normal return
-        pthread_cleanup_pop(1);  // 1 = call cleanup even if not canceled
+                process_input_events(input, trigger_ctx, &ev[frame_start], frame_end - frame_start, 0,
+                                     atomic_load(&trigger_ctx.anim._suspended), INPUT_POOL_TIMEOUT_MS);
+                replayed_events += frame_end - frame_start;
+                frame_start = frame_end;
+            }
 
-        // done when callback cleanup_input_thread
-        //cleanup_input_thread_context(arg);
-        assert(!input._device_paths);
-        assert(!input._unique_devices);
-        assert(!input._unique_paths_indices);
-        assert(input._unique_paths_indices_capacity == 0);
+            // keep a partial record for the next read
+            const size_t consumed_bytes = frame_start * sizeof(input_event);
+            buffered_bytes -= consumed_bytes;
+            if (buffered_bytes > 0) {
+                memmove(ev, reinterpret_cast<uint8_t *>(ev) + consumed_bytes, buffered_bytes);
+            }
+        }
+        atomic_store(&input._capture_input_running, false);
+        BONGOCAT_LOG_DEBUG("Dropped key events (ring full): %u", atomic_load(&input.shm->key_events.dropped));
+        // a fast replay's animation continues from the end of the recording on the tick timer
+        trigger(trigger_ctx);
 
-        BONGOCAT_LOG_INFO("Input monitoring stopped");
+        BONGOCAT_LOG_INFO("Input replay stopped");
 
         return nullptr;
     }
 
-    created_result_t<input_context_t> create(const config::config_t& config) {
+    created_result_t<input_context_t> create(const config::config_t& config, const input_source_t& source) {
         input_context_t ret;
 
-        if (config.num_keyboard_devices <= 0) {
+        if (source.type == input_source_type_t::Replay && source.replay_path == nullptr) {
+            BONGOCAT_LOG_ERROR("No input replay file specified");
+            return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
+        }
+        ret._source = source;
+        if (source.type == input_source_type_t::Devices && config.num_keyboard_devices <= 0) {
             BONGOCAT_LOG_ERROR("No input devices specified");
             return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
         }
@@ -504,7 +1122,7 @@ namespace bongocat::platform::input {
     }
 
     bongocat_error_t start_monitoring(input_context_t& input, animation::animation_session_t& trigger_ctx, const config::config_t& config) {
-        if (config.num_keyboard_devices <= 0) {
+        if (input._source.type == input_source_type_t::Devices && config.num_keyboard_devices <= 0) {
             BONGOCAT_LOG_ERROR("No input devices specified");
             return bongocat_error_t::BONGOCAT_ERROR_INVALID_PARAM;
         }
@@ -534,9 +1152,28 @@ namespace bongocat::platform::input {
         assert(input._local_copy_config != nullptr);
         *input._local_copy_config = config;
 
+        // recording lives as long as the input context (kept over restarts)
+        if (input._source.type == input_source_type_t::Devices && input._source.record_path != nullptr) {
+            input._record_fd = FileDescriptor(open(input._source.record_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644));
+            if (input._record_fd._fd < 0) {
+                BONGOCAT_LOG_ERROR("Failed to open input recording %s: %s", input._source.record_path, strerror(errno));
+                return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
+            }
+            BONGOCAT_LOG_INFO("Recording input events to %s", input._source.record_path);
+        }
+
+        if (input._source.type == input_source_type_t::Devices) {
+            if (const bongocat_error_t loop_result = create_event_loop(input); loop_result != bongocat_error_t::BONGOCAT_SUCCESS) {
+                return loop_result;
+            }
+            create_hotplug_watch(input);
+        }
+
         // start input monitoring
         trigger_ctx._input = &input;
-        const int result = pthread_create(&input._input_thread, nullptr, capture_input_thread, &trigger_ctx);
+        const int result = pthread_create(&input._input_thread, nullptr,
+                                          input._source.type == input_source_type_t::Replay ? replay_input_thread : capture_input_thread,
+                                          &trigger_ctx);
         if (result != 0) {
             BONGOCAT_LOG_ERROR("Failed to start input monitoring thread: %s", strerror(errno));
             return bongocat_error_t::BONGOCAT_ERROR_THREAD;
@@ -552,6 +1189,7 @@ namespace bongocat::platform::input {
         if (input._input_thread) {
             BONGOCAT_LOG_DEBUG("Input monitoring thread");
             atomic_store(&input._capture_input_running, false);
+            notify_eventfd(input._shutdown_efd);
             //pthread_cancel(ctx->_input_thread);
             if (stop_thread_graceful_or_cancel(input._input_thread, input._capture_input_running) != 0) {
                 BONGOCAT_LOG_ERROR("Failed to join input thread: %s", strerror(errno));
@@ -562,11 +1200,17 @@ namespace bongocat::platform::input {
         // already done when stop current input thread
         //cleanup_input_thread_context(ctx);
         assert(!input._device_paths);
-        assert(!input._unique_paths_indices);
-        assert(!input._unique_devices);
-        assert(input._unique_paths_indices_capacity == 0);
+        assert(!input._devices.devices);
 
         input_context_t ret;
+        ret._source = input._source;
+        ret._record_fd = bongocat::move(input._record_fd);
+        ret._epoll_fd = bongocat::move(input._epoll_fd);
+        ret._update_efd = bongocat::move(input._update_efd);
+        ret._shutdown_efd = bongocat::move(input._shutdown_efd);
+        ret._hotplug_fd = bongocat::move(input._hotplug_fd);
+        ret._hotplug_wd = input._hotplug_wd;
+        ret._hotplug_by_id_wd = input._hotplug_by_id_wd;
 
         // reset stats
         //ret._latest_kpm_update_ms = get_current_time_ms();
@@ -594,15 +1238,25 @@ namespace bongocat::platform::input {
         //    BONGOCAT_LOG_DEBUG("Input context in animation differs from animation trigger input context");
         //}
 
+        // fresh ring: releases of keys held right now are gone, the counter has to move on for the animation thread
+        if (input.shm != nullptr) {
+            atomic_store(&ret.shm->key_events.resets, atomic_load(&input.shm->key_events.resets) + 1u);
+        }
+
         input = bongocat::move(ret);
         trigger_ctx._input = &input;
         // start input monitoring
-        if (pthread_create(&input._input_thread, nullptr, capture_input_thread, &trigger_ctx) != 0) {
+        if (pthread_create(&input._input_thread, nullptr,
+                           input._source.type == input_source_type_t::Replay ? replay_input_thread : capture_input_thread,
+                           &trigger_ctx) != 0) {
             BONGOCAT_LOG_ERROR("Failed to fork input monitoring process: %s", strerror(errno));
             cleanup_input_thread_context(input);
             return bongocat_error_t::BONGOCAT_ERROR_THREAD;
         }
 
+        // animation thread picks up the new ring (and forgets held keys)
+        trigger(trigger_ctx);
+
         BONGOCAT_LOG_INFO("Input monitoring restarted");
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
@@ -611,6 +1265,7 @@ namespace bongocat::platform::input {
         atomic_store(&ctx._capture_input_running, false);
         if (ctx._input_thread) {
             BONGOCAT_LOG_DEBUG("Stopping input thread");
+            notify_eventfd(ctx._shutdown_efd);
             //pthread_cancel(ctx->_input_thread);
             if (stop_thread_graceful_or_cancel(ctx._input_thread, ctx._capture_input_running) != 0) {
                 BONGOCAT_LOG_ERROR("Failed to join input thread: %s", strerror(errno));
@@ -624,6 +1279,7 @@ namespace bongocat::platform::input {
         assert(ctx._local_copy_config != nullptr);
 
         *ctx._local_copy_config = config;
+        notify_eventfd(ctx._update_efd);
         /// @NOTE: input thread required so the new config has affect
     }
 }
\ No newline at end of file
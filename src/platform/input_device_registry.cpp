@@ -0,0 +1,399 @@
+#include "platform/input_device_registry.h"
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <glob.h>
+#include <unistd.h>
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+namespace bongocat::platform::input {
+    static inline constexpr auto EVENT_NODE_NAME = "event*";
+    static inline constexpr size_t BITS_PER_LONG = sizeof(unsigned long) * CHAR_BIT;
+
+    static constexpr size_t bits_to_longs(size_t bits) {
+        return (bits + BITS_PER_LONG - 1) / BITS_PER_LONG;
+    }
+    static bool test_bit(const unsigned long *bits, size_t bit) {
+        return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1ul;
+    }
+    static void set_bit(unsigned long *bits, size_t bit) {
+        bits[bit / BITS_PER_LONG] |= 1ul << (bit % BITS_PER_LONG);
+    }
+
+    // =============================================================================
+    // PROBING
+    // =============================================================================
+
+    input_device_class_t probe_input_device(int fd, char *name, size_t name_size, uint16_t& num_keys) {
+        num_keys = 0;
+        if (name != nullptr && name_size > 0) {
+            const int len = ioctl(fd, EVIOCGNAME(name_size - 1), name);
+            name[len > 0 ? (static_cast<size_t>(len) < name_size ? static_cast<size_t>(len) : name_size - 1) : 0] = '\0';
+        }
+
+        unsigned long ev_bits[bits_to_longs(EV_CNT)]{};
+        unsigned long key_bits[bits_to_longs(KEY_CNT)]{};
+        unsigned long rel_bits[bits_to_longs(REL_CNT)]{};
+        unsigned long abs_bits[bits_to_longs(ABS_CNT)]{};
+        if (ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits) < 0) {
+            return input_device_class_t::Unknown;
+        }
+        if (test_bit(ev_bits, EV_KEY)) {
+            ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_bits)), key_bits);
+        }
+        if (test_bit(ev_bits, EV_REL)) {
+            ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel_bits)), rel_bits);
+        }
+        if (test_bit(ev_bits, EV_ABS)) {
+            ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(abs_bits)), abs_bits);
+        }
+
+        for (size_t key = 0; key < BTN_MISC; key++) {
+            if (test_bit(key_bits, key)) {
+                num_keys++;
+            }
+        }
+
+        // same rule as udev input_id: the first row of a keyboard (KEY_ESC..KEY_D)
+        bool keyboard = true;
+        for (size_t key = KEY_ESC; key <= KEY_D; key++) {
+            if (!test_bit(key_bits, key)) {
+                keyboard = false;
+                break;
+            }
+        }
+        if (keyboard) {
+            return input_device_class_t::Keyboard;
+        }
+        if ((test_bit(rel_bits, REL_X) && test_bit(rel_bits, REL_Y)) ||
+            (test_bit(abs_bits, ABS_X) && test_bit(abs_bits, ABS_Y))) {
+            return input_device_class_t::Pointer;
+        }
+        if (num_keys > 0) {
+            return input_device_class_t::Buttons;
+        }
+        return input_device_class_t::Other;
+    }
+
+    bool set_key_event_mask(int fd) {
+        // type 0 masks whole event types: EV_MSC scan codes, EV_REL motion, EV_ABS, EV_LED ... are dropped per client.
+        // EV_SYN can't be masked, but evdev drops a SYN_REPORT that ends an empty frame, so motion alone never wakes us.
+        // autorepeat (EV_KEY value 2) has no mask, user space still skips it
+        unsigned long type_bits[bits_to_longs(EV_CNT)]{};
+        set_bit(type_bits, EV_KEY);
+        const input_mask mask{
+            .type = EV_SYN,
+            .codes_size = sizeof(type_bits),
+            .codes_ptr = reinterpret_cast<uint64_t>(type_bits),
+        };
+        return ioctl(fd, EVIOCSMASK, &mask) == 0;
+    }
+
+    static bool stat_device_identity(const struct stat& st, dev_t& rdev, ino_t& ino) {
+        if (S_ISCHR(st.st_mode)) {
+            rdev = st.st_rdev;
+            ino = 0;
+            return true;
+        }
+        if (S_ISFIFO(st.st_mode)) {
+            rdev = 0;
+            ino = st.st_ino;
+            return true;
+        }
+        return false;
+    }
+
+    static bool same_identity(const input_device_t& a, const input_device_t& b) {
+        return (a.rdev != 0 || a.ino != 0) && a.rdev == b.rdev && a.ino == b.ino;
+    }
+
+    void registry_refresh_device(input_device_t& device, int fd) {
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || !stat_device_identity(st, device.rdev, device.ino)) {
+            return;
+        }
+        if (device.device_class == input_device_class_t::Unknown) {
+            // FIFO stand-ins can't be probed, they carry whatever the test writes
+            device.device_class = S_ISCHR(st.st_mode)
+                ? probe_input_device(fd, device.name, sizeof(device.name), device.num_keys)
+                : input_device_class_t::Keyboard;
+        }
+    }
+
+    /// identity, name and class of path, false if it's not a device (missing, regular file)
+    static bool probe_path(const char *path, input_device_t& device) {
+        struct stat st{};
+        if (stat(path, &st) != 0 || !stat_device_identity(st, device.rdev, device.ino)) {
+            return false;
+        }
+        device.device_class = input_device_class_t::Unknown;
+        device.name[0] = '\0';
+        // no permission: identity only, class stays Unknown
+        if (const FileDescriptor fd(open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)); fd._fd >= 0) {
+            registry_refresh_device(device, fd._fd);
+        }
+        return true;
+    }
+
+    // =============================================================================
+    // SELECTORS
+    // =============================================================================
+
+    enum class selector_kind_t : uint8_t {
+        Path,
+        Glob,
+        Auto,
+        Name,
+    };
+
+    static selector_kind_t selector_kind(const char *selector) {
+        if (strcmp(selector, INPUT_DEVICE_SELECT_AUTO) == 0) {
+            return selector_kind_t::Auto;
+        }
+        if (strncmp(selector, INPUT_DEVICE_SELECT_NAME_PREFIX, strlen(INPUT_DEVICE_SELECT_NAME_PREFIX)) == 0) {
+            return selector_kind_t::Name;
+        }
+        if (strpbrk(selector, "*?[") != nullptr) {
+            return selector_kind_t::Glob;
+        }
+        return selector_kind_t::Path;
+    }
+
+    static bool is_event_node(const input_device_registry_t& registry, const char *path) {
+        char pattern[INPUT_DEVICE_PATH_BUF];
+        snprintf(pattern, sizeof(pattern), "%s/%s", registry.device_dir, EVENT_NODE_NAME);
+        return fnmatch(pattern, path, FNM_PATHNAME) == 0;
+    }
+
+    static bool has_keys(const input_device_t& device) {
+        return device.device_class == input_device_class_t::Keyboard || device.device_class == input_device_class_t::Buttons;
+    }
+
+    /// probed device at path is picked by a (non-literal) selector
+    static bool selector_accepts(const input_device_registry_t& registry, const char *selector, const char *path, const input_device_t& device) {
+        switch (selector_kind(selector)) {
+            case selector_kind_t::Path:
+                return strcmp(selector, path) == 0;
+            case selector_kind_t::Glob:
+                return fnmatch(selector, path, FNM_PATHNAME) == 0 && has_keys(device);
+            case selector_kind_t::Auto:
+                return is_event_node(registry, path) && device.device_class == input_device_class_t::Keyboard;
+            case selector_kind_t::Name:
+                return is_event_node(registry, path) && has_keys(device) &&
+                       fnmatch(selector + strlen(INPUT_DEVICE_SELECT_NAME_PREFIX), device.name, 0) == 0;
+        }
+        return false;
+    }
+
+    // =============================================================================
+    // REGISTRY
+    // =============================================================================
+
+    static ssize_t find_by_identity(const input_device_registry_t& registry, const input_device_t& device) {
+        for (size_t i = 0; i < registry.count; i++) {
+            if (registry.devices[i].path[0] != '\0' && same_identity(registry.devices[i], device)) {
+                return static_cast<ssize_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    static ssize_t find_by_path(const input_device_registry_t& registry, const char *path) {
+        for (size_t i = 0; i < registry.count; i++) {
+            if (strcmp(registry.devices[i].path, path) == 0) {
+                return static_cast<ssize_t>(i);
+            }
+        }
+        return -1;
+    }
+
+    static ssize_t add_device(input_device_registry_t& registry, const char *path, const input_device_t& probe, bool pinned) {
+        if (strlen(path) >= INPUT_DEVICE_PATH_BUF) {
+            BONGOCAT_LOG_WARNING("Input device path too long: %s", path);
+            return -1;
+        }
+        // reuse slots of removed devices, keeps indices (and epoll tags) of the others
+        size_t index = registry.count;
+        for (size_t i = 0; i < registry.count; i++) {
+            if (registry.devices[i].path[0] == '\0') {
+                index = i;
+                break;
+            }
+        }
+        if (index >= registry.devices.count) {
+            BONGOCAT_LOG_WARNING("Max input devices reached: %zu", registry.devices.count);
+            return -1;
+        }
+
+        input_device_t& device = registry.devices[index];
+        snprintf(device.path, sizeof(device.path), "%s", path);
+        snprintf(device.name, sizeof(device.name), "%s", probe.name);
+        device.rdev = probe.rdev;
+        device.ino = probe.ino;
+        device.device_class = probe.device_class;
+        device.num_keys = probe.num_keys;
+        device.pinned = pinned;
+        device.event_mask = false;
+        if (index == registry.count) {
+            registry.count++;
+        }
+
+        BONGOCAT_LOG_DEBUG("Input device %s: '%s' (%s, %u keys)", device.path, device.name,
+                           input_device_class_string(device.device_class), device.num_keys);
+        return static_cast<ssize_t>(index);
+    }
+
+    static void add_selected(input_device_registry_t& registry, const char *selector) {
+        const selector_kind_t kind = selector_kind(selector);
+        if (kind == selector_kind_t::Path) {
+            input_device_t probe;
+            const bool present = probe_path(selector, probe);
+            if (find_by_path(registry, selector) >= 0) {
+                return;
+            }
+            if (const ssize_t same = present ? find_by_identity(registry, probe) : -1; same >= 0) {
+                BONGOCAT_LOG_DEBUG("Input device %s is the same device as %s", selector, registry.devices[static_cast<size_t>(same)].path);
+                return;
+            }
+            if (present && probe.device_class != input_device_class_t::Unknown && !has_keys(probe)) {
+                BONGOCAT_LOG_WARNING("Input device %s ('%s') has no keys (%s)", selector, probe.name, input_device_class_string(probe.device_class));
+            }
+            add_device(registry, selector, probe, true);
+            return;
+        }
+
+        char pattern[INPUT_DEVICE_PATH_BUF];
+        if (kind == selector_kind_t::Glob) {
+            snprintf(pattern, sizeof(pattern), "%s", selector);
+        } else {
+            snprintf(pattern, sizeof(pattern), "%s/%s", registry.device_dir, EVENT_NODE_NAME);
+        }
+        glob_t matches{};
+        if (glob(pattern, 0, nullptr, &matches) != 0) {
+            BONGOCAT_LOG_VERBOSE("No input devices match %s", selector);
+            globfree(&matches);
+            return;
+        }
+        for (size_t m = 0; m < matches.gl_pathc; m++) {
+            const char *path = matches.gl_pathv[m];
+            input_device_t probe;
+            if (!probe_path(path, probe) || !selector_accepts(registry, selector, path, probe)) {
+                continue;
+            }
+            if (find_by_path(registry, path) >= 0 || find_by_identity(registry, probe) >= 0) {
+                continue;
+            }
+            add_device(registry, path, probe, false);
+        }
+        globfree(&matches);
+    }
+
+    bongocat_error_t build_input_device_registry(input_device_registry_t& registry, const char *const *selectors, size_t num_selectors, const char *device_dir) {
+        assert(device_dir != nullptr);
+        release_input_device_registry(registry);
+
+        registry.devices = make_allocated_array<input_device_t>(MAX_INPUT_DEVICES);
+        if (!registry.devices) {
+            BONGOCAT_LOG_ERROR("Failed to allocate memory for input devices");
+            return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+        }
+        registry.count = 0;
+        registry.selectors = selectors;
+        registry.num_selectors = num_selectors;
+        registry.device_dir = device_dir;
+
+        for (size_t i = 0; i < num_selectors; i++) {
+            if (selectors[i] != nullptr) {
+                add_selected(registry, selectors[i]);
+            }
+        }
+
+        BONGOCAT_LOG_DEBUG("Selected %zu input devices from %zu keyboard_device entries", registry.count, num_selectors);
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    ssize_t registry_lookup_or_add(input_device_registry_t& registry, const char *path) {
+        if (const ssize_t index = find_by_path(registry, path); index >= 0) {
+            return index;
+        }
+
+        input_device_t probe;
+        if (!probe_path(path, probe)) {
+            return -1;
+        }
+        for (size_t i = 0; i < registry.num_selectors; i++) {
+            const char *selector = registry.selectors[i];
+            if (selector == nullptr || selector_kind(selector) == selector_kind_t::Path ||
+                !selector_accepts(registry, selector, path, probe)) {
+                continue;
+            }
+            if (find_by_identity(registry, probe) >= 0) {
+                return -1;
+            }
+            return add_device(registry, path, probe, false);
+        }
+        return -1;
+    }
+
+    bool registry_is_duplicate(const input_device_registry_t& registry, size_t index) {
+        assert(index < registry.count);
+        const input_device_t& device = registry.devices[index];
+        for (size_t i = 0; i < registry.count; i++) {
+            if (i != index && registry.devices[i].fd._fd >= 0 && same_identity(registry.devices[i], device)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void registry_remove_device(input_device_registry_t& registry, size_t index) {
+        assert(index < registry.count);
+        input_device_t& device = registry.devices[index];
+        assert(device.fd._fd < 0);
+        device.path[0] = '\0';
+        device.name[0] = '\0';
+        device.rdev = 0;
+        device.ino = 0;
+        device.device_class = input_device_class_t::Unknown;
+        device.num_keys = 0;
+        device.pinned = false;
+        device.event_mask = false;
+        while (registry.count > 0 && registry.devices[registry.count - 1].path[0] == '\0') {
+            registry.count--;
+        }
+    }
+
+    void release_input_device_registry(input_device_registry_t& registry) {
+        release_allocated_array(registry.devices);
+        registry.count = 0;
+        registry.selectors = nullptr;
+        registry.num_selectors = 0;
+        registry.device_dir = nullptr;
+    }
+
+    bool same_input_device(const char *a, const char *b) {
+        if (strcmp(a, b) == 0) {
+            return true;
+        }
+        struct stat st_a{};
+        struct stat st_b{};
+        return stat(a, &st_a) == 0 && stat(b, &st_b) == 0 &&
+               S_ISCHR(st_a.st_mode) && S_ISCHR(st_b.st_mode) && st_a.st_rdev == st_b.st_rdev;
+    }
+
+    const char *input_device_class_string(input_device_class_t device_class) {
+        switch (device_class) {
+            case input_device_class_t::Unknown: return "unknown";
+            case input_device_class_t::Keyboard: return "keyboard";
+            case input_device_class_t::Buttons: return "buttons";
+            case input_device_class_t::Pointer: return "pointer";
+            case input_device_class_t::Other: return "other";
+        }
+        return "unknown";
+    }
+}
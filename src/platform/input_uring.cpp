@@ -0,0 +1,275 @@
+#include "platform/input_uring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cassert>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+
+#ifdef FEATURE_INPUT_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace bongocat::platform::input {
+#ifdef FEATURE_INPUT_IO_URING
+    // =============================================================================
+    // RING
+    // =============================================================================
+
+    static int sys_io_uring_setup(unsigned entries, io_uring_params *params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+    static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, size_t arg_size) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size));
+    }
+
+    template <typename T>
+    static T* ring_ptr(void *rings, uint32_t offset) {
+        return reinterpret_cast<T *>(static_cast<uint8_t *>(rings) + offset);
+    }
+
+    bongocat_error_t uring_setup(io_uring_t& ring, unsigned entries) {
+        uring_release(ring);
+
+        io_uring_params params{};
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 2;
+        ring.ring_fd = FileDescriptor(sys_io_uring_setup(entries, &params));
+        if (ring.ring_fd._fd < 0) {
+            BONGOCAT_LOG_DEBUG("io_uring_setup failed: %s", strerror(errno));
+            return bongocat_error_t::BONGOCAT_ERROR_INPUT;
+        }
+        // single mmap (5.4), wait timeout without a timeout sqe (5.11)
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+            BONGOCAT_LOG_DEBUG("io_uring features missing: 0x%x", params.features);
+            uring_release(ring);
+            return bongocat_error_t::BONGOCAT_ERROR_INPUT;
+        }
+
+        const size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        const size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        ring.rings_size = sq_size > cq_size ? sq_size : cq_size;
+        ring.rings = mmap(nullptr, ring.rings_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.ring_fd._fd, IORING_OFF_SQ_RING);
+        if (ring.rings == MAP_FAILED) {
+            ring.rings = nullptr;
+            BONGOCAT_LOG_DEBUG("io_uring ring mmap failed: %s", strerror(errno));
+            uring_release(ring);
+            return bongocat_error_t::BONGOCAT_ERROR_INPUT;
+        }
+        ring.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, ring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.ring_fd._fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            BONGOCAT_LOG_DEBUG("io_uring sqes mmap failed: %s", strerror(errno));
+            uring_release(ring);
+            return bongocat_error_t::BONGOCAT_ERROR_INPUT;
+        }
+        ring.sqes = static_cast<io_uring_sqe *>(sqes);
+
+        ring.sq_head = ring_ptr<unsigned>(ring.rings, params.sq_off.head);
+        ring.sq_tail = ring_ptr<unsigned>(ring.rings, params.sq_off.tail);
+        ring.sq_mask = *ring_ptr<unsigned>(ring.rings, params.sq_off.ring_mask);
+        ring.sq_entries = params.sq_entries;
+        ring.sq_local_tail = *ring.sq_tail;
+        // identity mapping, sqes are used in ring order
+        unsigned *sq_array = ring_ptr<unsigned>(ring.rings, params.sq_off.array);
+        for (unsigned i = 0; i < ring.sq_entries; i++) {
+            sq_array[i] = i;
+        }
+
+        ring.cq_head = ring_ptr<unsigned>(ring.rings, params.cq_off.head);
+        ring.cq_tail = ring_ptr<unsigned>(ring.rings, params.cq_off.tail);
+        ring.cq_mask = *ring_ptr<unsigned>(ring.rings, params.cq_off.ring_mask);
+        ring.cqes = ring_ptr<io_uring_cqe>(ring.rings, params.cq_off.cqes);
+
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    io_uring_sqe* uring_get_sqe(io_uring_t& ring) {
+        assert(ring.sqes != nullptr);
+        const unsigned head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+        if (ring.sq_local_tail - head >= ring.sq_entries) {
+            return nullptr;
+        }
+        io_uring_sqe *sqe = &ring.sqes[ring.sq_local_tail & ring.sq_mask];
+        ring.sq_local_tail++;
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    int uring_submit_and_wait(io_uring_t& ring, int timeout_ms) {
+        assert(ring.ring_fd._fd >= 0);
+        __atomic_store_n(ring.sq_tail, ring.sq_local_tail, __ATOMIC_RELEASE);
+        // not consumed yet (also leftovers of an earlier short submit)
+        const unsigned to_submit = ring.sq_local_tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+
+        __kernel_timespec ts{ .tv_sec = timeout_ms / 1000, .tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000LL };
+        io_uring_getevents_arg arg{};
+        arg.sigmask = 0;
+        arg.sigmask_sz = _NSIG / 8;
+        arg.ts = timeout_ms >= 0 ? reinterpret_cast<uint64_t>(&ts) : 0;
+        const int ret = sys_io_uring_enter(ring.ring_fd._fd, to_submit, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        return ret < 0 ? -errno : ret;
+    }
+
+    const io_uring_cqe* uring_peek_cqe(const io_uring_t& ring) {
+        const unsigned head = *ring.cq_head;
+        if (head == __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE)) {
+            return nullptr;
+        }
+        return &ring.cqes[head & ring.cq_mask];
+    }
+
+    void uring_cqe_seen(io_uring_t& ring) {
+        __atomic_store_n(ring.cq_head, *ring.cq_head + 1, __ATOMIC_RELEASE);
+    }
+
+    void uring_prep_poll(io_uring_sqe *sqe, int fd, uint64_t user_data) {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = user_data;
+    }
+
+    void uring_prep_cancel(io_uring_sqe *sqe, uint64_t target_user_data, uint64_t user_data) {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = target_user_data;
+        sqe->user_data = user_data;
+    }
+
+    uint64_t uring_cqe_user_data(const io_uring_cqe *cqe) {
+        return cqe->user_data;
+    }
+    int32_t uring_cqe_res(const io_uring_cqe *cqe) {
+        return cqe->res;
+    }
+
+    void uring_release(io_uring_t& ring) {
+        if (ring.sqes != nullptr) {
+            munmap(ring.sqes, ring.sqes_size);
+        }
+        if (ring.rings != nullptr) {
+            munmap(ring.rings, ring.rings_size);
+        }
+        ring.sqes = nullptr;
+        ring.sqes_size = 0;
+        ring.rings = nullptr;
+        ring.rings_size = 0;
+        ring.sq_head = ring.sq_tail = nullptr;
+        ring.sq_mask = ring.sq_entries = ring.sq_local_tail = 0;
+        ring.cq_head = ring.cq_tail = nullptr;
+        ring.cq_mask = 0;
+        ring.cqes = nullptr;
+        // closing the ring cancels what is still in flight
+        close_fd(ring.ring_fd);
+    }
+#else
+    bongocat_error_t uring_setup(io_uring_t& /*ring*/, unsigned /*entries*/) {
+        BONGOCAT_LOG_DEBUG("io_uring backend not compiled in (FEATURE_INPUT_IO_URING)");
+        return bongocat_error_t::BONGOCAT_ERROR_INPUT;
+    }
+    io_uring_sqe* uring_get_sqe(io_uring_t& /*ring*/) { return nullptr; }
+    int uring_submit_and_wait(io_uring_t& /*ring*/, int /*timeout_ms*/) { return -ENOSYS; }
+    const io_uring_cqe* uring_peek_cqe(const io_uring_t& /*ring*/) { return nullptr; }
+    void uring_cqe_seen(io_uring_t& /*ring*/) {}
+    void uring_prep_poll(io_uring_sqe * /*sqe*/, int /*fd*/, uint64_t /*user_data*/) {}
+    void uring_prep_cancel(io_uring_sqe * /*sqe*/, uint64_t /*target_user_data*/, uint64_t /*user_data*/) {}
+    uint64_t uring_cqe_user_data(const io_uring_cqe * /*cqe*/) { return 0; }
+    int32_t uring_cqe_res(const io_uring_cqe * /*cqe*/) { return -ENOSYS; }
+    void uring_release(io_uring_t& ring) {
+        close_fd(ring.ring_fd);
+    }
+#endif
+
+    io_uring_t::~io_uring_t() {
+        uring_release(*this);
+    }
+
+    io_uring_t::io_uring_t(io_uring_t&& other) noexcept
+        : ring_fd(bongocat::move(other.ring_fd)),
+          rings(other.rings), rings_size(other.rings_size),
+          sqes(other.sqes), sqes_size(other.sqes_size),
+          sq_head(other.sq_head), sq_tail(other.sq_tail), sq_mask(other.sq_mask), sq_entries(other.sq_entries), sq_local_tail(other.sq_local_tail),
+          cq_head(other.cq_head), cq_tail(other.cq_tail), cq_mask(other.cq_mask), cqes(other.cqes)
+    {
+        other.rings = nullptr;
+        other.rings_size = 0;
+        other.sqes = nullptr;
+        other.sqes_size = 0;
+        other.sq_head = other.sq_tail = nullptr;
+        other.sq_mask = other.sq_entries = other.sq_local_tail = 0;
+        other.cq_head = other.cq_tail = nullptr;
+        other.cq_mask = 0;
+        other.cqes = nullptr;
+    }
+
+    io_uring_t& io_uring_t::operator=(io_uring_t&& other) noexcept {
+        if (this != &other) {
+            uring_release(*this);
+            ring_fd = bongocat::move(other.ring_fd);
+            rings = other.rings;
+            rings_size = other.rings_size;
+            sqes = other.sqes;
+            sqes_size = other.sqes_size;
+            sq_head = other.sq_head;
+            sq_tail = other.sq_tail;
+            sq_mask = other.sq_mask;
+            sq_entries = other.sq_entries;
+            sq_local_tail = other.sq_local_tail;
+            cq_head = other.cq_head;
+            cq_tail = other.cq_tail;
+            cq_mask = other.cq_mask;
+            cqes = other.cqes;
+
+            other.rings = nullptr;
+            other.rings_size = 0;
+            other.sqes = nullptr;
+            other.sqes_size = 0;
+            other.sq_head = other.sq_tail = nullptr;
+            other.sq_mask = other.sq_entries = other.sq_local_tail = 0;
+            other.cq_head = other.cq_tail = nullptr;
+            other.cq_mask = 0;
+            other.cqes = nullptr;
+        }
+        return *this;
+    }
+
+    // =============================================================================
+    // INPUT BACKEND
+    // =============================================================================
+
+    // Devices are watched with IORING_OP_POLL_ADD and read with a non-blocking read() once ready, not with IORING_OP_READ:
+    // evdev nodes don't support nowait reads (no FMODE_NOWAIT), so io_uring hands every armed read to an io-wq kernel worker
+    // that blocks in evdev_read, one worker thread per device. Their CPU time is not accounted to the input thread
+    // (RUSAGE_THREAD) and a keyboard wake-up becomes a cross-thread hand-off. Poll requests are completed by the
+    // device wait queue callback without any worker, for evdev nodes and FIFO stand-ins alike.
+
+    bongocat_error_t setup_input_uring(input_uring_t& uring, size_t num_devices) {
+        release_input_uring(uring);
+
+        if (const bongocat_error_t result = uring_setup(uring.ring, INPUT_URING_ENTRIES); result != bongocat_error_t::BONGOCAT_SUCCESS) {
+            return result;
+        }
+        uring.generations = make_allocated_array_with_value<uint32_t>(num_devices, 0);
+        uring.poll_armed = make_allocated_array_with_value<uint8_t>(num_devices, 0);
+        if (!uring.generations || !uring.poll_armed) {
+            BONGOCAT_LOG_ERROR("Failed to allocate memory for io_uring input state");
+            release_input_uring(uring);
+            return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
+        }
+        uring.control_armed = false;
+
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    void release_input_uring(input_uring_t& uring) {
+        // closing the ring cancels the polls still in flight
+        uring_release(uring.ring);
+        release_allocated_array(uring.generations);
+        release_allocated_array(uring.poll_armed);
+        uring.control_armed = false;
+    }
+}
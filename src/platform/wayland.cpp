@@ -145,7 +145,22 @@ reinterpret_cast<const char*>(pos) < \
             BONGOCAT_LOG_INFO("Fullscreen state changed: %s",
                               ctx.wayland_context._fullscreen_detected ? "detected" : "cleared");
 
+            // suspend the pipeline while fullscreen: stop frame callbacks (a hidden surface may never get one),
+            // park the animation thread; commit one empty frame below. Resume draws right away (no frame pending)
+            if (new_state) {
+                platform::LockGuard guard (ctx.wayland_context._frame_cb_lock);
+                if (ctx.wayland_context._frame_cb) {
+                    wl_callback_destroy(ctx.wayland_context._frame_cb);
+                    ctx.wayland_context._frame_cb = nullptr;
+                }
+                atomic_store(&ctx.wayland_context._frame_pending, false);
+                atomic_store(&ctx.wayland_context._redraw_after_frame, false);
+            }
+            animation::set_suspended(ctx.animation_trigger_context->anim, new_state);
+
             if (ctx.wayland_context.ctx_shm != nullptr && atomic_load(&ctx.wayland_context.ctx_shm->configured)) {
+                // background opacity changes, repaint everything
+                request_full_redraw(*ctx.wayland_context.ctx_shm);
                 request_render(*ctx.animation_trigger_context);
             } else {
                 BONGOCAT_LOG_VERBOSE("Wayland not configured yet, skipping request rendering");
@@ -477,6 +492,7 @@ reinterpret_cast<const char*>(pos) < \
         wayland_shared_memory_t& wayland_ctx_shm = *ctx.wayland_context.ctx_shm;
 
         zwlr_layer_surface_v1_ack_configure(ls, serial);
+        request_full_redraw(wayland_ctx_shm);
         atomic_store(&wayland_ctx_shm.configured, true);
         if (atomic_load(&ctx.ready)) {
             request_render(*ctx.animation_trigger_context);
@@ -624,6 +640,7 @@ reinterpret_cast<const char*>(pos) < \
         wayland_shm_buffer_t& wayland_ctx_shm_buffer = *static_cast<wayland_shm_buffer_t *>(data);
 
         if (wayland_ctx_shm_buffer.buffer == buffer) {
+            wayland_ctx_shm_buffer.released_timestamp_us = get_current_time_us();
             atomic_store(&wayland_ctx_shm_buffer.busy, false);
             BONGOCAT_LOG_VERBOSE("wl_buffer.release: buffer %d freed", wayland_ctx_shm_buffer.index);
 
@@ -646,6 +663,26 @@ reinterpret_cast<const char*>(pos) < \
         .release = buffer_release,
     };
 
+    // =============================================================================
+    // PRESENTATION TIME
+    // =============================================================================
+
+    static void presentation_clock_id(void *data, [[maybe_unused]] wp_presentation *presentation, uint32_t clk_id) {
+        if (!data) {
+            BONGOCAT_LOG_VERBOSE("Handler called with null data (ignored)");
+            return;
+        }
+        wayland_session_t& ctx = *static_cast<wayland_session_t *>(data);
+
+        ctx.wayland_context._presentation_clock_id = static_cast<clockid_t>(clk_id);
+        BONGOCAT_LOG_VERBOSE("wp_presentation.clock_id: %u", clk_id);
+    }
+
+    /// @NOTE: presentation_listeners MUST pass data as wayland_session_t, see wp_presentation_add_listener
+    static constexpr wp_presentation_listener presentation_listener = {
+        .clock_id = presentation_clock_id,
+    };
+
     // =============================================================================
     // WAYLAND PROTOCOL REGISTRY
     // =============================================================================
@@ -664,6 +701,18 @@ reinterpret_cast<const char*>(pos) < \
         if (strcmp(iface, wl_compositor_interface.name) == 0) {
             ctx.wayland_context.compositor = static_cast<wl_compositor *>(wl_registry_bind(reg, name, &wl_compositor_interface, 4));
             BONGOCAT_LOG_VERBOSE("wl_registry.global: compositor registry bind");
+        } else if (strcmp(iface, wl_subcompositor_interface.name) == 0) {
+            ctx.wayland_context.subcompositor = static_cast<wl_subcompositor *>(wl_registry_bind(reg, name, &wl_subcompositor_interface, 1));
+            BONGOCAT_LOG_VERBOSE("wl_registry.global: subcompositor registry bind");
+        } else if (strcmp(iface, wp_viewporter_interface.name) == 0) {
+            ctx.wayland_context.viewporter = static_cast<wp_viewporter *>(wl_registry_bind(reg, name, &wp_viewporter_interface, 1));
+            BONGOCAT_LOG_VERBOSE("wl_registry.global: viewporter registry bind");
+        } else if (strcmp(iface, wp_presentation_interface.name) == 0) {
+            ctx.wayland_context.presentation = static_cast<wp_presentation *>(wl_registry_bind(reg, name, &wp_presentation_interface, 1));
+            BONGOCAT_LOG_VERBOSE("wl_registry.global: presentation registry bind");
+            if (ctx.wayland_context.presentation) {
+                wp_presentation_add_listener(ctx.wayland_context.presentation, &presentation_listener, &ctx);
+            }
         } else if (strcmp(iface, wl_shm_interface.name) == 0) {
             ctx.wayland_context.shm = static_cast<wl_shm *>(wl_registry_bind(reg, name, &wl_shm_interface, 1));
             BONGOCAT_LOG_VERBOSE("wl_registry.global: shm registry bind");
@@ -720,6 +769,23 @@ reinterpret_cast<const char*>(pos) < \
     // MAIN WAYLAND INTERFACE IMPLEMENTATION
     // =============================================================================
 
+    static void print_latency_stats(const wayland_context_t& wayland_ctx) {
+        if (wayland_ctx.ctx_shm == nullptr) {
+            return;
+        }
+        const frame_latency_stats_t& latency = wayland_ctx.ctx_shm->latency;
+        BONGOCAT_LOG_INFO("Frame latency:");
+        histogram_print("input -> animation", "us", latency.input_to_animation);
+        histogram_print("animation -> commit", "us", latency.animation_to_commit);
+        if (wayland_ctx.presentation) {
+            histogram_print("commit -> presented", "us", latency.commit_to_presented);
+            histogram_print("input -> presented", "us", latency.input_to_presented);
+            BONGOCAT_LOG_INFO("  discarded frames: %zu", atomic_load(&latency.discarded));
+        } else {
+            BONGOCAT_LOG_INFO("  wp_presentation not available, no presentation timing");
+        }
+    }
+
     static bongocat_error_t wayland_setup_protocols(wayland_session_t& ctx) {
         wayland_context_t& wayland_ctx = ctx.wayland_context;
         //animation_context_t& anim = *ctx.animation_context;
@@ -852,6 +918,48 @@ reinterpret_cast<const char*>(pos) < \
         wl_region *input_region = wl_compositor_create_region(wayland_ctx.compositor);
         if (input_region) {
             wl_surface_set_input_region(wayland_ctx.surface, input_region);
+        }
+
+        // Sprite subsurface, layer surface only keeps the background
+        if (current_config.enable_subsurface) {
+            if (wayland_ctx.subcompositor) {
+                wayland_ctx.sprite_surface = wl_compositor_create_surface(wayland_ctx.compositor);
+                if (wayland_ctx.sprite_surface) {
+                    wayland_ctx.sprite_subsurface = wl_subcompositor_get_subsurface(wayland_ctx.subcompositor, wayland_ctx.sprite_surface, wayland_ctx.surface);
+                }
+                if (wayland_ctx.sprite_subsurface) {
+                    // sprite commits are applied without waiting for a commit of the layer surface
+                    wl_subsurface_set_desync(wayland_ctx.sprite_subsurface);
+                    if (input_region) {
+                        wl_surface_set_input_region(wayland_ctx.sprite_surface, input_region);
+                    }
+                    wayland_ctx._sprite_visible = false;
+                    BONGOCAT_LOG_INFO("Using sprite subsurface");
+
+                    // let the compositor scale the sprite, fallback: scale on CPU into sprite sized buffers
+                    if (wayland_ctx.viewporter) {
+                        wayland_ctx.sprite_viewport = wp_viewporter_get_viewport(wayland_ctx.viewporter, wayland_ctx.sprite_surface);
+                    }
+                    if (wayland_ctx.sprite_viewport) {
+                        wayland_ctx._sprite_viewport_width = 0;
+                        wayland_ctx._sprite_viewport_height = 0;
+                        BONGOCAT_LOG_INFO("Using wp_viewporter for sprite scaling");
+                    } else {
+                        BONGOCAT_LOG_DEBUG("wp_viewporter not available, scale sprite on CPU");
+                    }
+                } else {
+                    BONGOCAT_LOG_WARNING("Failed to create sprite subsurface, draw sprite into layer surface");
+                    if (wayland_ctx.sprite_surface) {
+                        wl_surface_destroy(wayland_ctx.sprite_surface);
+                        wayland_ctx.sprite_surface = nullptr;
+                    }
+                }
+            } else {
+                BONGOCAT_LOG_WARNING("wl_subcompositor not available, draw sprite into layer surface");
+            }
+        }
+
+        if (input_region) {
             wl_region_destroy(input_region);
         }
 
@@ -859,29 +967,30 @@ reinterpret_cast<const char*>(pos) < \
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
 
-    static bongocat_error_t wayland_setup_buffer(wayland_context_t& wayland_context, animation::animation_session_t& anim) {
-        // read-only config
-        assert(wayland_context._local_copy_config != nullptr);
-        //const config::config_t& current_config = *wayland_context._local_copy_config;
-
-        wayland_shared_memory_t *wayland_ctx_shm = wayland_context.ctx_shm;
-
-        const int32_t buffer_width = wayland_context._screen_width;
-        const int32_t buffer_height = wayland_context._bar_height;
+    static bongocat_error_t create_shm_buffers(wl_shm *shm, wayland_shm_buffer_t (&buffers)[WAYLAND_NUM_BUFFERS],
+                                               int32_t buffer_width, int32_t buffer_height, animation::animation_session_t& anim) {
         const int32_t buffer_size = buffer_width * buffer_height * RGBA_CHANNELS;
-        if (buffer_size <= 0) {
+        if (buffer_width <= 0 || buffer_height <= 0 || buffer_size <= 0) {
             BONGOCAT_LOG_ERROR("Invalid buffer size: %d", buffer_size);
             return bongocat_error_t::BONGOCAT_ERROR_WAYLAND;
         }
+        // every buffer gets its own mmap, so the offset into the pool must be page aligned
+        const long page_size = sysconf(_SC_PAGESIZE);
+        assert(page_size > 0 && page_size <= INT32_MAX);
+        const int32_t buffer_stride = ((buffer_size + static_cast<int32_t>(page_size) - 1) / static_cast<int32_t>(page_size)) * static_cast<int32_t>(page_size);
         assert(WAYLAND_NUM_BUFFERS <= INT32_MAX);
-        const int32_t total_size = buffer_size * static_cast<int32_t>(WAYLAND_NUM_BUFFERS);
+        if (buffer_stride > INT32_MAX / static_cast<int32_t>(WAYLAND_NUM_BUFFERS)) {
+            BONGOCAT_LOG_ERROR("Invalid buffer size: %d", buffer_size);
+            return bongocat_error_t::BONGOCAT_ERROR_WAYLAND;
+        }
+        const int32_t total_size = buffer_stride * static_cast<int32_t>(WAYLAND_NUM_BUFFERS);
 
         FileDescriptor fd = create_shm(total_size);
         if (fd._fd < 0) {
             return bongocat_error_t::BONGOCAT_ERROR_FILE_IO;
         }
 
-        wl_shm_pool *pool = wl_shm_create_pool(wayland_context.shm, fd._fd, total_size);
+        wl_shm_pool *pool = wl_shm_create_pool(shm, fd._fd, total_size);
         if (!pool) {
             BONGOCAT_LOG_ERROR("Failed to create shared memory pool");
             return bongocat_error_t::BONGOCAT_ERROR_WAYLAND;
@@ -889,24 +998,24 @@ reinterpret_cast<const char*>(pos) < \
 
         for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
             assert(buffer_size >= 0 && static_cast<size_t>(buffer_size) <= SIZE_MAX);
-            wayland_ctx_shm->buffers[i].pixels = make_allocated_mmap_file_buffer_value<uint8_t>(0, static_cast<size_t>(buffer_size), fd._fd, static_cast<off_t>(i) * buffer_size);
-            if (wayland_ctx_shm->buffers[i].pixels == nullptr) {
+            buffers[i].pixels = make_allocated_mmap_file_buffer_value<uint8_t>(0, static_cast<size_t>(buffer_size), fd._fd, static_cast<off_t>(i) * buffer_stride);
+            if (buffers[i].pixels == nullptr) {
                 BONGOCAT_LOG_ERROR("Failed to map shared memory: %s", strerror(errno));
                 for (size_t j = 0; j < i; j++) {
-                    cleanup_shm_buffer(wayland_ctx_shm->buffers[j]);
+                    cleanup_shm_buffer(buffers[j]);
                 }
                 wl_shm_pool_destroy(pool);
                 return bongocat_error_t::BONGOCAT_ERROR_MEMORY;
             }
 
-            wayland_ctx_shm->buffers[i].buffer = wl_shm_pool_create_buffer(pool, 0, wayland_context._screen_width,
-                                              wayland_context._bar_height,
-                                              wayland_context._screen_width * RGBA_CHANNELS,
+            buffers[i].buffer = wl_shm_pool_create_buffer(pool, static_cast<int32_t>(i) * buffer_stride, buffer_width,
+                                              buffer_height,
+                                              buffer_width * RGBA_CHANNELS,
                                               WL_SHM_FORMAT_ARGB8888);
-            if (wayland_ctx_shm->buffers[i].buffer == nullptr) {
+            if (buffers[i].buffer == nullptr) {
                 BONGOCAT_LOG_ERROR("Failed to create buffer");
                 for (size_t j = 0; j < i; j++) {
-                    cleanup_shm_buffer(wayland_ctx_shm->buffers[j]);
+                    cleanup_shm_buffer(buffers[j]);
                 }
                 wl_shm_pool_destroy(pool);
                 return bongocat_error_t::BONGOCAT_ERROR_WAYLAND;
@@ -914,20 +1023,63 @@ reinterpret_cast<const char*>(pos) < \
 
             // created buffer successfully, set other properties
             assert(i <= INT_MAX);
-            wl_buffer_add_listener(wayland_ctx_shm->buffers[i].buffer, &buffer_listener, &wayland_ctx_shm->buffers[i]);
-            wayland_ctx_shm->buffers[i].index = i;
-            atomic_store(&wayland_ctx_shm->buffers[i].busy, false);
-            atomic_store(&wayland_ctx_shm->buffers[i].pending, false);
-            wayland_ctx_shm->buffers[i]._animation_trigger_context = &anim;
+            wl_buffer_add_listener(buffers[i].buffer, &buffer_listener, &buffers[i]);
+            buffers[i].index = i;
+            buffers[i].released_timestamp_us = 0;
+            buffers[i].committed_timestamp_us = 0;
+            atomic_store(&buffers[i].busy, false);
+            atomic_store(&buffers[i].pending, false);
+            buffers[i].last_sprite_rect = {};
+            atomic_store(&buffers[i].needs_full_redraw, true);
+            buffers[i]._animation_trigger_context = &anim;
         }
 
         wl_shm_pool_destroy(pool);
 
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
+    static bongocat_error_t wayland_setup_buffer(wayland_context_t& wayland_context, animation::animation_session_t& anim) {
+        // read-only config
+        assert(wayland_context._local_copy_config != nullptr);
+        //const config::config_t& current_config = *wayland_context._local_copy_config;
+
+        wayland_shared_memory_t *wayland_ctx_shm = wayland_context.ctx_shm;
+
+        const bongocat_error_t result = create_shm_buffers(wayland_context.shm, wayland_ctx_shm->buffers,
+                                                           wayland_context._screen_width, wayland_context._bar_height, anim);
+        if (result != bongocat_error_t::BONGOCAT_SUCCESS) {
+            return result;
+        }
+
         wayland_ctx_shm->current_buffer_index = 0;
 
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
 
+    bongocat_error_t setup_sprite_buffers(wayland_context_t& ctx, animation::animation_session_t& anim, int width, int height) {
+        assert(ctx.ctx_shm != nullptr);
+        wayland_shared_memory_t& wayland_ctx_shm = *ctx.ctx_shm;
+
+        // old buffers can still be held by the compositor, destroying them doesn't change the surface content
+        for (size_t i = 0; i < WAYLAND_NUM_BUFFERS; i++) {
+            cleanup_shm_buffer(wayland_ctx_shm.sprite_buffers[i]);
+        }
+        wayland_ctx_shm.sprite_buffer_width = 0;
+        wayland_ctx_shm.sprite_buffer_height = 0;
+
+        const bongocat_error_t result = create_shm_buffers(ctx.shm, wayland_ctx_shm.sprite_buffers, width, height, anim);
+        if (result != bongocat_error_t::BONGOCAT_SUCCESS) {
+            BONGOCAT_LOG_ERROR("Failed to create sprite buffers (%dx%d)", width, height);
+            return result;
+        }
+        wayland_ctx_shm.sprite_buffer_width = width;
+        wayland_ctx_shm.sprite_buffer_height = height;
+        BONGOCAT_LOG_DEBUG("Sprite buffers created: %dx%d", width, height);
+
+        return bongocat_error_t::BONGOCAT_SUCCESS;
+    }
+
     created_result_t<wayland_session_t> create(animation::animation_session_t& anim, const config::config_t& config) {
         wayland_session_t ret;
 
@@ -944,6 +1096,7 @@ reinterpret_cast<const char*>(pos) < \
             static_assert(WAYLAND_NUM_BUFFERS <= INT_MAX);
             for (size_t i = 0;i < WAYLAND_NUM_BUFFERS;i++) {
                 ret.wayland_context.ctx_shm->buffers[i] = {};
+                ret.wayland_context.ctx_shm->sprite_buffers[i] = {};
             }
             atomic_store(&ret.wayland_context.ctx_shm->configured, false);
         }
@@ -1090,6 +1243,13 @@ reinterpret_cast<const char*>(pos) < \
                                 BONGOCAT_LOG_INFO("Received SIGUSR2, reloading config");
                                 config_reload_requested = true;
                                 break;
+                            case SIGUSR1:
+                                BONGOCAT_LOG_INFO("Received SIGUSR1, dumping frame statistics");
+                                if (ctx.animation_trigger_context) {
+                                    animation::print_frame_timing_stats(ctx.animation_trigger_context->anim);
+                                }
+                                print_latency_stats(wayland_ctx);
+                                break;
                             default:
                                 BONGOCAT_LOG_WARNING("Received unexpected signal %d", fdsi.ssi_signo);
                                 break;
@@ -1235,6 +1395,13 @@ reinterpret_cast<const char*>(pos) < \
         }
         running = 0;
 
+        if (wayland_ctx.ctx_shm != nullptr) {
+            BONGOCAT_LOG_DEBUG("Dropped frames (all %zu buffers busy): %zu", WAYLAND_NUM_BUFFERS, atomic_load(&wayland_ctx.ctx_shm->dropped_frames));
+            BONGOCAT_LOG_DEBUG("Skipped commits (frame unchanged): %zu", atomic_load(&wayland_ctx.ctx_shm->skipped_commits));
+            if (wayland_ctx._local_copy_config != nullptr && wayland_ctx._local_copy_config->enable_debug) {
+                print_latency_stats(wayland_ctx);
+            }
+        }
         BONGOCAT_LOG_INFO("Wayland event loop exited");
         return bongocat_error_t::BONGOCAT_SUCCESS;
     }
@@ -1251,6 +1418,10 @@ reinterpret_cast<const char*>(pos) < \
         assert(ctx._local_copy_config != nullptr && ctx._local_copy_config != MAP_FAILED);
 
         *ctx._local_copy_config = config;
+        // reloaded sprite settings (invert_color, padding, ...) are not part of the frame key, force the next frame to be drawn
+        if (ctx.ctx_shm != nullptr) {
+            request_full_redraw(*ctx.ctx_shm);
+        }
 
         /// @NOTE: assume animation has the same local copy as wayland config
         //animation_update_config(anim, config);
@@ -0,0 +1,87 @@
+#include "utils/histogram.h"
+#include "utils/error.h"
+#include <cassert>
+
+namespace bongocat {
+    static size_t histogram_bucket_index(int64_t value) {
+        if (value < static_cast<int64_t>(HISTOGRAM_SUB_BUCKETS)) {
+            return value > 0 ? static_cast<size_t>(value) : 0;
+        }
+        const auto v = static_cast<uint64_t>(value);
+        const auto msb = static_cast<size_t>(63 - __builtin_clzll(v));
+        const size_t range = msb - HISTOGRAM_SUB_BUCKET_BITS + 1;
+        if (range >= HISTOGRAM_RANGES) {
+            return HISTOGRAM_BUCKETS - 1;
+        }
+        const size_t sub = static_cast<size_t>(v >> (msb - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+        return range * HISTOGRAM_SUB_BUCKETS + sub;
+    }
+
+    // largest value that lands in bucket index
+    static int64_t histogram_bucket_upper_bound(size_t index) {
+        assert(index < HISTOGRAM_BUCKETS);
+        const size_t range = index / HISTOGRAM_SUB_BUCKETS;
+        const size_t sub = index % HISTOGRAM_SUB_BUCKETS;
+        if (range == 0) {
+            return static_cast<int64_t>(sub);
+        }
+        const uint64_t width = 1ull << (range - 1);
+        return static_cast<int64_t>((HISTOGRAM_SUB_BUCKETS + sub) * width + width - 1);
+    }
+
+    void histogram_record(histogram_t& histogram, int64_t value) {
+        value = value > 0 ? value : 0;
+        atomic_fetch_add_explicit(&histogram.buckets[histogram_bucket_index(value)], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&histogram.sum, value, memory_order_relaxed);
+        int64_t max = atomic_load_explicit(&histogram.max, memory_order_relaxed);
+        while (value > max && !atomic_compare_exchange_weak_explicit(&histogram.max, &max, value, memory_order_relaxed, memory_order_relaxed)) {}
+        // count last, a reader that sees the count also sees the bucket
+        atomic_fetch_add_explicit(&histogram.count, 1, memory_order_release);
+    }
+
+    void histogram_reset(histogram_t& histogram) {
+        atomic_store(&histogram.count, 0);
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            atomic_store_explicit(&histogram.buckets[i], 0, memory_order_relaxed);
+        }
+        atomic_store(&histogram.sum, 0);
+        atomic_store(&histogram.max, 0);
+    }
+
+    int64_t histogram_value_at_percentile(const histogram_t& histogram, double percentile) {
+        const int64_t count = atomic_load_explicit(&histogram.count, memory_order_acquire);
+        if (count <= 0) {
+            return 0;
+        }
+        percentile = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+        auto rank = static_cast<int64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+        rank = rank < 1 ? 1 : rank;
+
+        const int64_t max = atomic_load_explicit(&histogram.max, memory_order_relaxed);
+        int64_t seen = 0;
+        for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            seen += atomic_load_explicit(&histogram.buckets[i], memory_order_relaxed);
+            if (seen >= rank) {
+                const int64_t upper = histogram_bucket_upper_bound(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+
+    void histogram_print([[maybe_unused]] const char *name, [[maybe_unused]] const char *unit, const histogram_t& histogram) {
+        const int64_t count = atomic_load(&histogram.count);
+        if (count <= 0) {
+            BONGOCAT_LOG_INFO("  %s: no samples", name);
+            return;
+        }
+        [[maybe_unused]] const int64_t mean = atomic_load(&histogram.sum) / count;
+        BONGOCAT_LOG_INFO("  %s: n=%lld mean=%lld%s p50=%lld%s p95=%lld%s p99=%lld%s max=%lld%s", name,
+                          static_cast<long long>(count),
+                          static_cast<long long>(mean), unit,
+                          static_cast<long long>(histogram_value_at_percentile(histogram, 50.0)), unit,
+                          static_cast<long long>(histogram_value_at_percentile(histogram, 95.0)), unit,
+                          static_cast<long long>(histogram_value_at_percentile(histogram, 99.0)), unit,
+                          static_cast<long long>(atomic_load(&histogram.max)), unit);
+    }
+}
@@ -181,6 +181,17 @@ namespace bongocat {
         stats->peak_allocated     = atomic_load(&g_memory_stats.peak_allocated);
         stats->allocation_count   = atomic_load(&g_memory_stats.allocation_count);
         stats->free_count         = atomic_load(&g_memory_stats.free_count);
+        stats->frame_cache_allocated = atomic_load(&g_memory_stats.frame_cache_allocated);
+        stats->frame_cache_peak      = atomic_load(&g_memory_stats.frame_cache_peak);
+        pthread_mutex_unlock(&g_memory_mutex);
+    }
+
+    void memory_set_frame_cache_size(size_t bytes) {
+        pthread_mutex_lock(&g_memory_mutex);
+        atomic_store(&g_memory_stats.frame_cache_allocated, bytes);
+        if (bytes > atomic_load(&g_memory_stats.frame_cache_peak)) {
+            atomic_store(&g_memory_stats.frame_cache_peak, bytes);
+        }
         pthread_mutex_unlock(&g_memory_mutex);
     }
 
@@ -193,6 +204,8 @@ namespace bongocat {
         const size_t peak_allocated = atomic_load(&stats.peak_allocated);
         const size_t allocation_count = atomic_load(&stats.allocation_count);
         const size_t free_count = atomic_load(&stats.free_count);
+        const size_t frame_cache_allocated = atomic_load(&stats.frame_cache_allocated);
+        const size_t frame_cache_peak = atomic_load(&stats.frame_cache_peak);
 
         assert(allocation_count <= INT_MAX);
         assert(free_count <= INT_MAX);
@@ -204,6 +217,9 @@ namespace bongocat {
         bongocat::log_info("  Allocations: %zu", allocation_count);
         bongocat::log_info("  Frees: %zu", free_count);
         bongocat::log_info("  Potential leaks: %d", static_cast<int>(allocation_count) - static_cast<int>(free_count));
+        bongocat::log_info("  Frame cache: %zu bytes (%.2f MB), peak: %zu bytes (%.2f MB)",
+                           frame_cache_allocated, static_cast<double>(frame_cache_allocated) / (1024.0 * 1024.0),
+                           frame_cache_peak, static_cast<double>(frame_cache_peak) / (1024.0 * 1024.0));
     }
 #endif
 
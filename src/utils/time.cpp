@@ -12,6 +12,14 @@ namespace bongocat::platform {
         return get_current_time_us() / 1000;
     }
 
+    time_us_t get_monotonic_time_us() {
+        timespec ts{};
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+            return 0;
+        }
+        return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+    }
+
     time_us_t get_uptime_us() {
         timespec ts{};
         if (clock_gettime(CLOCK_BOOTTIME, &ts) != 0) {